@@ -0,0 +1,357 @@
+/**
+ * @file mtp-bench-suite.cpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief Sweeps algorithm x element type x shape x thread count, and
+ * compares the results against a stored baseline
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * Shapes for a size s are square (s x s times s x s), tall-skinny
+ * (4s x s/4 times s/4 x s) and rectangular (s x 2s times 2s x s/2).
+ * Algorithms only defined for square power-of-two matrices run the square
+ * shape only, and single-threaded algorithms run with one thread only.
+ *
+ * With --check-baseline, each case found in the baseline is compared on one
+ * metric; the suite exits with 1 if any case is worse by more than the
+ * tolerance. A case that regresses is measured again (--retries) and its
+ * best attempt counts, so one noisy sample on a busy machine does not fail
+ * the check. This is how the bench_regression CTest test gates a build.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Benchmark.hpp"
+
+using namespace MatMulImpl;
+
+const char *help_msg =
+    "mtp-bench-suite [-h|--help] [--quick] [--alg a,...] [--type t,...]\n"
+    "                [--shape s,...] [--threads n,...] [--min-size N]\n"
+    "                [--max-size N] [--budget SECONDS] [-o FILE]\n"
+    "                [--save-baseline FILE] [--check-baseline FILE]\n"
+    "                [--metric NAME] [--tolerance X] [--retries N]\n"
+    "                [--counters]\n"
+    "-h | --help\n"
+    "Prints this help message and exits.\n"
+    "--quick\n"
+    "Small sizes (32 to 64), int and double, one thread, 0.05 s per case;\n"
+    "all algorithms but summa unless --alg or --threads say otherwise\n"
+    "--alg a,...\n"
+    "Default: naive,div_and_conquer,strassen,strassen_dag,blocked,summa\n"
+    "--type t,...\n"
+    "Default: int,float,double\n"
+    "--shape s,...\n"
+    "Default: square,tall_skinny,rectangular\n"
+    "--threads n,...\n"
+    "Default: 1 and the number of hardware threads\n"
+    "--min-size N, --max-size N\n"
+    "Default: 64, 256\n"
+    "Sizes s to sweep; powers of two in [min, max]\n"
+    "--budget SECONDS\n"
+    "Default: 0.2\n"
+    "Measured time per case, after warmup\n"
+    "-o FILE\n"
+    "Writes the JSON report of this run; - for stdout\n"
+    "--save-baseline FILE\n"
+    "Writes the JSON report of this run as the new baseline\n"
+    "--check-baseline FILE\n"
+    "Compares this run with the baseline; exits with 1 on a regression\n"
+    "and with 2 if the baseline cannot be read\n"
+    "--metric NAME\n"
+    "Default: p50_ns\n"
+    "Metric to compare: p50_ns, p99_ns, mean_ns or min_ns (lower is\n"
+    "better), gflops or bandwidth_gbs (higher is better)\n"
+    "--tolerance X\n"
+    "Default: 0.25\n"
+    "Allowed relative regression, e.g. 0.25 is 25% worse\n"
+    "--retries N\n"
+    "Default: 2\n"
+    "Times a regressed case is measured again; the best attempt counts\n"
+    "--counters\n"
+    "Adds hardware counters to each record when the kernel allows\n";
+
+struct Options {
+    std::vector<std::string> algs, types{"int", "float", "double"};
+    std::vector<std::string> shapes{"square", "tall_skinny", "rectangular"};
+    std::vector<int> threads;
+    int min_size = 64, max_size = 256;
+    BenchmarkConfig config;
+    std::string out, save_baseline, check_baseline, metric = "p50_ns";
+    double tolerance = 0.25;
+    int retries = 2;
+    bool quick = false;
+};
+
+static std::vector<std::string> split(const std::string &s) {
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) out.push_back(item);
+    }
+    return out;
+}
+
+static bool selected(const std::vector<std::string> &list,
+                     const std::string &name) {
+    if (list.empty()) return true;
+    for (auto &&s : list) {
+        if (s == name) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief m, k, n of a shape of size s; false if the shape does not apply.
+ */
+static bool shape_dims(const std::string &shape, int s, int &m, int &k,
+                       int &n) {
+    if (shape == "square") {
+        m = k = n = s;
+    } else if (shape == "tall_skinny") {
+        m = 4 * s, k = s / 4, n = s;
+    } else if (shape == "rectangular") {
+        m = s, k = 2 * s, n = s / 2;
+    } else {
+        return false;
+    }
+    return m > 0 && k > 0 && n > 0;
+}
+
+template <class T>
+void run_type(const char *type, const Options &opt,
+              std::vector<BenchmarkResult> &results) {
+    for (auto &&alg : Benchmark::algorithms<T>()) {
+        if (!selected(opt.algs, alg.name)) continue;
+        for (auto &&shape : opt.shapes) {
+            if (alg.needs_square_pow2 && shape != "square") continue;
+            for (int s = 1; s <= opt.max_size; s *= 2) {
+                int m, k, n;
+                if (s < opt.min_size || !shape_dims(shape, s, m, k, n))
+                    continue;
+                for (int threads : opt.threads) {
+                    if (!alg.parallel && threads != 1) continue;
+                    BenchmarkCase spec{alg.name, type, m, k, n, threads};
+                    auto res = Benchmark::run<T>(spec, alg, opt.config);
+                    std::cerr << Benchmark::case_key(spec) << ' ' << shape
+                              << ": " << res.stats.count() << " reps, p50 "
+                              << res.p50 << " ns, " << res.gflops
+                              << " GFLOPS" << std::endl;
+                    results.push_back(std::move(res));
+                }
+            }
+        }
+    }
+}
+
+static bool write_report(const std::string &path,
+                         const std::vector<BenchmarkResult> &results,
+                         const BenchmarkConfig &config) {
+    if (path == "-") {
+        Benchmark::write_json(std::cout, results, config);
+        return true;
+    }
+    std::ofstream out(path);
+    Benchmark::write_json(out, results, config);
+    if (!out) std::cerr << "Cannot write " << path << std::endl;
+    return bool(out);
+}
+
+/**
+ * @brief Runs one case again.
+ * @throw std::invalid_argument if the algorithm or type is unknown
+ */
+template <class T>
+BenchmarkResult measure(const BenchmarkCase &spec,
+                        const BenchmarkConfig &config) {
+    for (auto &&alg : Benchmark::algorithms<T>()) {
+        if (alg.name == spec.algorithm)
+            return Benchmark::run<T>(spec, alg, config);
+    }
+    throw std::invalid_argument("Unknown algorithm " + spec.algorithm);
+}
+
+static BenchmarkResult measure(const BenchmarkCase &spec,
+                               const BenchmarkConfig &config) {
+    if (spec.type == "int") return measure<int>(spec, config);
+    if (spec.type == "float") return measure<float>(spec, config);
+    if (spec.type == "double") return measure<double>(spec, config);
+    throw std::invalid_argument("Unknown type " + spec.type);
+}
+
+/**
+ * @brief Value of the metric in a result, as written by Benchmark::to_json.
+ */
+static double metric_of(const BenchmarkResult &r, const std::string &name) {
+    std::string json = Benchmark::to_json(r);
+    std::istringstream is("{\"results\": [" + json + "]}");
+    auto records = Benchmark::read_json(is);
+    auto it = records[0].find(name);
+    if (it == records[0].end()) return std::nan("");
+    return std::atof(it->second.c_str());
+}
+
+/**
+ * @brief Compares results with the baseline. Returns the number of
+ * regressions, or 1 if no case was in the baseline.
+ */
+static int check(const std::vector<BenchmarkResult> &results,
+                 const std::vector<Benchmark::Record> &baseline,
+                 const Options &opt) {
+    const bool lower_better =
+        opt.metric.size() > 3 &&
+        opt.metric.compare(opt.metric.size() - 3, 3, "_ns") == 0;
+    std::map<std::string, double> base;
+    for (auto &&r : baseline) {
+        auto it = r.find(opt.metric);
+        if (it != r.end() && it->second != "null")
+            base[Benchmark::case_key(r)] = std::atof(it->second.c_str());
+    }
+    int regressions = 0, compared = 0;
+    for (auto &&r : results) {
+        std::string key = Benchmark::case_key(r.spec);
+        auto it = base.find(key);
+        double now = metric_of(r, opt.metric);
+        if (it == base.end() || !(it->second > 0) || !std::isfinite(now)) {
+            std::cout << key << ": no baseline" << std::endl;
+            continue;
+        }
+        compared++;
+        // Relative change, positive when worse
+        auto change_of = [&](double v) {
+            return lower_better ? v / it->second - 1 : 1 - v / it->second;
+        };
+        double change = change_of(now);
+        for (int t = 0; t < opt.retries && change > opt.tolerance; t++) {
+            double again = metric_of(measure(r.spec, opt.config), opt.metric);
+            if (std::isfinite(again) && change_of(again) < change) {
+                now = again;
+                change = change_of(again);
+            }
+        }
+        bool bad = change > opt.tolerance;
+        regressions += bad;
+        std::cout << (bad ? "REGRESSED " : "ok        ") << key << ' '
+                  << opt.metric << ' ' << it->second << " -> " << now << " ("
+                  << (change > 0 ? "+" : "") << change * 100 << "% worse)"
+                  << std::endl;
+    }
+    std::cout << compared << " cases compared on " << opt.metric
+              << ", tolerance " << opt.tolerance * 100 << "%: " << regressions
+              << " regressed" << std::endl;
+    // A baseline that covers none of the cases checks nothing
+    if (compared == 0)
+        std::cout << "No case found in the baseline" << std::endl;
+    return compared == 0 ? 1 : regressions;
+}
+
+int main(int argc, char const *argv[]) {
+    Options opt;
+    opt.config.budget_seconds = 0.2;
+    for (int i = 1; i < argc; i++) {
+        std::string s(argv[i]);
+        bool has_value = i + 1 < argc;
+        if (s == "--help" || s == "-h") {
+            std::cout << help_msg << std::endl;
+            return 0;
+        } else if (s == "--quick") {
+            opt.quick = true;
+            opt.min_size = 32, opt.max_size = 64;
+            opt.types = {"int", "double"};
+            opt.config.budget_seconds = 0.05;
+        } else if (s == "--alg" && has_value) {
+            opt.algs = split(argv[++i]);
+        } else if (s == "--type" && has_value) {
+            opt.types = split(argv[++i]);
+        } else if (s == "--shape" && has_value) {
+            opt.shapes = split(argv[++i]);
+        } else if (s == "--threads" && has_value) {
+            for (auto &&t : split(argv[++i]))
+                opt.threads.push_back(std::max(1, std::atoi(t.c_str())));
+        } else if (s == "--min-size" && has_value) {
+            opt.min_size = std::atoi(argv[++i]);
+        } else if (s == "--max-size" && has_value) {
+            opt.max_size = std::atoi(argv[++i]);
+        } else if (s == "--budget" && has_value) {
+            opt.config.budget_seconds = std::atof(argv[++i]);
+        } else if (s == "-o" && has_value) {
+            opt.out = argv[++i];
+        } else if (s == "--save-baseline" && has_value) {
+            opt.save_baseline = argv[++i];
+        } else if (s == "--check-baseline" && has_value) {
+            opt.check_baseline = argv[++i];
+        } else if (s == "--metric" && has_value) {
+            opt.metric = argv[++i];
+        } else if (s == "--tolerance" && has_value) {
+            opt.tolerance = std::atof(argv[++i]);
+        } else if (s == "--retries" && has_value) {
+            opt.retries = std::max(0, std::atoi(argv[++i]));
+        } else if (s == "--counters") {
+            opt.config.counters = true;
+        } else {
+            std::cerr << "Unrecognized argument: " << s << '\n'
+                      << help_msg << std::endl;
+            return 2;
+        }
+    }
+    for (auto &&name : opt.algs) {
+        bool known = false;
+        for (auto &&alg : Benchmark::algorithms<double>())
+            known = known || alg.name == name;
+        if (!known) {
+            std::cerr << "Unknown algorithm " << name << std::endl;
+            return 2;
+        }
+    }
+    if (opt.quick) {
+        // The gate wants stable numbers: summa's process grid and the
+        // multi-threaded cases are the noisiest on a shared machine
+        if (opt.algs.empty()) {
+            for (auto &&alg : Benchmark::algorithms<double>())
+                if (alg.name != "summa") opt.algs.push_back(alg.name);
+        }
+        if (opt.threads.empty()) opt.threads.push_back(1);
+    }
+    if (opt.threads.empty()) {
+        opt.threads.push_back(1);
+        if (default_thread_count() > 1)
+            opt.threads.push_back(default_thread_count());
+    }
+
+    std::vector<BenchmarkResult> results;
+    for (auto &&type : opt.types) {
+        if (type == "int") {
+            run_type<int>("int", opt, results);
+        } else if (type == "float") {
+            run_type<float>("float", opt, results);
+        } else if (type == "double") {
+            run_type<double>("double", opt, results);
+        } else {
+            std::cerr << "Unknown type " << type << ", skipped" << std::endl;
+        }
+    }
+    if (!opt.out.empty() && !write_report(opt.out, results, opt.config))
+        return 2;
+    if (!opt.save_baseline.empty() &&
+        !write_report(opt.save_baseline, results, opt.config))
+        return 2;
+    if (opt.check_baseline.empty()) return 0;
+
+    std::ifstream in(opt.check_baseline);
+    if (!in) {
+        std::cerr << "Cannot open baseline " << opt.check_baseline
+                  << "; record one with --save-baseline" << std::endl;
+        return 2;
+    }
+    return check(results, Benchmark::read_json(in), opt) ? 1 : 0;
+}
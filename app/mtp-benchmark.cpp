@@ -2,111 +2,199 @@
  * @file mtp-benchmark.cpp
  * @author aydenwong (aydenwongfs@gmail.com)
  * @brief Benchmarks the performance of different matrix multiplication
- * algorithms and outputs a CSV for further processing
- * @version 0.1
- * @date 06-04-2024
+ * algorithms and outputs a JSON report for further processing
+ * @version 0.2
+ * @date 18-10-2026
  *
  * @copyright Copyright (c) 2024
  *
  */
 
 /**
- * CSV format:
- * Row 1 (Table header)||Alg_name|Entry_type|RowA|ColA|RowB|ColB|Tests|T1|...
- * Row 2 and onwards   || Naive    |int     | 2  | 2  | 2  | 2|
- * | 100   |... |...
- * ...
+ * JSON format (see Benchmark::write_json):
+ * {"context": {...},
+ *  "results": [{"algorithm": "naive", "type": "int", "m": 2, "k": 2,
+ *               "n": 2, "threads": 1, "warmup_reps": 2, "reps": 100,
+ *               "mean_ns": ..., "stddev_ns": ..., "min_ns": ...,
+ *               "max_ns": ..., "p50_ns": ..., "p99_ns": ...,
+ *               "gflops": ..., "bandwidth_gbs": ...}, ...]}
+ * With --counters, each result also has "cycles", "instructions",
+ * "l1d_misses", "llc_misses", "dtlb_misses", "branch_misses" (per
+ * multiplication; null if that counter is unsupported) and "ipc".
+ * Every result has "peak_bytes", "alloc_count" and "alloc_bytes" of one
+ * multiplication and the "predicted_peak_bytes" of MemoryModel.
  */
-#include <chrono>
 #include <ctime>
 #include <fstream>
-#include <functional>
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <vector>
 
-#include "Algorithms.hpp"
-#include "Generator.hpp"
+#include "Benchmark.hpp"
 
 using namespace MatMulImpl;
-using Mtp = MatMulImpl::Multiplication;
-using tick_type = std::chrono::high_resolution_clock::duration::rep;
 
 const char *help_msg =
-    "mtp-bechmark [-h|--help] [csvOut]\n"
+    "mtp-bechmark [-h|--help] [--alg a,b,...] [--type t,...] [--min-size N]\n"
+    "             [--max-size N] [--budget SECONDS] [--warmup N]\n"
+    "             [--threads N] [--counters] [--trace FILE] [jsonOut]\n"
     "-h | --help\n"
     "Prints this help message and exits.\n"
-    "csvOut\n"
-    "Default: alg-runtimes<current datetime>.csv\n"
-    "The output path of the csvFile\n";
+    "--alg a,b,...\n"
+    "Default: naive,div_and_conquer,strassen,strassen_dag,blocked,summa\n"
+    "Algorithms to run\n"
+    "--type t,...\n"
+    "Default: int\n"
+    "Element types to run: int, float, double\n"
+    "--min-size N, --max-size N\n"
+    "Default: 2, 256\n"
+    "Square matrix sizes to run; powers of two in [min, max]\n"
+    "--budget SECONDS\n"
+    "Default: 0.5\n"
+    "Measured time per case, after warmup\n"
+    "--warmup N\n"
+    "Default: 2\n"
+    "Untimed repetitions before measuring\n"
+    "--threads N\n"
+    "Default: 1\n"
+    "Threads for algorithms that support them\n"
+    "--counters\n"
+    "Adds hardware counters per multiplication (cycles, instructions,\n"
+    "L1D/LLC/dTLB misses, branch misses, IPC) when the kernel allows\n"
+    "--trace FILE\n"
+    "Runs each case once instead of timing it and writes the recursion\n"
+    "trace as Chrome Trace Event JSON (needs -DMATMUL_TRACE=ON)\n"
+    "jsonOut\n"
+    "Default: alg-runtimes<current datetime>.json\n"
+    "The output path of the JSON report; - for stdout\n";
 
-constexpr long long init_batch_size = 0x200000000;  // Put a number that is 2^n here
+struct Options {
+    std::vector<std::string> algs, types{"int"};
+    int min_size = 2, max_size = 256, threads = 1;
+    BenchmarkConfig config;
+    std::string json_out, trace;
+};
+
+static std::vector<std::string> split(const std::string &s) {
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) out.push_back(item);
+    }
+    return out;
+}
+
+static bool selected(const std::vector<std::string> &list,
+                     const std::string &name) {
+    if (list.empty()) return true;
+    for (auto &&s : list) {
+        if (s == name) return true;
+    }
+    return false;
+}
+
+template <class T>
+void run_type(const char *type, const Options &opt, std::ostream &log,
+              std::vector<BenchmarkResult> &results) {
+    for (auto &&alg : Benchmark::algorithms<T>()) {
+        if (!selected(opt.algs, alg.name)) continue;
+        for (int size = 1; size <= opt.max_size; size *= 2) {
+            if (size < opt.min_size) continue;
+            if (!opt.trace.empty()) {
+                auto a = MatrixGenerator<T>::random_fill_seeded(size, size, 0);
+                auto b = MatrixGenerator<T>::random_fill_seeded(size, size, 1);
+                alg.run(a, b, opt.threads);
+                continue;
+            }
+            BenchmarkCase spec{alg.name, type, size, size, size, opt.threads};
+            auto res = Benchmark::run<T>(spec, alg, opt.config);
+            log << alg.name << ' ' << type << ' ' << size << 'x' << size
+                << ": " << res.stats.count() << " reps, mean "
+                << res.stats.mean() << " ns, p50 " << res.p50 << " ns, p99 "
+                << res.p99 << " ns, " << res.gflops << " GFLOPS" << std::endl;
+            results.push_back(std::move(res));
+        }
+    }
+}
 
 int main(int argc, char const *argv[]) {
-    std::string csvOut("");
+    Options opt;
     for (int i = 1; i < argc; i++) {
         std::string s(argv[i]);
+        bool has_value = i + 1 < argc;
         if (s == "--help" || s == "-h") {
             std::cout << help_msg << std::endl;
             return 0;
-        } else if (s.find('-') != -1) {
+        } else if (s == "--alg" && has_value) {
+            opt.algs = split(argv[++i]);
+        } else if (s == "--type" && has_value) {
+            opt.types = split(argv[++i]);
+        } else if (s == "--min-size" && has_value) {
+            opt.min_size = std::stoi(argv[++i]);
+        } else if (s == "--max-size" && has_value) {
+            opt.max_size = std::stoi(argv[++i]);
+        } else if (s == "--budget" && has_value) {
+            opt.config.budget_seconds = std::stod(argv[++i]);
+        } else if (s == "--warmup" && has_value) {
+            opt.config.warmup = std::stoi(argv[++i]);
+        } else if (s == "--threads" && has_value) {
+            opt.threads = std::max(1, std::stoi(argv[++i]));
+        } else if (s == "--trace" && has_value) {
+            opt.trace = argv[++i];
+        } else if (s == "--counters") {
+            opt.config.counters = true;
+        } else if (s != "-" && s.find('-') == 0) {
             std::cout << "Unrecognized argument: " << help_msg << std::endl;
             return 0;
         } else {
-            csvOut.assign(argv[i]);
+            opt.json_out.assign(argv[i]);
         }
     }
-    if (csvOut == "") {
+#ifndef MATMUL_TRACE
+    if (!opt.trace.empty()) {
+        std::cerr << "--trace needs a build with -DMATMUL_TRACE=ON"
+                  << std::endl;
+        return 1;
+    }
+#endif
+    if (opt.json_out == "") {
         char dt_str[13];
         auto now_epoch = time(nullptr);
         strftime(dt_str, 13, "%Y%m%d%H%M", localtime(&now_epoch));
-        ((csvOut += "alg-runtimes") += dt_str) += ".csv";
-    }
-    std::fstream out_file;
-    out_file.open(csvOut, std::ios::out);
-    out_file << "Alg_name,Entry_type,RowA,ColA,RowB,ColB,Tests\n";
-    // auto f = Mtp::naive;
-    // for (std::function < Matrix2<int> (const Matrix2<int>&, const
-    // Matrix2<int>&) > &&f: {Mtp::naive, Mtp::div_and_conquer_sq2,
-    // Mtp::strassen}; std::function < Matrix2<int>(const)
-    const char *alg_names[] = {"naive", "div_and_conquer", "strassen"};
-    std::cout << "Running algorithms: ";
-    for (auto &&s : alg_names) {
-        std::cout << s << ' ';
+        ((opt.json_out += "alg-runtimes") += dt_str) += ".json";
     }
-    std::cout << '\n';
-    std::cout << "Timing using std::chrono::high_resolution::clock\nResolution:"
-              << std::chrono::high_resolution_clock::period::den
-              << " ticks in 1 second" << std::endl;
-    int i_alg = 0;
-    int i_batch = 1;
-    for (auto &&f : {&Mtp::naive<int>, &Mtp::div_and_conquer_sq2<int>,
-                     &Mtp::strassen<int>}) {
-        int matrix_size = 2;
-        for (long long batch_size = init_batch_size; batch_size > 0; batch_size /= 8, i_batch++, matrix_size*=2) {
-            std::cout << "Batch #" << i_batch << ": Multiplying " << matrix_size << "x" << matrix_size << " matrices with " << alg_names[i_alg] << ", batch size " << batch_size << std::endl;
-            std::vector<tick_type> unit_times(batch_size);
-            for (long i = 0; i < batch_size; i++) {
-                // prepare matrices
-                auto m1 = MatrixGenerator<int>::random_fill(matrix_size,
-                                                            matrix_size),
-                     m2 = MatrixGenerator<int>::random_fill(matrix_size,
-                                                            matrix_size);
-                auto t_start = std::chrono::high_resolution_clock::now();
-                f(m1, m2);
-                auto t_end = std::chrono::high_resolution_clock::now();
-                auto t_delta = t_end - t_start;
-                unit_times.push_back(t_delta.count());
-            }
-            std::cout << "Batch #" << i_batch << " done, average ticks " << std::reduce(unit_times.begin(), unit_times.end()) / unit_times.size() << '\n';
-            out_file << alg_names[i_alg] << ',' << "int" << ',' << matrix_size << ',' << matrix_size << ',' << matrix_size << ',' << matrix_size << ',' << batch_size << ',';
-            for (auto &&t : unit_times)
-            {
-                out_file << t << ',';
-            }
-            out_file << std::endl;
+    // Progress goes to stderr when the report itself goes to stdout
+    std::ostream &log = opt.json_out == "-" ? std::cerr : std::cout;
+    if (opt.trace.empty())
+        log << "Timing using std::chrono::steady_clock, budget "
+            << opt.config.budget_seconds << " s per case" << std::endl;
+    if (opt.config.counters && !PerfCounters().available())
+        log << "Hardware counters unavailable; timing only" << std::endl;
+
+    std::vector<BenchmarkResult> results;
+    for (auto &&type : opt.types) {
+        if (type == "int") {
+            run_type<int>("int", opt, log, results);
+        } else if (type == "float") {
+            run_type<float>("float", opt, log, results);
+        } else if (type == "double") {
+            run_type<double>("double", opt, log, results);
+        } else {
+            log << "Unknown type " << type << ", skipped" << std::endl;
         }
-        i_alg++;
     }
-    out_file.close();
+    if (!opt.trace.empty()) {
+        std::ofstream trace_file(opt.trace);
+        Trace::write_chrome(trace_file);
+        return trace_file ? 0 : 1;
+    }
+    if (opt.json_out == "-") {
+        Benchmark::write_json(std::cout, results, opt.config);
+    } else {
+        std::ofstream out_file(opt.json_out);
+        Benchmark::write_json(out_file, results, opt.config);
+    }
     return 0;
 }
@@ -0,0 +1,716 @@
+/**
+ * @file mtp-daemon.cpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief A multiply service for every process on the host, over a Unix
+ * domain socket
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * The daemon owns the worker threads. Clients (see MultiplyService.hpp)
+ * pass their operands as memfd file descriptors, which are mapped here, so
+ * C is written straight into the client's memory. Only files sealed
+ * against shrinking are mapped, so no client can make a mapping fault.
+ *
+ * Every kernel runs on one pool of --threads threads, shared by the
+ * --workers requests or batches in flight, so the host is never
+ * oversubscribed. Client sockets are non-blocking: the listening thread
+ * buffers partial requests and their fds per connection, and replies are
+ * queued per connection, sent by the workers as far as the socket takes
+ * them and finished by the listening thread when it becomes writable. A
+ * slow client only ever delays itself.
+ *
+ * Scheduling:
+ * - Small requests (fewer multiply-adds than --batch-threshold) are grouped
+ *   by element type and shape. A group runs as one batch, spread over the
+ *   threads, when it has --max-batch requests or its oldest request has
+ *   waited --linger-us.
+ * - Large requests run one at a time per worker with all --threads, highest
+ *   priority first, in arrival order within a priority.
+ * Ready batches go before large requests, as they are short.
+ *
+ * `MtpDaemon --stats` prints the metrics of a running daemon: queue depth,
+ * request and batch counts, and queueing and service latency percentiles.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "Algorithms.hpp"
+#include "MultiplyService.hpp"
+
+using namespace MatMulImpl;
+namespace Svc = MatMulImpl::MultiplyService;
+using Clock = std::chrono::steady_clock;
+
+const char *help_msg =
+    "mtp-daemon [-h|--help] [-s SOCKET] [-w WORKERS] [-j THREADS]\n"
+    "           [--batch-threshold MKN] [--max-batch N] [--linger-us US]\n"
+    "           [--stats]\n"
+    "-h | --help\n"
+    "Prints this help message and exits.\n"
+    "-s SOCKET\n"
+    "Default: $MTP_DAEMON_SOCKET, or /tmp/mtp-daemon-<uid>.sock\n"
+    "Path of the Unix domain socket\n"
+    "-w WORKERS\n"
+    "Default: 2\n"
+    "Number of batches or large requests run at the same time\n"
+    "-j THREADS\n"
+    "Default: number of hardware threads\n"
+    "Threads of the pool that every batch and large request shares\n"
+    "--batch-threshold MKN\n"
+    "Default: 262144\n"
+    "Requests with fewer multiply-adds (m*k*n) are batched\n"
+    "--max-batch N\n"
+    "Default: 64\n"
+    "Largest number of requests in a batch\n"
+    "--linger-us US\n"
+    "Default: 200\n"
+    "How long a small request waits for others of its shape\n"
+    "--stats\n"
+    "Prints the metrics of the daemon running on SOCKET and exits\n";
+
+struct Options {
+    std::string socket = Svc::default_socket_path();
+    int workers = 2;
+    int threads = default_thread_count();
+    long long batch_threshold = 1LL << 18;
+    int max_batch = 64;
+    int linger_us = 200;
+    bool stats = false;
+};
+
+static std::atomic<bool> quit{false};
+static int wake_fd = -1;  // Written to wake the listening thread's poll()
+
+static void wake_listener() {
+    char c = 0;
+    (void)!write(wake_fd, &c, 1);  // A full pipe is already a wake-up
+}
+
+static std::int64_t ns_between(Clock::time_point a, Clock::time_point b) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(b - a)
+        .count();
+}
+
+/**
+ * @brief A client connection on a non-blocking socket. The request being
+ * received is only touched by the listening thread. Replies come from any
+ * thread and are queued in out, under the mutex. The socket closes with
+ * the last reference.
+ */
+struct Connection {
+    static constexpr std::size_t max_out = std::size_t(1) << 20;
+
+    int fd;
+    Svc::Request req;
+    std::size_t got = 0;  // Bytes of req received so far
+    int fds[3];           // Passed with req
+    int n_fds = 0;
+    bool eof = false;
+
+    explicit Connection(int fd) : fd(fd) {}
+    ~Connection() {
+        for (int i = 0; i < n_fds; i++) close(fds[i]);
+        close(fd);
+    }
+
+    /**
+     * @brief Queues a reply and sends what the socket takes now. What is
+     * left is sent by the listening thread once the socket is writable.
+     */
+    void reply(const Svc::Reply &r, const std::string &text) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (broken) return;
+        out.append(reinterpret_cast<const char *>(&r), sizeof(r));
+        out += text;
+        if (!flush_locked()) return;
+        if (!out.empty()) wake_listener();
+    }
+    /**
+     * @brief Sends queued replies until the socket is full. Returns false
+     * once the peer is gone.
+     */
+    bool flush() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return flush_locked();
+    }
+    bool broken_peer() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return broken;
+    }
+    bool has_output() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return !out.empty();
+    }
+    /**
+     * @brief True while the client leaves too many replies unread; its
+     * requests are not read until it catches up.
+     */
+    bool backlogged() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return out.size() >= max_out;
+    }
+
+   private:
+    std::mutex mtx;
+    std::string out;  // Queued reply bytes
+    bool broken = false;
+
+    bool flush_locked() {
+        std::size_t sent = 0;
+        while (!broken && sent < out.size()) {
+            ssize_t w = Svc::send_some(fd, out.data() + sent,
+                                       out.size() - sent);
+            if (w > 0) {
+                sent += static_cast<std::size_t>(w);
+            } else if (w < 0 && errno == EINTR) {
+                continue;
+            } else if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            } else {
+                broken = true;
+            }
+        }
+        if (broken) {
+            out.clear();
+            return false;
+        }
+        out.erase(0, sent);
+        return true;
+    }
+};
+
+/**
+ * @brief One operand mapped from a client's memfd.
+ */
+struct Mapping {
+    void *p = MAP_FAILED;
+    std::size_t len = 0;
+
+    Mapping() = default;
+    Mapping(const Mapping &) = delete;
+    Mapping &operator=(const Mapping &) = delete;
+    ~Mapping() {
+        if (p != MAP_FAILED) munmap(p, len);
+    }
+};
+
+struct Job {
+    Svc::Request req;
+    std::shared_ptr<Connection> conn;
+    Mapping ops[3];  // A, B, C
+    Clock::time_point arrived;
+    std::uint64_t seq;
+
+    long long mkn() const { return (long long)req.m * req.k * req.n; }
+};
+using JobPtr = std::unique_ptr<Job>;
+
+/**
+ * @brief Counters and recent latencies.
+ */
+class Metrics {
+   public:
+    void enqueued(bool small) {
+        std::lock_guard<std::mutex> lock(mtx);
+        requests++;
+        (small ? small_requests : large_requests)++;
+        depth++;
+        max_depth = std::max(max_depth, depth);
+    }
+    void started(std::size_t batch) {
+        std::lock_guard<std::mutex> lock(mtx);
+        depth -= static_cast<long long>(batch);
+        batches++;
+        if (batch > 1) batched_requests += static_cast<long long>(batch);
+    }
+    void finished(std::int64_t queue, std::int64_t total) {
+        std::lock_guard<std::mutex> lock(mtx);
+        record(queue_ns, queue);
+        record(latency_ns, total);
+    }
+    void failed() {
+        std::lock_guard<std::mutex> lock(mtx);
+        errors++;
+    }
+    std::string json(const Options &opt) {
+        std::lock_guard<std::mutex> lock(mtx);
+        std::stringstream ss;
+        ss << "{\"queue_depth\": " << depth
+           << ", \"max_queue_depth\": " << max_depth
+           << ", \"requests\": " << requests
+           << ", \"small_requests\": " << small_requests
+           << ", \"large_requests\": " << large_requests
+           << ", \"batches\": " << batches
+           << ", \"batched_requests\": " << batched_requests
+           << ", \"errors\": " << errors << ", \"queue_ns\": "
+           << percentiles(queue_ns) << ", \"latency_ns\": "
+           << percentiles(latency_ns) << ", \"workers\": " << opt.workers
+           << ", \"threads\": " << opt.threads << "}";
+        return ss.str();
+    }
+
+   private:
+    static constexpr std::size_t window = 4096;  // Latencies kept
+    std::mutex mtx;
+    long long requests = 0, small_requests = 0, large_requests = 0;
+    long long batches = 0, batched_requests = 0, errors = 0;
+    long long depth = 0, max_depth = 0;
+    std::vector<std::int64_t> queue_ns, latency_ns;
+    std::size_t next_queue = 0, next_latency = 0;
+
+    void record(std::vector<std::int64_t> &v, std::int64_t x) {
+        std::size_t &next = &v == &queue_ns ? next_queue : next_latency;
+        if (v.size() < window) {
+            v.push_back(x);
+        } else {
+            v[next] = x;
+            next = (next + 1) % window;
+        }
+    }
+    static std::string percentiles(std::vector<std::int64_t> v) {
+        if (v.empty()) return "null";
+        std::sort(v.begin(), v.end());
+        auto at = [&v](double q) {
+            return v[std::min(v.size() - 1, std::size_t(q * v.size()))];
+        };
+        std::stringstream ss;
+        ss << "{\"p50\": " << at(0.5) << ", \"p90\": " << at(0.9)
+           << ", \"p99\": " << at(0.99) << ", \"max\": " << v.back() << "}";
+        return ss.str();
+    }
+};
+
+/**
+ * @brief Holds the queued requests and hands out the next unit of work.
+ */
+class Scheduler {
+   public:
+    explicit Scheduler(const Options &opt) : opt(opt) {}
+
+    void push(JobPtr job) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            job->seq = seq++;
+            if (job->mkn() < opt.batch_threshold) {
+                Shape s{job->req.type, job->req.m, job->req.k, job->req.n};
+                small[s].push_back(std::move(job));
+            } else {
+                large.push_back(std::move(job));
+                std::push_heap(large.begin(), large.end(), by_priority);
+            }
+        }
+        cv.notify_one();
+    }
+
+    /**
+     * @brief Blocks until there is a ready batch or a large request. After
+     * stop(), drains what is queued without lingering, then returns an
+     * empty vector.
+     */
+    std::vector<JobPtr> take() {
+        const auto linger = std::chrono::microseconds(opt.linger_us);
+        std::unique_lock<std::mutex> lock(mtx);
+        while (true) {
+            auto now = Clock::now();
+            auto deadline = Clock::time_point::max();
+            auto ready = small.end();
+            for (auto it = small.begin(); it != small.end(); ++it) {
+                auto due = it->second.front()->arrived + linger;
+                bool full = int(it->second.size()) >= opt.max_batch;
+                if (full || due <= now || stopping) {
+                    if (ready == small.end() ||
+                        it->second.front()->seq < ready->second.front()->seq)
+                        ready = it;
+                } else {
+                    deadline = std::min(deadline, due);
+                }
+            }
+            if (ready != small.end()) {
+                std::vector<JobPtr> batch;
+                auto &q = ready->second;
+                while (!q.empty() && int(batch.size()) < opt.max_batch) {
+                    batch.push_back(std::move(q.front()));
+                    q.pop_front();
+                }
+                if (q.empty()) small.erase(ready);
+                return batch;
+            }
+            if (!large.empty()) {
+                std::pop_heap(large.begin(), large.end(), by_priority);
+                std::vector<JobPtr> one;
+                one.push_back(std::move(large.back()));
+                large.pop_back();
+                return one;
+            }
+            if (stopping) return {};
+            if (deadline == Clock::time_point::max()) {
+                cv.wait(lock);
+            } else {
+                cv.wait_until(lock, deadline);
+            }
+        }
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        cv.notify_all();
+    }
+
+   private:
+    using Shape = std::tuple<ElementType, int, int, int>;
+    const Options &opt;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::map<Shape, std::deque<JobPtr>> small;
+    std::vector<JobPtr> large;  // Heap by priority, then arrival
+    std::uint64_t seq = 0;
+    bool stopping = false;
+
+    static bool by_priority(const JobPtr &a, const JobPtr &b) {
+        if (a->req.priority != b->req.priority)
+            return a->req.priority < b->req.priority;
+        return a->seq > b->seq;
+    }
+};
+
+template <class T>
+void run_kernel(Job &job, int threads) {
+    const Svc::Request &r = job.req;
+    auto a = Matrix2<T>::view_of(static_cast<T *>(job.ops[0].p), r.m, r.k,
+                                 r.k);
+    auto b = Matrix2<T>::view_of(static_cast<T *>(job.ops[1].p), r.k, r.n,
+                                 r.n);
+    auto c = Matrix2<T>::view_of(static_cast<T *>(job.ops[2].p), r.m, r.n,
+                                 r.n);
+    for (int i = 0; i < r.m; i++) std::fill_n(&c.item(i, 0), r.n, T(0));
+    Multiplication::multiply_add(a, b, c, threads);
+}
+
+static void run_one(Job &job, int threads) {
+    switch (job.req.type) {
+        case ElementType::Int32: return run_kernel<int>(job, threads);
+        case ElementType::Float32: return run_kernel<float>(job, threads);
+        default: return run_kernel<double>(job, threads);
+    }
+}
+
+static void worker(Scheduler &sched, Metrics &metrics, ThreadPool &pool,
+                   const Options &opt) {
+    // The kernels and the batch loop below run their parts on the pool
+    ThreadPool::Use use(pool);
+    while (true) {
+        std::vector<JobPtr> batch = sched.take();
+        if (batch.empty()) return;
+        auto start = Clock::now();
+        metrics.started(batch.size());
+        if (batch.size() == 1) {
+            run_one(*batch[0], opt.threads);
+        } else {
+            // One request per thread at a time; each is small
+            parallel_for_rows(int(batch.size()), opt.threads,
+                              [&batch](int i0, int i1, int) {
+                                  for (int i = i0; i < i1; i++)
+                                      run_one(*batch[i], 1);
+                              });
+        }
+        auto end = Clock::now();
+        for (auto &&job : batch) {
+            Svc::Reply r{job->req.id,
+                         0,
+                         0,
+                         ns_between(job->arrived, start),
+                         ns_between(start, end),
+                         int(batch.size())};
+            job->conn->reply(r, "");
+            metrics.finished(r.queue_ns, ns_between(job->arrived,
+                                                    Clock::now()));
+        }
+    }
+}
+
+static std::size_t element_size(ElementType t) {
+    switch (t) {
+        case ElementType::Int32: return sizeof(int);
+        case ElementType::Float32: return sizeof(float);
+        case ElementType::Float64: return sizeof(double);
+        default: return 0;
+    }
+}
+
+/**
+ * @brief Checks a multiply request and maps its operands. Returns an
+ * error message, or an empty string on success. Closes the fds.
+ */
+static std::string admit(Job &job, int *fds, int n_fds) {
+    std::string err;
+    const Svc::Request &r = job.req;
+    const std::size_t elem = element_size(r.type);
+    if (n_fds != 3) {
+        err = "expected 3 file descriptors, got " + std::to_string(n_fds);
+    } else if (elem == 0) {
+        err = "unsupported element type";
+    } else if (r.m < 0 || r.k < 0 || r.n < 0) {
+        err = "negative dimension";
+    }
+    const std::size_t need[3] = {std::size_t(r.m) * r.k * elem,
+                                 std::size_t(r.k) * r.n * elem,
+                                 std::size_t(r.m) * r.n * elem};
+    for (int i = 0; i < n_fds; i++) {
+        // Unsealed, the file could be truncated while a kernel reads it
+        const int seals = fcntl(fds[i], F_GET_SEALS);
+        if (err.empty() && (seals < 0 || !(seals & F_SEAL_SHRINK))) {
+            err = std::string("operand ") + "ABC"[i] +
+                  " is not sealed with F_SEAL_SHRINK";
+        }
+        struct stat st;
+        if (err.empty() && (fstat(fds[i], &st) != 0 ||
+                            std::size_t(st.st_size) < need[i])) {
+            err = std::string("operand ") + "ABC"[i] + " is smaller than " +
+                  std::to_string(need[i]) + " bytes";
+        }
+        if (err.empty() && need[i] > 0) {
+            int prot = i == 2 ? PROT_READ | PROT_WRITE : PROT_READ;
+            job.ops[i].p = mmap(nullptr, need[i], prot, MAP_SHARED, fds[i], 0);
+            job.ops[i].len = need[i];
+            if (job.ops[i].p == MAP_FAILED)
+                err = std::string("mmap: ") + std::strerror(errno);
+        }
+        close(fds[i]);
+    }
+    return err;
+}
+
+static int listen_on(const std::string &path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+        throw ServiceException(path + ": socket path too long");
+    std::strcpy(addr.sun_path, path.c_str());
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) throw ServiceException(std::string("socket: ") +
+                                       std::strerror(errno));
+    // A socket file nobody answers on is left over from a crash
+    if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) ==
+        0) {
+        close(fd);
+        throw ServiceException(path + ": a daemon is already running");
+    }
+    unlink(path.c_str());
+    if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+        chmod(path.c_str(), 0600) != 0 || listen(fd, 64) != 0) {
+        std::string err = path + ": " + std::strerror(errno);
+        close(fd);
+        throw ServiceException(err);
+    }
+    return fd;
+}
+
+/**
+ * @brief Acts on one complete request of conn.
+ */
+static void handle(const std::shared_ptr<Connection> &conn, Scheduler &sched,
+                   Metrics &metrics, const Options &opt) {
+    auto job = std::make_unique<Job>();
+    job->req = conn->req;
+    job->arrived = Clock::now();
+    job->conn = conn;
+    int fds[3], n_fds = conn->n_fds;
+    std::copy_n(conn->fds, n_fds, fds);
+    conn->n_fds = 0;
+    Svc::Reply r{job->req.id, 0, 0, 0, 0, 0};
+    if (job->req.op == Svc::Op::Stats) {
+        for (int f = 0; f < n_fds; f++) close(fds[f]);
+        std::string text = metrics.json(opt);
+        r.text_len = std::uint32_t(text.size());
+        conn->reply(r, text);
+        return;
+    }
+    std::string err = job->req.op == Svc::Op::Multiply
+                          ? admit(*job, fds, n_fds)
+                          : "unknown operation";
+    if (!err.empty()) {
+        if (job->req.op != Svc::Op::Multiply) {
+            for (int f = 0; f < n_fds; f++) close(fds[f]);
+        }
+        metrics.failed();
+        r.status = 1;
+        r.text_len = std::uint32_t(err.size());
+        conn->reply(r, err);
+        return;
+    }
+    metrics.enqueued(job->mkn() < opt.batch_threshold);
+    sched.push(std::move(job));
+}
+
+/**
+ * @brief Reads what the socket holds without blocking, and hands on each
+ * request as it completes. Returns false if the connection is to be
+ * dropped: closed, failed, or not speaking the protocol.
+ */
+static bool read_requests(const std::shared_ptr<Connection> &conn,
+                          Scheduler &sched, Metrics &metrics,
+                          const Options &opt) {
+    Connection &c = *conn;
+    while (!c.backlogged()) {
+        // Never past the end of this request, so its fds stay its own
+        ssize_t r = Svc::recv_some(
+            c.fd, reinterpret_cast<char *>(&c.req) + c.got,
+            sizeof(c.req) - c.got, c.fds, &c.n_fds);
+        if (r < 0 && errno == EINTR) continue;
+        if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        if (r <= 0) {
+            // Replies still owed are sent after the client stops writing
+            c.eof = true;
+            return r == 0 && c.got == 0;
+        }
+        c.got += static_cast<std::size_t>(r);
+        if (c.got < sizeof(c.req)) continue;
+        c.got = 0;
+        if (c.req.magic != Svc::magic) return false;
+        handle(conn, sched, metrics, opt);
+    }
+    return true;
+}
+
+/**
+ * @brief Accepts connections, reads requests and finishes sending replies
+ * until SIGINT or SIGTERM.
+ */
+static void serve(int listener, int wake_read, Scheduler &sched,
+                  Metrics &metrics, const Options &opt) {
+    std::vector<std::shared_ptr<Connection>> conns;
+    while (!quit) {
+        std::vector<pollfd> pfds{{listener, POLLIN, 0},
+                                 {wake_read, POLLIN, 0}};
+        std::vector<std::size_t> slot(conns.size(), 0);  // 0: not polled
+        for (std::size_t i = 0; i < conns.size(); i++) {
+            auto &c = conns[i];
+            short events = 0;
+            if (!c->eof && !c->backlogged()) events |= POLLIN;
+            if (c->has_output()) events |= POLLOUT;
+            if (!events) continue;
+            slot[i] = pfds.size();
+            pfds.push_back({c->fd, events, 0});
+        }
+        if (poll(pfds.data(), pfds.size(), 200) < 0) continue;
+        if (pfds[0].revents & POLLIN) {
+            int fd = accept4(listener, nullptr, nullptr,
+                             SOCK_CLOEXEC | SOCK_NONBLOCK);
+            if (fd >= 0) conns.push_back(std::make_shared<Connection>(fd));
+            slot.resize(conns.size(), 0);
+        }
+        if (pfds[1].revents & POLLIN) {
+            char buf[64];
+            while (read(wake_read, buf, sizeof(buf)) > 0) {
+            }
+        }
+        std::vector<std::shared_ptr<Connection>> open;
+        for (std::size_t i = 0; i < conns.size(); i++) {
+            auto &c = conns[i];
+            short revents = slot[i] ? pfds[slot[i]].revents : 0;
+            bool keep = true;
+            if (revents & POLLOUT) keep = c->flush();
+            if (keep && (revents & (POLLIN | POLLHUP | POLLERR)) && !c->eof)
+                keep = read_requests(c, sched, metrics, opt);
+            if (c->broken_peer()) keep = false;
+            // After end of stream, stay until the jobs in flight, which hold
+            // the other references, have replied and the replies are sent
+            if (c->eof && c.use_count() == 1 && !c->has_output()) keep = false;
+            if (keep) open.push_back(c);
+        }
+        conns.swap(open);
+    }
+}
+
+int main(int argc, char const *argv[]) {
+    Options opt;
+    for (int i = 1; i < argc; i++) {
+        std::string s(argv[i]);
+        bool has_value = i + 1 < argc;
+        if (s == "--help" || s == "-h") {
+            std::cout << help_msg << std::endl;
+            return 0;
+        } else if (s == "-s" && has_value) {
+            opt.socket = argv[++i];
+        } else if (s == "-w" && has_value) {
+            opt.workers = std::max(1, std::atoi(argv[++i]));
+        } else if (s == "-j" && has_value) {
+            opt.threads = std::max(1, std::atoi(argv[++i]));
+        } else if (s == "--batch-threshold" && has_value) {
+            opt.batch_threshold = std::atoll(argv[++i]);
+        } else if (s == "--max-batch" && has_value) {
+            opt.max_batch = std::max(1, std::atoi(argv[++i]));
+        } else if (s == "--linger-us" && has_value) {
+            opt.linger_us = std::max(0, std::atoi(argv[++i]));
+        } else if (s == "--stats") {
+            opt.stats = true;
+        } else {
+            std::cerr << "Unrecognized argument: " << s << '\n'
+                      << help_msg << std::endl;
+            return 1;
+        }
+    }
+    try {
+        if (opt.stats) {
+            std::cout << MultiplyClient(opt.socket).stats() << std::endl;
+            return 0;
+        }
+        int listener = listen_on(opt.socket);
+        int wake[2];
+        if (pipe2(wake, O_NONBLOCK | O_CLOEXEC) != 0)
+            throw ServiceException(std::string("pipe: ") +
+                                   std::strerror(errno));
+        wake_fd = wake[1];
+        std::signal(SIGINT, [](int) { quit = true; });
+        std::signal(SIGTERM, [](int) { quit = true; });
+        Scheduler sched(opt);
+        Metrics metrics;
+        ThreadPool pool(opt.threads);
+        std::vector<std::thread> workers;
+        for (int w = 0; w < opt.workers; w++)
+            workers.emplace_back(worker, std::ref(sched), std::ref(metrics),
+                                 std::ref(pool), std::cref(opt));
+        std::cerr << "Listening on " << opt.socket << " with " << opt.workers
+                  << " workers sharing " << opt.threads << " threads\n";
+        serve(listener, wake[0], sched, metrics, opt);
+        close(listener);
+        unlink(opt.socket.c_str());
+        sched.stop();
+        for (auto &&w : workers) w.join();
+        close(wake[0]);
+        close(wake[1]);
+        std::cerr << metrics.json(opt) << '\n';
+        return 0;
+    } catch (ServiceException &e) {
+        std::cerr << "Error: " << e.what() << '\n';
+    }
+    return 1;
+}
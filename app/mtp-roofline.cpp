@@ -0,0 +1,484 @@
+/**
+ * @file mtp-roofline.cpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief Measures the roofline of the host and places the multiplication
+ * algorithms on it
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * The compute roof of each element type is the rate of a multiply-add loop
+ * over many independent accumulators, which the compiler vectorizes with
+ * the instruction set this program was built for. The memory roofs are the
+ * rates of a STREAM triad (a = b + s c) whose working set fits in each
+ * cache level, and one that does not fit in any (DRAM).
+ *
+ * Each algorithm is then timed with the benchmark harness. Its arithmetic
+ * intensity is 2mkn flops over the compulsory traffic (mk + kn + mn)
+ * items. A kernel is bandwidth-bound when its intensity is left of the
+ * ridge point (peak flops / bandwidth) of the memory level its working set
+ * fits in, and compute-bound otherwise.
+ *
+ * With several threads, a cache instance shared by k CPUs (shared_cpu_list
+ * in sysfs) gives each of the threads on it 1/min(k, threads) of its size,
+ * while private levels add up over the threads. The triad working sets and
+ * the level a kernel fits in are sized accordingly.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "Parallel.hpp"
+
+using namespace MatMulImpl;
+using Clock = std::chrono::steady_clock;
+
+const char *help_msg =
+    "mtp-roofline [-h|--help] [--type t,...] [--alg a,...] [--sizes n,...]\n"
+    "             [--threads N] [--budget SECONDS] [--dram-mb MB]\n"
+    "             [--csv FILE] [--json FILE]\n"
+    "-h | --help\n"
+    "Prints this help message and exits.\n"
+    "--type t,...\n"
+    "Default: double,float,int\n"
+    "--alg a,...\n"
+    "Default: naive,div_and_conquer,strassen,strassen_dag,blocked,summa\n"
+    "--sizes n,...\n"
+    "Default: 64,128,256\n"
+    "Square problem sizes to place on the roofline\n"
+    "--threads N\n"
+    "Default: 1\n"
+    "Threads for the roofs and for algorithms that support them\n"
+    "--budget SECONDS\n"
+    "Default: 0.2\n"
+    "Measured time per roof and per kernel\n"
+    "--dram-mb MB\n"
+    "Default: twice the last-level cache, at least 64\n"
+    "Total working set of the DRAM triad\n"
+    "--csv FILE, --json FILE\n"
+    "Also write the roofs and kernel points as CSV or JSON\n";
+
+struct Options {
+    std::vector<std::string> types{"double", "float", "int"}, algs;
+    std::vector<int> sizes{64, 128, 256};
+    int threads = 1;
+    double budget = 0.2;
+    std::size_t dram_bytes = 0;
+    std::string csv, json;
+};
+
+struct Roof {
+    std::string level;     // "L1", "L2", ..., "DRAM"
+    std::size_t capacity;  // Bytes of one instance of the level; 0 for DRAM
+    double bandwidth_gbs;  // Triad rate
+    int shared_by = 1;     // CPUs sharing one instance
+};
+
+/**
+ * @brief Bytes of the level available to each of threads threads, assuming
+ * they fill the CPUs of one instance before the next.
+ */
+static std::size_t per_thread_capacity(const Roof &r, int threads) {
+    return r.capacity / std::max(1, std::min(r.shared_by, threads));
+}
+
+/**
+ * @brief Bytes of the level that threads threads hold together: one
+ * instance when they all share it, one per thread when it is private.
+ */
+static std::size_t total_capacity(const Roof &r, int threads) {
+    return per_thread_capacity(r, threads) * threads;
+}
+
+struct KernelPoint {
+    std::string algorithm, type;
+    int size;
+    double intensity;  // flops per byte
+    double gflops;
+    std::string level;  // Memory level the working set fits in
+    double bound_gflops;
+    bool compute_bound;
+};
+
+static std::vector<std::string> split(const std::string &s) {
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) out.push_back(item);
+    }
+    return out;
+}
+
+/**
+ * @brief Number of CPUs in a sysfs CPU list such as "0-3,8-11".
+ */
+static int count_cpu_list(const std::string &list) {
+    int count = 0;
+    std::stringstream ss(list);
+    std::string part;
+    while (std::getline(ss, part, ',')) {
+        if (part.empty()) continue;
+        std::size_t dash = part.find('-');
+        int lo = std::stoi(part.substr(0, dash));
+        int hi = dash == std::string::npos ? lo
+                                           : std::stoi(part.substr(dash + 1));
+        count += hi - lo + 1;
+    }
+    return count;
+}
+
+/**
+ * @brief Data and unified cache levels of cpu0, smallest first.
+ */
+static std::vector<Roof> cache_levels() {
+    std::vector<Roof> levels;
+    for (int i = 0;; i++) {
+        std::string dir =
+            "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(i);
+        std::ifstream level_f(dir + "/level"), type_f(dir + "/type"),
+            size_f(dir + "/size"), shared_f(dir + "/shared_cpu_list");
+        int level;
+        std::string type, size;
+        if (!(level_f >> level) || !(type_f >> type) || !(size_f >> size))
+            break;
+        if (type == "Instruction") continue;
+        std::size_t bytes = std::stoul(size);
+        char unit = size.back();
+        if (unit == 'K') bytes <<= 10;
+        if (unit == 'M') bytes <<= 20;
+        std::string shared;
+        int shared_by = shared_f >> shared ? count_cpu_list(shared) : 1;
+        levels.push_back({"L" + std::to_string(level), bytes, 0,
+                          std::max(1, shared_by)});
+    }
+    if (levels.empty()) {
+        // Private L1 and L2, and an L3 shared by every CPU
+        int cpus = std::max(1u, std::thread::hardware_concurrency());
+        levels = {{"L1", std::size_t(32) << 10, 0, 1},
+                  {"L2", std::size_t(256) << 10, 0, 1},
+                  {"L3", std::size_t(8) << 20, 0, cpus}};
+    }
+    std::sort(levels.begin(), levels.end(),
+              [](const Roof &a, const Roof &b) {
+                  return a.capacity < b.capacity;
+              });
+    return levels;
+}
+
+// Integers are measured in unsigned arithmetic so wrap-around is defined
+template <class T, bool = std::is_integral_v<T>>
+struct Arithmetic {
+    using type = T;
+};
+template <class T>
+struct Arithmetic<T, true> {
+    using type = std::make_unsigned_t<T>;
+};
+
+/**
+ * @brief Multiply-add rate in Gop/s, each multiply-add counted as 2.
+ */
+template <class T>
+double peak_gflops(int threads, double budget) {
+    using U = typename Arithmetic<T>::type;
+    constexpr int acc_n = 64;  // Independent chains: covers FMA latency
+    constexpr long long inner = 4096;
+    const U x = std::is_integral_v<T> ? U(3) : U(0.999999);
+    const U y = std::is_integral_v<T> ? U(1) : U(1e-6);
+    std::vector<long long> passes(threads);
+    auto t0 = Clock::now();
+    parallel_for_rows(threads, threads, [&](int, int, int part) {
+        U acc[acc_n];
+        for (int j = 0; j < acc_n; j++) acc[j] = U(j);
+        auto deadline = Clock::now() + std::chrono::duration_cast<
+                                           Clock::duration>(
+                                           std::chrono::duration<double>(
+                                               budget));
+        long long n = 0;
+        do {
+            for (long long r = 0; r < inner; r++) {
+                for (int j = 0; j < acc_n; j++) acc[j] = acc[j] * x + y;
+            }
+            n++;
+        } while (Clock::now() < deadline);
+        U s = U();
+        for (int j = 0; j < acc_n; j++) s += acc[j];
+        passes[part] = n;
+        do_not_optimize(s);
+    });
+    double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+    long long total = 0;
+    for (long long n : passes) total += n;
+    return 2.0 * acc_n * inner * double(total) / secs * 1e-9;
+}
+
+/**
+ * @brief STREAM triad rate in GB/s with a per-thread working set of
+ * bytes (three arrays of doubles). Counts 24 bytes per item, as STREAM
+ * does.
+ */
+static double triad_gbs(std::size_t bytes, int threads, double budget) {
+    std::size_t n = std::max<std::size_t>(bytes / (3 * sizeof(double)), 64);
+    std::vector<long long> passes(threads);
+    std::vector<double> secs(threads);
+    parallel_for_rows(threads, threads, [&](int, int, int part) {
+        // Each thread allocates (and so first-touches) its own arrays
+        std::vector<double> a(n, 0.0), b(n, 1.0), c(n, 2.0);
+        const double s = 3.0;
+        for (std::size_t i = 0; i < n; i++) a[i] = b[i] + s * c[i];
+        auto t0 = Clock::now();
+        auto deadline =
+            t0 + std::chrono::duration_cast<Clock::duration>(
+                     std::chrono::duration<double>(budget));
+        long long p = 0;
+        do {
+            double *pa = a.data();
+            const double *pb = b.data(), *pc = c.data();
+            for (std::size_t i = 0; i < n; i++) pa[i] = pb[i] + s * pc[i];
+            std::swap(a, b);  // Keeps every pass dependent on the last
+            p++;
+        } while (Clock::now() < deadline);
+        secs[part] = std::chrono::duration<double>(Clock::now() - t0).count();
+        passes[part] = p;
+        do_not_optimize(a[n / 2]);
+    });
+    double gbs = 0;
+    for (int t = 0; t < threads; t++)
+        gbs += 24.0 * n * double(passes[t]) / secs[t] * 1e-9;
+    return gbs;
+}
+
+/**
+ * @brief Log-log chart of the roofs and the kernel points of one type.
+ */
+static void ascii_chart(std::ostream &os, const std::string &type,
+                        double peak, const std::vector<Roof> &roofs,
+                        const std::vector<KernelPoint> &points,
+                        const std::vector<std::string> &algs) {
+    constexpr int width = 64, height = 20;
+    const double x_lo = 1.0 / 64, x_hi = 1024;  // flops per byte
+    double y_hi = peak * 2, y_lo = y_hi / 1e5;
+    auto col = [&](double x) {
+        return int(std::floor((std::log(x) - std::log(x_lo)) /
+                              (std::log(x_hi) - std::log(x_lo)) * width));
+    };
+    auto row = [&](double y) {
+        return height - 1 -
+               int(std::floor((std::log(y) - std::log(y_lo)) /
+                              (std::log(y_hi) - std::log(y_lo)) * height));
+    };
+    std::vector<std::string> grid(height, std::string(width, ' '));
+    auto put = [&](int r, int c, char ch) {
+        if (r >= 0 && r < height && c >= 0 && c < width) grid[r][c] = ch;
+    };
+    const Roof &dram = roofs.back();
+    for (int c = 0; c < width; c++) {
+        double x = std::exp(std::log(x_lo) + (c + 0.5) / width *
+                                                 (std::log(x_hi) -
+                                                  std::log(x_lo)));
+        // Fastest cache first so DRAM's roof is drawn on top
+        put(row(std::min(peak, x * roofs.front().bandwidth_gbs)), c, '.');
+        double y = std::min(peak, x * dram.bandwidth_gbs);
+        put(row(y), c, y < peak ? '/' : '-');
+    }
+    for (auto &&p : points) {
+        if (p.type != type || !(p.gflops > 0)) continue;
+        auto it = std::find(algs.begin(), algs.end(), p.algorithm);
+        put(row(p.gflops), col(p.intensity),
+            char('A' + (it - algs.begin())));
+    }
+    os << "\nRoofline, " << type << " (x: flops/byte, " << x_lo << " to "
+       << x_hi << "; y: GFLOP/s, log scale, top " << y_hi << ")\n";
+    for (auto &&line : grid) os << '|' << line << "|\n";
+    os << "'-' compute roof " << peak << " GFLOP/s, '/' DRAM "
+       << dram.bandwidth_gbs << " GB/s, '.' " << roofs.front().level << ' '
+       << roofs.front().bandwidth_gbs << " GB/s\n";
+    for (std::size_t i = 0; i < algs.size(); i++)
+        os << char('A' + i) << " = " << algs[i] << (i + 1 < algs.size() ? ", "
+                                                                        : "\n");
+}
+
+template <class T>
+double peak_of(const std::string &type, const Options &opt) {
+    double p = peak_gflops<T>(opt.threads, opt.budget);
+    std::cout << "Peak " << type << ": " << p << " GFLOP/s" << std::endl;
+    return p;
+}
+
+template <class T>
+void run_kernels(const char *type, double peak, const std::vector<Roof> &roofs,
+                 const Options &opt, std::vector<KernelPoint> &points) {
+    BenchmarkConfig config;
+    config.budget_seconds = opt.budget;
+    for (auto &&alg : Benchmark::algorithms<T>()) {
+        if (!opt.algs.empty() &&
+            std::find(opt.algs.begin(), opt.algs.end(), alg.name) ==
+                opt.algs.end())
+            continue;
+        for (int size : opt.sizes) {
+            if (alg.needs_square_pow2 && !isP2(size)) continue;
+            int threads = alg.parallel ? opt.threads : 1;
+            BenchmarkCase spec{alg.name, type, size, size, size, threads};
+            auto res = Benchmark::run<T>(spec, alg, config);
+            double bytes = 3.0 * size * size * sizeof(T);
+            KernelPoint p{alg.name, type, size,
+                          2.0 * size * size * size / bytes,
+                          res.gflops, roofs.back().level, 0, false};
+            // The working set is spread over the caches of all its threads
+            const Roof *roof = &roofs.back();
+            for (auto &&r : roofs) {
+                if (r.capacity && bytes <= total_capacity(r, threads)) {
+                    roof = &r;
+                    break;
+                }
+            }
+            p.level = roof->level;
+            p.bound_gflops = std::min(peak, p.intensity * roof->bandwidth_gbs);
+            p.compute_bound = p.intensity * roof->bandwidth_gbs >= peak;
+            std::cout << std::setw(16) << std::left << alg.name << std::right
+                      << ' ' << type << ' ' << size << ": " << res.gflops
+                      << " GFLOP/s at " << p.intensity << " flop/B, roof "
+                      << p.bound_gflops << " (" << p.level << ", "
+                      << (p.compute_bound ? "compute" : "bandwidth")
+                      << "-bound), "
+                      << 100 * res.gflops / p.bound_gflops << "% of roof"
+                      << std::endl;
+            points.push_back(p);
+        }
+    }
+}
+
+int main(int argc, char const *argv[]) {
+    Options opt;
+    for (int i = 1; i < argc; i++) {
+        std::string s(argv[i]);
+        bool has_value = i + 1 < argc;
+        if (s == "--help" || s == "-h") {
+            std::cout << help_msg << std::endl;
+            return 0;
+        } else if (s == "--type" && has_value) {
+            opt.types = split(argv[++i]);
+        } else if (s == "--alg" && has_value) {
+            opt.algs = split(argv[++i]);
+        } else if (s == "--sizes" && has_value) {
+            opt.sizes.clear();
+            for (auto &&n : split(argv[++i]))
+                opt.sizes.push_back(std::stoi(n));
+        } else if (s == "--threads" && has_value) {
+            opt.threads = std::max(1, std::stoi(argv[++i]));
+        } else if (s == "--budget" && has_value) {
+            opt.budget = std::stod(argv[++i]);
+        } else if (s == "--dram-mb" && has_value) {
+            opt.dram_bytes = std::stoul(argv[++i]) << 20;
+        } else if (s == "--csv" && has_value) {
+            opt.csv = argv[++i];
+        } else if (s == "--json" && has_value) {
+            opt.json = argv[++i];
+        } else {
+            std::cerr << "Unrecognized argument: " << s << '\n'
+                      << help_msg << std::endl;
+            return 1;
+        }
+    }
+
+    // Memory roofs: half of each thread's share of a level leaves room for
+    // everything else
+    std::vector<Roof> roofs = cache_levels();
+    std::size_t llc = total_capacity(roofs.back(), opt.threads);
+    std::size_t dram = opt.dram_bytes
+                           ? opt.dram_bytes
+                           : std::max<std::size_t>(2 * llc, std::size_t(64)
+                                                                << 20);
+    roofs.push_back({"DRAM", 0, 0});
+    for (auto &&r : roofs) {
+        std::size_t ws = r.capacity ? per_thread_capacity(r, opt.threads) / 2
+                                    : dram / opt.threads;
+        r.bandwidth_gbs = triad_gbs(ws, opt.threads, opt.budget);
+        std::cout << "Triad " << r.level << " (" << (ws >> 10)
+                  << " KiB per thread): " << r.bandwidth_gbs << " GB/s"
+                  << std::endl;
+    }
+
+    std::vector<std::string> algs;
+    for (auto &&alg : Benchmark::algorithms<double>()) {
+        if (opt.algs.empty() || std::find(opt.algs.begin(), opt.algs.end(),
+                                          alg.name) != opt.algs.end())
+            algs.push_back(alg.name);
+    }
+    std::vector<std::pair<std::string, double>> peaks;
+    std::vector<KernelPoint> points;
+    for (auto &&type : opt.types) {
+        double peak;
+        if (type == "double") {
+            peak = peak_of<double>(type, opt);
+            run_kernels<double>("double", peak, roofs, opt, points);
+        } else if (type == "float") {
+            peak = peak_of<float>(type, opt);
+            run_kernels<float>("float", peak, roofs, opt, points);
+        } else if (type == "int") {
+            peak = peak_of<int>(type, opt);
+            run_kernels<int>("int", peak, roofs, opt, points);
+        } else {
+            std::cerr << "Unknown type " << type << ", skipped" << std::endl;
+            continue;
+        }
+        peaks.emplace_back(type, peak);
+        ascii_chart(std::cout, type, peak, roofs, points, algs);
+    }
+
+    if (!opt.csv.empty()) {
+        std::ofstream f(opt.csv);
+        f << "kind,name,type,size,intensity_flop_per_byte,gflops,"
+             "bandwidth_gbs,level,bound_gflops,bound\n";
+        for (auto &&p : peaks)
+            f << "compute_roof,peak," << p.first << ",,," << p.second
+              << ",,,,\n";
+        for (auto &&r : roofs)
+            f << "memory_roof," << r.level << ",,,,," << r.bandwidth_gbs
+              << ",,,\n";
+        for (auto &&p : points)
+            f << "kernel," << p.algorithm << ',' << p.type << ',' << p.size
+              << ',' << p.intensity << ',' << p.gflops << ",," << p.level
+              << ',' << p.bound_gflops << ','
+              << (p.compute_bound ? "compute" : "bandwidth") << '\n';
+    }
+    if (!opt.json.empty()) {
+        std::ofstream f(opt.json);
+        f << "{\n  \"threads\": " << opt.threads << ",\n  \"compute_roofs\": {";
+        for (std::size_t i = 0; i < peaks.size(); i++)
+            f << (i ? ", " : "") << '"' << peaks[i].first
+              << "\": " << peaks[i].second;
+        f << "},\n  \"memory_roofs\": [";
+        for (std::size_t i = 0; i < roofs.size(); i++)
+            f << (i ? ", " : "") << "{\"level\": \"" << roofs[i].level
+              << "\", \"capacity_bytes\": " << roofs[i].capacity
+              << ", \"shared_by\": " << roofs[i].shared_by
+              << ", \"bandwidth_gbs\": " << roofs[i].bandwidth_gbs << '}';
+        f << "],\n  \"kernels\": [";
+        for (std::size_t i = 0; i < points.size(); i++) {
+            auto &&p = points[i];
+            f << (i ? ",\n    " : "\n    ") << "{\"algorithm\": \""
+              << p.algorithm << "\", \"type\": \"" << p.type
+              << "\", \"size\": " << p.size
+              << ", \"intensity\": " << p.intensity
+              << ", \"gflops\": " << p.gflops << ", \"level\": \"" << p.level
+              << "\", \"bound_gflops\": " << p.bound_gflops
+              << ", \"bound\": \""
+              << (p.compute_bound ? "compute" : "bandwidth") << "\"}";
+        }
+        f << "\n  ]\n}\n";
+    }
+    return 0;
+}
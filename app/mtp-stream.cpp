@@ -0,0 +1,317 @@
+/**
+ * @file mtp-stream.cpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief Streams row-panels of A through C = AB against a resident B
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * Three threads form a read -> compute -> write pipeline. Each hand-off has
+ * two panel buffers, so while one panel of A is being multiplied the next is
+ * being read and the previous panel of C is being written. Memory use is
+ * four panels plus B, however tall A is.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/**
+ * Stream format:
+ * A is read as raw row-major items, B.rows() per row, from a file or stdin.
+ * A file in the native binary format (see BinaryFormat.hpp) is also
+ * accepted; its header is checked and skipped.
+ * C is written as raw row-major items, B.cols() per row, to a file or
+ * stdout.
+ */
+#include <chrono>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Algorithms.hpp"
+#include "BinaryFormat.hpp"
+#include "MatrixMarket.hpp"
+#include "Npy.hpp"
+
+using namespace MatMulImpl;
+using Mtp = MatMulImpl::Multiplication;
+using Clock = std::chrono::steady_clock;
+
+const char *help_msg =
+    "mtp-stream [-h|--help] -b B_FILE [-a A_FILE] [-o C_FILE] [-p ROWS]\n"
+    "           [-t double|float|int] [-j THREADS]\n"
+    "-h | --help\n"
+    "Prints this help message and exits.\n"
+    "-b B_FILE\n"
+    "The resident right operand: .npy, .mtx or native binary format\n"
+    "-a A_FILE\n"
+    "Default: - (stdin)\n"
+    "Raw row-major rows of A, or a native binary format file\n"
+    "-o C_FILE\n"
+    "Default: - (stdout)\n"
+    "Where the raw row-major rows of C are written\n"
+    "-p ROWS\n"
+    "Default: 256\n"
+    "Number of rows of A per panel\n"
+    "-t double|float|int\n"
+    "Default: double\n"
+    "Element type of A, B and C\n"
+    "-j THREADS\n"
+    "Default: number of hardware threads\n"
+    "Threads used by the multiply stage\n";
+
+/**
+ * @brief A blocking FIFO of panel slots handed from one stage to the next.
+ */
+class SlotQueue {
+   public:
+    struct Slot {
+        int buffer;
+        int rows;  // 0 marks the end of the stream
+    };
+    void push(Slot s) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            q.push_back(s);
+        }
+        cv.notify_one();
+    }
+    Slot pop() {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [this] { return !q.empty(); });
+        Slot s = q.front();
+        q.pop_front();
+        return s;
+    }
+
+   private:
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<Slot> q;
+};
+
+struct Options {
+    std::string a_path = "-", b_path, c_path = "-", type = "double";
+    int panel = 256;
+    int threads = default_thread_count();
+};
+
+static bool ends_with(const std::string &s, const char *suffix) {
+    std::size_t n = std::strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+template <class T>
+Matrix2<T> load_operand(const std::string &path) {
+    if (ends_with(path, ".npy")) return Npy::load<T>(path);
+    if (ends_with(path, ".mtx")) return MatrixMarket::read<T>(path);
+    return BinaryFormat::load<T>(path);
+}
+
+/**
+ * @brief Reads up to len bytes, retrying short reads. Returns bytes read;
+ * fewer than len means end of file or an error (check ferror).
+ */
+static std::size_t read_fully(std::FILE *f, char *p, std::size_t len) {
+    std::size_t got = 0;
+    while (got < len) {
+        std::size_t r = std::fread(p + got, 1, len - got, f);
+        if (r == 0) break;
+        got += r;
+    }
+    return got;
+}
+
+/**
+ * @brief Skips the header if the stream starts with a native binary format
+ * header; otherwise the bytes already read are kept as data.
+ * @return std::string Bytes read ahead that belong to the data
+ */
+template <class T>
+std::string skip_binary_header(std::FILE *f, int k) {
+    BinaryFormat::Header h;
+    std::size_t got = read_fully(f, reinterpret_cast<char *>(&h), sizeof(h));
+    std::string ahead(reinterpret_cast<char *>(&h), got);
+    if (got < sizeof(h) ||
+        std::memcmp(h.magic, BinaryFormat::magic, sizeof(h.magic)) != 0)
+        return ahead;
+    if (h.type != element_type_of<T>() || h.cols != std::uint64_t(k) ||
+        h.layout != 0)
+        throw MatrixIOException(
+            "A does not match B: wrong element type, width or layout");
+    std::string pad(h.data_offset - sizeof(h), '\0');
+    if (read_fully(f, &pad[0], pad.size()) != pad.size())
+        throw MatrixIOException("A ends inside its header");
+    return std::string();
+}
+
+template <class T>
+int run(const Options &opt) {
+    auto t_start = Clock::now();
+    Matrix2<T> b = load_operand<T>(opt.b_path);
+    const int k = b.m, n = b.n, p = opt.panel;
+    std::FILE *in = opt.a_path == "-" ? stdin
+                                      : std::fopen(opt.a_path.c_str(), "rb");
+    std::FILE *out = opt.c_path == "-" ? stdout
+                                       : std::fopen(opt.c_path.c_str(), "wb");
+    auto close_files = [&] {
+        if (in && in != stdin) std::fclose(in);
+        if (out && out != stdout) std::fclose(out);
+    };
+    if (!in || !out) {
+        std::cerr << "Cannot open " << (!in ? opt.a_path : opt.c_path) << '\n';
+        close_files();
+        return 1;
+    }
+    std::string ahead;
+    try {
+        ahead = skip_binary_header<T>(in, k);
+    } catch (...) {
+        close_files();
+        throw;
+    }
+
+    Matrix2<T> a_buf[2] = {Matrix2<T>(p, k), Matrix2<T>(p, k)};
+    Matrix2<T> c_buf[2] = {Matrix2<T>(p, n), Matrix2<T>(p, n)};
+    SlotQueue a_free, a_full, c_free, c_full;
+    for (int s = 0; s < 2; s++) {
+        a_free.push({s, 0});
+        c_free.push({s, 0});
+    }
+    long long total_rows = 0, panels = 0;
+    double t_read = 0, t_compute = 0, t_write = 0;
+    bool short_row = false, write_error = false;
+    int read_errno = 0;  // set when reading A fails
+
+    std::thread reader([&] {
+        const std::size_t row_bytes = std::size_t(k) * sizeof(T);
+        while (true) {
+            auto slot = a_free.pop();
+            auto t0 = Clock::now();
+            char *dst =
+                reinterpret_cast<char *>(&a_buf[slot.buffer].item(0, 0));
+            std::size_t want = row_bytes * p, got = 0;
+            if (!ahead.empty()) {
+                got = std::min(want, ahead.size());
+                std::memcpy(dst, ahead.data(), got);
+                ahead.erase(0, got);
+            }
+            got += read_fully(in, dst + got, want - got);
+            if (got < want && std::ferror(in)) read_errno = errno ? errno : EIO;
+            if (row_bytes && got % row_bytes) short_row = true;
+            slot.rows = row_bytes ? static_cast<int>(got / row_bytes) : 0;
+            t_read += std::chrono::duration<double>(Clock::now() - t0).count();
+            a_full.push(slot);
+            if (slot.rows < p) break;
+        }
+    });
+    std::thread writer([&] {
+        while (true) {
+            auto slot = c_full.pop();
+            if (slot.rows == 0) break;
+            auto t0 = Clock::now();
+            std::size_t len = std::size_t(slot.rows) * n;
+            if (std::fwrite(&c_buf[slot.buffer].citem(0, 0), sizeof(T), len,
+                            out) != len)
+                write_error = true;
+            t_write +=
+                std::chrono::duration<double>(Clock::now() - t0).count();
+            c_free.push(slot);
+        }
+        std::fflush(out);
+    });
+    // Compute stage runs on the main thread
+    while (true) {
+        auto a_slot = a_full.pop();
+        if (a_slot.rows == 0) break;
+        auto c_slot = c_free.pop();
+        auto t0 = Clock::now();
+        auto c = c_buf[c_slot.buffer].sub(0, 0, a_slot.rows, n);
+        for (int i = 0; i < c.m; i++) std::fill_n(&c.item(i, 0), n, T(0));
+        Mtp::multiply_add(a_buf[a_slot.buffer].csub(0, 0, a_slot.rows, k), b,
+                          c, opt.threads);
+        t_compute += std::chrono::duration<double>(Clock::now() - t0).count();
+        total_rows += a_slot.rows;
+        panels++;
+        c_slot.rows = a_slot.rows;
+        c_full.push(c_slot);
+        bool last = a_slot.rows < p;
+        a_slot.rows = 0;
+        a_free.push(a_slot);
+        if (last) break;
+    }
+    c_full.push({0, 0});
+    reader.join();
+    writer.join();
+    if (in != stdin) std::fclose(in);
+    if (out != stdout && std::fclose(out) != 0) write_error = true;
+
+    double t_total =
+        std::chrono::duration<double>(Clock::now() - t_start).count();
+    std::cerr << "Streamed " << total_rows << " rows in " << panels
+              << " panels of " << p << "; A is " << total_rows << "x" << k
+              << ", B is " << k << "x" << n << '\n'
+              << "Stage busy time (s): read " << t_read << ", compute "
+              << t_compute << ", write " << t_write << "; wall " << t_total
+              << '\n';
+    if (short_row && !read_errno)
+        std::cerr << "Warning: trailing partial row ignored\n";
+    if (read_errno) {
+        std::cerr << "Error: cannot read " << opt.a_path << ": "
+                  << std::strerror(read_errno) << '\n';
+        return 1;
+    }
+    if (write_error) {
+        std::cerr << "Error: short write to " << opt.c_path << '\n';
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char const *argv[]) {
+    Options opt;
+    for (int i = 1; i < argc; i++) {
+        std::string s(argv[i]);
+        bool has_value = i + 1 < argc;
+        if (s == "--help" || s == "-h") {
+            std::cout << help_msg << std::endl;
+            return 0;
+        } else if (s == "-a" && has_value) {
+            opt.a_path = argv[++i];
+        } else if (s == "-b" && has_value) {
+            opt.b_path = argv[++i];
+        } else if (s == "-o" && has_value) {
+            opt.c_path = argv[++i];
+        } else if (s == "-p" && has_value) {
+            opt.panel = std::max(1, std::atoi(argv[++i]));
+        } else if (s == "-t" && has_value) {
+            opt.type = argv[++i];
+        } else if (s == "-j" && has_value) {
+            opt.threads = std::max(1, std::atoi(argv[++i]));
+        } else {
+            std::cerr << "Unrecognized argument: " << s << '\n'
+                      << help_msg << std::endl;
+            return 1;
+        }
+    }
+    if (opt.b_path.empty()) {
+        std::cerr << "Missing -b B_FILE\n" << help_msg << std::endl;
+        return 1;
+    }
+    try {
+        if (opt.type == "double") return run<double>(opt);
+        if (opt.type == "float") return run<float>(opt);
+        if (opt.type == "int") return run<int>(opt);
+        std::cerr << "Unknown type: " << opt.type << '\n';
+    } catch (MatrixIOException &e) {
+        std::cerr << "Error: " << e.what() << '\n';
+    } catch (BadDimensionException &e) {
+        std::cerr << "Error: " << e.what() << '\n';
+    }
+    return 1;
+}
@@ -12,9 +12,17 @@
 #define ALGORITHMS_HPP
 
 #include <algorithm>
+#include <deque>
 #include <tuple>
+#include <vector>
 
 #include "Matrixv2.hpp"
+#include "MemoryAccounting.hpp"
+#include "PackedMatrix.hpp"
+#include "Parallel.hpp"
+#include "PerfCounters.hpp"
+#include "TaskGraph.hpp"
+#include "Trace.hpp"
 
 namespace MatMulImpl {
 /**
@@ -24,7 +32,7 @@ namespace MatMulImpl {
  * @return true
  * @return false
  */
-bool isP2(int n) { return (n & (n - 1)) == 0; }
+inline bool isP2(int n) { return (n & (n - 1)) == 0; }
 
 template <class T>
 using SqSlices = std::tuple<Matrix2<T>, Matrix2<T>, Matrix2<T>, Matrix2<T>>;
@@ -39,8 +47,8 @@ using SqSlices = std::tuple<Matrix2<T>, Matrix2<T>, Matrix2<T>, Matrix2<T>>;
 template <class T>
 SqSlices<T> square_slice(Matrix2<T> &m) {
     int k = m.m / 2;
-    return std::make_tuple(m.sub(0, 0, k, k), m.sub(0, k, k, k),
-                           m.sub(k, 0, k, k), m.sub(k, k, k, k));
+    return std::make_tuple(m.borrow(0, 0, k, k), m.borrow(0, k, k, k),
+                           m.borrow(k, 0, k, k), m.borrow(k, k, k, k));
 }
 
 /**
@@ -51,11 +59,173 @@ class Multiplication {
    public:
     template <class T>
     static Matrix2<T> naive(const Matrix2<T> &a, const Matrix2<T> &b) {
+        MTP_MEMORY_TAG("naive");
         return a * b; // Only here because we want a similar function signature
     }
+    /**
+     * @brief Cache-blocked multiplication, C = AB
+     * @tparam T Type of element of matrix
+     * @param a Left operand matrix (m x k)
+     * @param b Right operand matrix (k x n)
+     * @param threads Number of threads; rows of C are split between them
+     * @return Matrix2<T> The result matrix (m x n)
+     */
+    template <class T>
+    static Matrix2<T> blocked(const Matrix2<T> &a, const Matrix2<T> &b,
+                              int threads = default_thread_count()) {
+        MTP_MEMORY_TAG("blocked");
+        Matrix2<T> c(a.m, b.n);
+        for (int i = 0; i < c.m; i++) {
+            for (int j = 0; j < c.n; j++) c.item(i, j) = 0;
+        }
+        multiply_add(a, b, c, threads);
+        return c;
+    }
+    /**
+     * @brief Accumulates the product AB into C, i.e. C += AB.
+     * Loops are tiled so that a panel of B stays in cache while it is
+     * reused by every row of A, and the innermost loop runs over contiguous
+     * items of B and C so that it vectorizes. Any of the operands may be
+     * views.
+     * @tparam T Type of element of matrix
+     * @param a Left operand matrix (m x k)
+     * @param b Right operand matrix (k x n)
+     * @param c Accumulator matrix (m x n)
+     * @param threads Number of threads; rows of C are split between them.
+     * Small products always run on the calling thread.
+     */
+    template <class T>
+    static void multiply_add(const Matrix2<T> &a, const Matrix2<T> &b,
+                             Matrix2<T> &c, int threads = 1) {
+        if (a.n != b.m || c.m != a.m || c.n != b.n) {
+            std::stringstream ss;
+            ss << "multiply_add: cannot accumulate a " << a.m << "x" << a.n
+               << " by " << b.m << "x" << b.n << " product into a " << c.m
+               << "x" << c.n << " matrix";
+            throw BadDimensionException(ss.str().c_str());
+        }
+        MTP_PERF_REGION("multiply_add");
+        constexpr int kc = 256, nc = 512;  // B panel of kc x nc items
+        constexpr long long parallel_threshold = 1LL << 18;
+        if ((long long)a.m * a.n * b.n < parallel_threshold) threads = 1;
+        c.unshare();  // Before the threads write to it
+        parallel_for_rows(a.m, threads, [&](int i0, int i1, int) {
+            for (int kk = 0; kk < a.n; kk += kc) {
+                int k_end = std::min(kk + kc, a.n);
+                for (int jj = 0; jj < b.n; jj += nc) {
+                    int j_end = std::min(jj + nc, b.n);
+                    for (int i = i0; i < i1; i++) {
+                        T *c_row = &c.item(i, 0);
+                        for (int k = kk; k < k_end; k++) {
+                            const T aik = a.citem(i, k);
+                            const T *b_row = &b.citem(k, 0);
+                            for (int j = jj; j < j_end; j++) {
+                                c_row[j] += aik * b_row[j];
+                            }
+                        }
+                    }
+                }
+            }
+        });
+    }
+    /**
+     * @brief Packs b for repeated use as the right operand; see
+     * PackedMatrix.hpp.
+     */
+    template <class T>
+    static PackedMatrix<T> prepack(const Matrix2<T> &b) {
+        MTP_MEMORY_TAG("prepack");
+        return PackedMatrix<T>(b);
+    }
+    /**
+     * @brief Cache-blocked multiplication by a packed operand, C = AB
+     * @tparam T Type of element of matrix
+     * @param a Left operand matrix (m x k)
+     * @param b Packed right operand (k x n)
+     * @param threads Number of threads; rows of C are split between them
+     * @return Matrix2<T> The result matrix (m x n)
+     */
+    template <class T>
+    static Matrix2<T> blocked(const Matrix2<T> &a, const PackedMatrix<T> &b,
+                              int threads = default_thread_count()) {
+        MTP_MEMORY_TAG("blocked");
+        Matrix2<T> c(a.m, b.n);
+        for (int i = 0; i < c.m; i++) std::fill_n(&c.item(i, 0), c.n, T(0));
+        multiply_add(a, b, c, threads);
+        return c;
+    }
+    /**
+     * @brief C += AB with B packed. The same kernel as multiply_add on a
+     * Matrix2, reading each panel of B from its contiguous block.
+     * @tparam T Type of element of matrix
+     * @param a Left operand matrix (m x k)
+     * @param b Packed right operand (k x n)
+     * @param c Accumulator matrix (m x n)
+     * @param threads Number of threads; rows of C are split between them.
+     * Small products always run on the calling thread.
+     */
+    template <class T>
+    static void multiply_add(const Matrix2<T> &a, const PackedMatrix<T> &b,
+                             Matrix2<T> &c, int threads = 1) {
+        if (a.n != b.m || c.m != a.m || c.n != b.n) {
+            std::stringstream ss;
+            ss << "multiply_add: cannot accumulate a " << a.m << "x" << a.n
+               << " by " << b.m << "x" << b.n << " product into a " << c.m
+               << "x" << c.n << " matrix";
+            throw BadDimensionException(ss.str().c_str());
+        }
+        MTP_PERF_REGION("multiply_add_packed");
+        constexpr int kc = PackedMatrix<T>::kc, nc = PackedMatrix<T>::nc;
+        constexpr long long parallel_threshold = 1LL << 18;
+        if ((long long)a.m * a.n * b.n < parallel_threshold) threads = 1;
+        c.unshare();  // Before the threads write to it
+        parallel_for_rows(a.m, threads, [&](int i0, int i1, int) {
+            for (int kk = 0, pk = 0; kk < a.n; kk += kc, pk++) {
+                int k_end = std::min(kk + kc, a.n);
+                for (int jj = 0, pj = 0; jj < b.n; jj += nc, pj++) {
+                    const int w = std::min(nc, b.n - jj);
+                    const int stride = b.strides[pj];
+                    const T *panel = b.panel(pk, pj);
+                    // Four rows of C at a time, so each row of the panel
+                    // is loaded once for four rows of A
+                    int i = i0;
+                    for (; i + 4 <= i1; i += 4) {
+                        T *c0 = &c.item(i, jj), *c1 = &c.item(i + 1, jj);
+                        T *c2 = &c.item(i + 2, jj), *c3 = &c.item(i + 3, jj);
+                        for (int k = kk; k < k_end; k++) {
+                            const T a0 = a.citem(i, k), a1 = a.citem(i + 1, k);
+                            const T a2 = a.citem(i + 2, k),
+                                    a3 = a.citem(i + 3, k);
+                            const T *b_row =
+                                panel + std::size_t(k - kk) * stride;
+                            for (int j = 0; j < w; j++) {
+                                const T bj = b_row[j];
+                                c0[j] += a0 * bj;
+                                c1[j] += a1 * bj;
+                                c2[j] += a2 * bj;
+                                c3[j] += a3 * bj;
+                            }
+                        }
+                    }
+                    for (; i < i1; i++) {
+                        T *c_row = &c.item(i, jj);
+                        for (int k = kk; k < k_end; k++) {
+                            const T aik = a.citem(i, k);
+                            const T *b_row =
+                                panel + std::size_t(k - kk) * stride;
+                            for (int j = 0; j < w; j++) {
+                                c_row[j] += aik * b_row[j];
+                            }
+                        }
+                    }
+                }
+            }
+        });
+    }
     template <class T>
     static Matrix2<T> div_and_conquer(const Matrix2<T> &a,
                                       const Matrix2<T> &b) {
+        MTP_MEMORY_TAG("div_and_conquer");
         Matrix2<T> c(a.m, b.n);
         _div_and_conquer(a, b, c);
         return c;
@@ -78,23 +248,34 @@ class Multiplication {
             throw BadDimensionException(
                 "div_and_conquer_sq2: Matrix is either not square or size is "
                 "not a power of 2.");
-        if (a.m == 1 && b.m == 1)
+        MTP_TRACE_FRAME("div_and_conquer_sq2", a.m, a.n, b.n);
+        MTP_MEMORY_TAG("div_and_conquer_sq2");
+        if (a.m == 1 && b.m == 1) {
+            MTP_TRACE_SPAN("base", sizeof(T));
             return Matrix2<T>::from({{a.citem(0, 0) * b.citem(0, 0)}});
-        Matrix2<T> c(a.n, a.n);
+        }
+        Matrix2<T> c = MTP_TRACED("alloc", sizeof(T) * a.n * a.n,
+                                  Matrix2<T>(a.n, a.n));
         int k = a.n / 2;
-        auto a11 = a.csub(0, 0, k, k), a12 = a.csub(0, k, k, k),
-             a21 = a.csub(k, 0, k, k), a22 = a.csub(k, k, k, k);
-        auto b11 = b.csub(0, 0, k, k), b12 = b.csub(0, k, k, k),
-             b21 = b.csub(k, 0, k, k), b22 = b.csub(k, k, k, k);
+        auto a11 = a.cborrow(0, 0, k, k), a12 = a.cborrow(0, k, k, k),
+             a21 = a.cborrow(k, 0, k, k), a22 = a.cborrow(k, k, k, k);
+        auto b11 = b.cborrow(0, 0, k, k), b12 = b.cborrow(0, k, k, k),
+             b21 = b.cborrow(k, 0, k, k), b22 = b.cborrow(k, k, k, k);
         auto &&[c11, c12, c21, c22] = square_slice(c);  // requires C++17
-        c11.sum_from(div_and_conquer_sq2(a11, b11),
-                     div_and_conquer_sq2(a12, b21));
-        c12.sum_from(div_and_conquer_sq2(a11, b12),
-                     div_and_conquer_sq2(a12, b22));
-        c21.sum_from(div_and_conquer_sq2(a21, b11),
-                     div_and_conquer_sq2(a22, b21));
-        c22.sum_from(div_and_conquer_sq2(a21, b12),
-                     div_and_conquer_sq2(a22, b22));
+        // c_q = x1 y1 + x2 y2, with the addition traced apart from the
+        // products
+        auto quadrant = [](Matrix2<T> &c_q, const Matrix2<T> &x1,
+                           const Matrix2<T> &y1, const Matrix2<T> &x2,
+                           const Matrix2<T> &y2) {
+            auto p1 = div_and_conquer_sq2(x1, y1);
+            auto p2 = div_and_conquer_sq2(x2, y2);
+            MTP_TRACE_SPAN("add", 0);
+            c_q.sum_from(p1, p2);
+        };
+        quadrant(c11, a11, b11, a12, b21);
+        quadrant(c12, a11, b12, a12, b22);
+        quadrant(c21, a21, b11, a22, b21);
+        quadrant(c22, a21, b12, a22, b22);
         return c;
     }
     /**
@@ -112,32 +293,192 @@ class Multiplication {
      */
     template <class T>
     static Matrix2<T> strassen(const Matrix2<T> &a, const Matrix2<T> &b) {
-        if (a.m == 1 && b.m == 1)
+        MTP_TRACE_FRAME("strassen", a.m, a.n, b.n);
+        MTP_MEMORY_TAG("strassen");
+        if (a.m == 1 && b.m == 1) {
+            MTP_TRACE_SPAN("base", sizeof(T));
             return Matrix2<T>::from({{a.citem(0, 0) * b.citem(0, 0)}});
-        auto &&a11 = a.csub(0, 0, a.m / 2, a.n / 2),
-             &&a12 = a.csub(0, a.n / 2, a.m / 2, a.n / 2);
-        auto &&a21 = a.csub(a.m / 2, 0, a.m / 2, a.n / 2),
-             &&a22 = a.csub(a.m / 2, a.n / 2, a.m / 2, a.n / 2);
-        auto &&b11 = b.csub(0, 0, b.m / 2, b.n / 2),
-             &&b12 = b.csub(0, b.n / 2, b.m / 2, b.n / 2);
-        auto &&b21 = b.csub(b.m / 2, 0, b.m / 2, b.n / 2),
-             &&b22 = b.csub(b.m / 2, b.n / 2, b.m / 2, b.n / 2);
-        auto &&m1 = strassen(a11 + a22, b11 + b22);
-        auto &&m2 = strassen(a21 + a22, b11);
-        auto &&m3 = strassen(a11, b12 - b22);
-        auto &&m4 = strassen(a22, b21 - b11);
-        auto &&m5 = strassen(a11 + a12, b22);
-        auto &&m6 = strassen(a21 - a11, b11 + b12);
-        auto &&m7 = strassen(a12 - a22, b21 + b22);
+        }
+        // Bytes of one quadrant; every sum or difference allocates one.
+        // Only read by the trace hooks.
+        [[maybe_unused]] const std::size_t q =
+            sizeof(T) * (a.m / 2) * (b.n / 2);
+        auto &&a11 = a.cborrow(0, 0, a.m / 2, a.n / 2),
+             &&a12 = a.cborrow(0, a.n / 2, a.m / 2, a.n / 2);
+        auto &&a21 = a.cborrow(a.m / 2, 0, a.m / 2, a.n / 2),
+             &&a22 = a.cborrow(a.m / 2, a.n / 2, a.m / 2, a.n / 2);
+        auto &&b11 = b.cborrow(0, 0, b.m / 2, b.n / 2),
+             &&b12 = b.cborrow(0, b.n / 2, b.m / 2, b.n / 2);
+        auto &&b21 = b.cborrow(b.m / 2, 0, b.m / 2, b.n / 2),
+             &&b22 = b.cborrow(b.m / 2, b.n / 2, b.m / 2, b.n / 2);
+        auto &&m1 = strassen(MTP_TRACED("add", 2 * q, a11 + a22),
+                             MTP_TRACED("add", 2 * q, b11 + b22));
+        auto &&m2 = strassen(MTP_TRACED("add", q, a21 + a22), b11);
+        auto &&m3 = strassen(a11, MTP_TRACED("add", q, b12 - b22));
+        auto &&m4 = strassen(a22, MTP_TRACED("add", q, b21 - b11));
+        auto &&m5 = strassen(MTP_TRACED("add", q, a11 + a12), b22);
+        auto &&m6 = strassen(MTP_TRACED("add", q, a21 - a11),
+                             MTP_TRACED("add", q, b11 + b12));
+        auto &&m7 = strassen(MTP_TRACED("add", q, a12 - a22),
+                             MTP_TRACED("add", q, b21 + b22));
+        Matrix2<T> c =
+            MTP_TRACED("alloc", 4 * q, Matrix2<T>(a.m, b.n));
+        MTP_TRACE_SPAN("add", 4 * q);
+        c.borrow(0, 0, c.m / 2, c.n / 2).sum_from(m1 + m4 - m5, m7);
+        c.borrow(0, c.n / 2, c.m / 2, c.n / 2).sum_from(m3, m5);
+        c.borrow(c.m / 2, 0, c.m / 2, c.n / 2).sum_from(m2, m4);
+        c.borrow(c.m / 2, c.n / 2, c.m / 2, c.n / 2).sum_from(m1 - m2 + m3, m6);
+        return c;
+    }
+    /**
+     * @brief Strassen's algorithm run as a task graph (see TaskGraph.hpp).
+     * The top levels of the recursion are unrolled into tasks: the sums of
+     * quadrants, the seven products, and the assembly of each quadrant of C.
+     * Each task starts when its own inputs are ready, so a quadrant of C is
+     * assembled once its products are done, and the sums for one product
+     * overlap the other products. Products below the unrolled levels, or of
+     * size cutoff or less, use the blocked kernel.
+     * @warning a, b must be n x n, n a power of 2
+     * @tparam T type of entries in a and b
+     * @param a Left operand matrix a
+     * @param b Right operand matrix b
+     * @param threads Number of workers
+     * @param cutoff Largest size that is multiplied without recursing
+     * @return Matrix2<T> Resultant matrix
+     */
+    template <class T>
+    static Matrix2<T> strassen_dag(const Matrix2<T> &a, const Matrix2<T> &b,
+                                   int threads = default_thread_count(),
+                                   int cutoff = 64) {
+        if (a.m != a.n || b.m != b.n || a.n != b.m || !isP2(a.n))
+            throw BadDimensionException(
+                "strassen_dag: Matrices must be n x n, n a power of 2.");
+        MTP_MEMORY_TAG("strassen_dag");
+        // Unroll until there are at least two leaf products per worker
+        int levels = 1;
+        for (long long leaves = 7; leaves < 2LL * threads; leaves *= 7)
+            levels++;
         Matrix2<T> c(a.m, b.n);
-        c.sub(0, 0, c.m / 2, c.n / 2).sum_from(m1 + m4 - m5, m7);
-        c.sub(0, c.n / 2, c.m / 2, c.n / 2).sum_from(m3, m5);
-        c.sub(c.m / 2, 0, c.m / 2, c.n / 2).sum_from(m2, m4);
-        c.sub(c.m / 2, c.n / 2, c.m / 2, c.n / 2).sum_from(m1 - m2 + m3, m6);
+        TaskGraph graph;
+        std::deque<Matrix2<T>> store;  // Temporaries; never move
+        _strassen_dag(graph, store, a, {}, b, {}, c, levels,
+                      std::max(1, cutoff));
+        graph.run(threads);
         return c;
     }
 
    private:
+    // Adds the tasks computing c = ab to the graph. a and b are complete
+    // once the tasks writing the tiles a_in and b_in are done. Returns the
+    // tiles that make up c.
+    template <class T>
+    static std::vector<TaskGraph::Tile> _strassen_dag(
+        TaskGraph &graph, std::deque<Matrix2<T>> &store, const Matrix2<T> &a,
+        const std::vector<TaskGraph::Tile> &a_in, const Matrix2<T> &b,
+        const std::vector<TaskGraph::Tile> &b_in, Matrix2<T> &c, int levels,
+        int cutoff) {
+        using Tiles = std::vector<TaskGraph::Tile>;
+        if (levels == 0 || a.n <= cutoff) {
+            Tiles in(a_in);
+            in.insert(in.end(), b_in.begin(), b_in.end());
+            graph.add("product", in, {&c}, [&a, &b, &c] {
+                for (int i = 0; i < c.m; i++)
+                    std::fill_n(&c.item(i, 0), c.n, T(0));
+                multiply_add(a, b, c);
+            });
+            return {&c};
+        }
+        const int h = a.n / 2;
+        auto quadrant = [&store, h](const Matrix2<T> &x, int i,
+                                    int j) -> const Matrix2<T> & {
+            store.push_back(Matrix2<T>::view_of(
+                const_cast<T *>(&x.citem(i * h, j * h)), h, h,
+                x.row_stride()));
+            return store.back();
+        };
+        auto &&a11 = quadrant(a, 0, 0), &&a12 = quadrant(a, 0, 1),
+             &&a21 = quadrant(a, 1, 0), &&a22 = quadrant(a, 1, 1);
+        auto &&b11 = quadrant(b, 0, 0), &&b12 = quadrant(b, 0, 1),
+             &&b21 = quadrant(b, 1, 0), &&b22 = quadrant(b, 1, 1);
+        // s = x + y, or x - y
+        auto sum = [&](const Matrix2<T> &x, const Matrix2<T> &y, bool minus,
+                       const Tiles &in) -> const Matrix2<T> & {
+            store.emplace_back(h, h);
+            Matrix2<T> &s = store.back();
+            graph.add("add", in, {&s}, [&x, &y, &s, minus] {
+                for (int i = 0; i < s.m; i++) {
+                    T *row = &s.item(i, 0);
+                    const T *xr = &x.citem(i, 0), *yr = &y.citem(i, 0);
+                    if (minus) {
+                        for (int j = 0; j < s.n; j++) row[j] = xr[j] - yr[j];
+                    } else {
+                        for (int j = 0; j < s.n; j++) row[j] = xr[j] + yr[j];
+                    }
+                }
+            });
+            return s;
+        };
+        const Matrix2<T> *m[7];
+        Tiles m_tiles[7];
+        auto product = [&](int i, const Matrix2<T> &x, const Tiles &x_in,
+                           const Matrix2<T> &y, const Tiles &y_in) {
+            store.emplace_back(h, h);
+            m[i] = &store.back();
+            m_tiles[i] = _strassen_dag(graph, store, x, x_in, y, y_in,
+                                       store.back(), levels - 1, cutoff);
+        };
+        auto &&s1 = sum(a11, a22, false, a_in),
+             &&s2 = sum(b11, b22, false, b_in);
+        product(0, s1, {&s1}, s2, {&s2});
+        auto &&s3 = sum(a21, a22, false, a_in);
+        product(1, s3, {&s3}, b11, b_in);
+        auto &&s4 = sum(b12, b22, true, b_in);
+        product(2, a11, a_in, s4, {&s4});
+        auto &&s5 = sum(b21, b11, true, b_in);
+        product(3, a22, a_in, s5, {&s5});
+        auto &&s6 = sum(a11, a12, false, a_in);
+        product(4, s6, {&s6}, b22, b_in);
+        auto &&s7 = sum(a21, a11, true, a_in),
+             &&s8 = sum(b11, b12, false, b_in);
+        product(5, s7, {&s7}, s8, {&s8});
+        auto &&s9 = sum(a12, a22, true, a_in),
+             &&s10 = sum(b21, b22, false, b_in);
+        product(6, s9, {&s9}, s10, {&s10});
+        // A quadrant of C: the sum of the products in plus minus those in
+        // minus
+        auto assemble = [&](int i, int j, std::vector<int> plus,
+                            std::vector<int> minus) -> TaskGraph::Tile {
+            store.push_back(c.borrow(i * h, j * h, h, h));
+            Matrix2<T> &q = store.back();
+            Tiles in;
+            std::vector<const Matrix2<T> *> add, sub;
+            for (int p : plus) {
+                in.insert(in.end(), m_tiles[p].begin(), m_tiles[p].end());
+                add.push_back(m[p]);
+            }
+            for (int p : minus) {
+                in.insert(in.end(), m_tiles[p].begin(), m_tiles[p].end());
+                sub.push_back(m[p]);
+            }
+            graph.add("assemble", in, {&q}, [&q, add, sub] {
+                for (int r = 0; r < q.m; r++) {
+                    T *row = &q.item(r, 0);
+                    std::fill_n(row, q.n, T(0));
+                    for (auto *x : add) {
+                        const T *xr = &x->citem(r, 0);
+                        for (int j = 0; j < q.n; j++) row[j] += xr[j];
+                    }
+                    for (auto *x : sub) {
+                        const T *xr = &x->citem(r, 0);
+                        for (int j = 0; j < q.n; j++) row[j] -= xr[j];
+                    }
+                }
+            });
+            return &q;
+        };
+        return {assemble(0, 0, {0, 3, 6}, {4}), assemble(0, 1, {2, 4}, {}),
+                assemble(1, 0, {1, 3}, {}), assemble(1, 1, {0, 2, 5}, {1})};
+    }
     // template <class T>
     // static void _div_and_conquer_sq2(const Matrix2<T> &a, const Matrix2<T>
     // &b,
@@ -165,26 +506,35 @@ class Multiplication {
         // Testing: Assert c.m == a.m, c.n == b.n
         // Reference:
         // https://en.wikipedia.org/wiki/Matrix_multiplication_algorithm#Non-square_matrices
+        MTP_TRACE_FRAME("_div_and_conquer", a.m, a.n, b.n);
         int sz_max = std::max({a.m, a.n, b.n});
-        if (sz_max == 2) {
+        if (sz_max <= 2) {
+            MTP_TRACE_SPAN("base", 0);
             c.product_from(a, b);
         } else if (sz_max == a.m) {
             // Split A horizontally
             int p = a.m / 2;
-            _div_and_conquer(a.csub(0, 0, p, a.n), b, c.sub(0, 0, p, c.n));
-            _div_and_conquer(a.csub(p, 0, a.m - p, a.n), b,
-                             c.sub(p, 0, a.m - p, c.n));
+            auto c1 = c.borrow(0, 0, p, c.n),
+                 c2 = c.borrow(p, 0, a.m - p, c.n);
+            _div_and_conquer(a.cborrow(0, 0, p, a.n), b, c1);
+            _div_and_conquer(a.cborrow(p, 0, a.m - p, a.n), b, c2);
         } else if (sz_max == b.n) {
             int k = b.n / 2;
-            _div_and_conquer(a, b.csub(0, 0, b.m, k), c.sub(0, 0, b.m, k));
-            _div_and_conquer(a, b.csub(0, k, b.m, b.n - k),
-                             c.sub(0, k, b.m, b.n - k));
+            auto c1 = c.borrow(0, 0, c.m, k),
+                 c2 = c.borrow(0, k, c.m, b.n - k);
+            _div_and_conquer(a, b.cborrow(0, 0, b.m, k), c1);
+            _div_and_conquer(a, b.cborrow(0, k, b.m, b.n - k), c2);
         } else {
             int k = a.n / 2;
-            Matrix2<T> c1(a.m, b.n), c2(a.m, b.n);
-            _div_and_conquer(a.csub(0, 0, a.m, k), b.csub(0, 0, k, b.n), c1);
-            _div_and_conquer(a.csub(0, k, a.m, a.n - k),
-                             b.csub(k, 0, a.n - k, b.n), c2);
+            Matrix2<T> c1 = MTP_TRACED("alloc", sizeof(T) * a.m * b.n,
+                                       Matrix2<T>(a.m, b.n));
+            Matrix2<T> c2 = MTP_TRACED("alloc", sizeof(T) * a.m * b.n,
+                                       Matrix2<T>(a.m, b.n));
+            _div_and_conquer(a.cborrow(0, 0, a.m, k), b.cborrow(0, 0, k, b.n),
+                             c1);
+            _div_and_conquer(a.cborrow(0, k, a.m, a.n - k),
+                             b.cborrow(k, 0, a.n - k, b.n), c2);
+            MTP_TRACE_SPAN("add", 0);
             c.sum_from(c1, c2);
         }
     }
@@ -0,0 +1,360 @@
+/**
+ * @file Async.hpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief Asynchronous multiplication on the library's executor.
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * multiply_async(a, b) returns a std::future of the product and returns
+ * immediately; the product is computed by the blocked kernel on a worker of
+ * an Executor (by default the process-wide Executor::instance(), with
+ * default_thread_count() workers).
+ *
+ * Operands are owned by the request, so they cannot go away while it runs:
+ * - matrices passed by value are moved in; a view is copied into storage
+ *   of its own at submission, because the matrix it looks into may not
+ *   outlive the request,
+ * - operands shared between requests can be passed as
+ *   std::shared_ptr<const Matrix2<T>>, which the request holds until done.
+ *
+ * Products below batch_threshold multiply-adds are not queued one by one:
+ * requests that arrive while a batch is pending join it, and the batch runs
+ * as one task, so a burst of small multiplies costs one hand-off instead of
+ * one per request. Small products passed as shared_ptr that share their
+ * right operand B go further: their left operands are stacked and the group
+ * runs as one kernel call, [A1; A2; ...] B, so B is read once per group
+ * instead of once per product. Small products with different operands
+ * cannot share a kernel call and run one after another within their task.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef ASYNC_HPP
+#define ASYNC_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Algorithms.hpp"
+#include "Matrixv2.hpp"
+#include "Parallel.hpp"
+
+namespace MatMulImpl {
+/**
+ * @brief A fixed pool of worker threads running tasks in FIFO order, plus a
+ * batch lane for small jobs.
+ */
+class Executor {
+   public:
+    static constexpr int max_batch = 64;  // Jobs per batch task
+
+    explicit Executor(int threads = default_thread_count()) {
+        threads = std::max(1, threads);
+        for (int t = 0; t < threads; t++)
+            workers.emplace_back([this] { work(); });
+    }
+    Executor(const Executor &) = delete;
+    Executor &operator=(const Executor &) = delete;
+    /**
+     * @brief Runs every task already submitted, then joins the workers.
+     */
+    ~Executor() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        cv.notify_all();
+        for (auto &&w : workers) w.join();
+    }
+
+    /**
+     * @brief The process-wide executor used by default.
+     */
+    static Executor &instance() {
+        static Executor executor;
+        return executor;
+    }
+
+    int size() const { return static_cast<int>(workers.size()); }
+
+    /**
+     * @brief Queues f; the future receives its result or exception.
+     */
+    template <class F>
+    auto submit(F &&f) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using R = std::invoke_result_t<std::decay_t<F>>;
+        auto task =
+            std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        auto fut = task->get_future();
+        post([task] { (*task)(); });
+        return fut;
+    }
+
+    /**
+     * @brief Queues a task that reports nothing. It must not throw.
+     */
+    void post(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            tasks.push_back(std::move(task));
+        }
+        cv.notify_one();
+    }
+
+    /**
+     * @brief Adds a small job to the pending batch, queuing a batch task if
+     * none is pending. It must not throw.
+     */
+    void post_batched(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            batch.push_back(std::move(job));
+            if (batch_queued) return;
+            batch_queued = true;
+            tasks.push_back([this] { run_batch(); });
+        }
+        cv.notify_one();
+    }
+
+   private:
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> tasks;
+    std::deque<std::function<void()>> batch;
+    bool batch_queued = false;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    void work() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    void run_batch() {
+        std::vector<std::function<void()>> jobs;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            while (!batch.empty() && int(jobs.size()) < max_batch) {
+                jobs.push_back(std::move(batch.front()));
+                batch.pop_front();
+            }
+            // Jobs beyond max_batch go to another batch task, so a large
+            // burst is still spread over the workers
+            if (batch.empty()) {
+                batch_queued = false;
+            } else {
+                tasks.push_back([this] { run_batch(); });
+                cv.notify_one();
+            }
+        }
+        for (auto &&job : jobs) job();
+    }
+};
+
+/**
+ * @brief Products with fewer multiply-adds than this are batched.
+ */
+constexpr long long batch_threshold = 1LL << 16;
+
+/**
+ * @brief A matrix that owns its storage: owning matrices are moved, views
+ * are copied.
+ */
+template <class T>
+Matrix2<T> detach(Matrix2<T> &&m) {
+    if (m.owns_storage()) return std::move(m);
+    return Matrix2<T>(m);  // Copying a view copies its items
+}
+
+namespace detail {
+// Queues compute() on ex, batched if the product is small
+template <class T, class F>
+std::future<Matrix2<T>> enqueue(long long mkn, F &&compute, Executor &ex) {
+    if (mkn >= batch_threshold) return ex.submit(std::forward<F>(compute));
+    auto task = std::make_shared<std::packaged_task<Matrix2<T>()>>(
+        std::forward<F>(compute));
+    auto fut = task->get_future();
+    ex.post_batched([task] { (*task)(); });
+    return fut;
+}
+
+// Small products with the same right operand, executor and thread count
+// that have not started yet. Each group is run by one batched task as a
+// single product of the stacked left operands with b.
+template <class T>
+class RhsGroups {
+   public:
+    static std::future<Matrix2<T>> add(std::shared_ptr<const Matrix2<T>> a,
+                                       std::shared_ptr<const Matrix2<T>> b,
+                                       int threads, Executor &ex) {
+        Key key{&ex, b.get(), threads};
+        std::promise<Matrix2<T>> result;
+        auto fut = result.get_future();
+        std::shared_ptr<Group> group;
+        bool fresh = false;
+        {
+            std::lock_guard<std::mutex> lock(mtx());
+            auto &slot = pending()[key];
+            // A full group keeps its task; later products start another
+            if (!slot || int(slot->as.size()) >= Executor::max_batch) {
+                slot = std::make_shared<Group>();
+                slot->b = std::move(b);
+                fresh = true;
+            }
+            group = slot;
+            group->as.push_back(std::move(a));
+            group->results.push_back(std::move(result));
+        }
+        if (fresh) ex.post_batched([group, key] { run(group, key); });
+        return fut;
+    }
+
+   private:
+    using Key = std::tuple<const Executor *, const void *, int>;
+    struct Group {
+        std::shared_ptr<const Matrix2<T>> b;
+        std::vector<std::shared_ptr<const Matrix2<T>>> as;
+        std::vector<std::promise<Matrix2<T>>> results;
+    };
+
+    static std::mutex &mtx() {
+        static std::mutex m;
+        return m;
+    }
+    static std::map<Key, std::shared_ptr<Group>> &pending() {
+        static std::map<Key, std::shared_ptr<Group>> groups;
+        return groups;
+    }
+
+    static void run(const std::shared_ptr<Group> &group, const Key &key) {
+        {
+            // Closes the group: from here on no product joins it
+            std::lock_guard<std::mutex> lock(mtx());
+            auto it = pending().find(key);
+            if (it != pending().end() && it->second == group)
+                pending().erase(it);
+        }
+        const Matrix2<T> &b = *group->b;
+        const int threads = std::get<2>(key);
+        try {
+            if (group->as.size() == 1) {
+                group->results[0].set_value(
+                    Multiplication::blocked(*group->as[0], b, threads));
+                return;
+            }
+            int rows = 0;
+            for (auto &&a : group->as) rows += a->m;
+            Matrix2<T> stacked(rows, b.m), c(rows, b.n);
+            for (int i = 0, r = 0; i < int(group->as.size()); i++) {
+                const Matrix2<T> &a = *group->as[i];
+                for (int k = 0; k < a.m; k++, r++) {
+                    std::copy_n(&a.citem(k, 0), b.m, &stacked.item(r, 0));
+                    std::fill_n(&c.item(r, 0), b.n, T(0));
+                }
+            }
+            Multiplication::multiply_add(stacked, b, c, threads);
+            for (int i = 0, r = 0; i < int(group->as.size()); i++) {
+                Matrix2<T> part(group->as[i]->m, b.n);
+                for (int k = 0; k < part.m; k++, r++)
+                    std::copy_n(&c.citem(r, 0), b.n, &part.item(k, 0));
+                group->results[i].set_value(std::move(part));
+            }
+        } catch (...) {
+            // Only results not delivered yet are still waiting
+            for (auto &&res : group->results) {
+                try {
+                    res.set_exception(std::current_exception());
+                } catch (const std::future_error &) {
+                }
+            }
+        }
+    }
+};
+}  // namespace detail
+
+/**
+ * @brief Computes AB on an executor.
+ * @tparam T Type of element of matrix
+ * @param a Left operand (m x k); moved in, or copied if it is a view
+ * @param b Right operand (k x n); moved in, or copied if it is a view
+ * @param threads Threads of the blocked kernel for this product
+ * @param ex Executor to run on
+ * @return std::future<Matrix2<T>> The product, or BadDimensionException
+ */
+template <class T>
+std::future<Matrix2<T>> multiply_async(Matrix2<T> a, Matrix2<T> b,
+                                       int threads = 1,
+                                       Executor &ex = Executor::instance()) {
+    long long mkn = (long long)a.m * a.n * b.n;
+    auto ops = std::make_shared<std::pair<Matrix2<T>, Matrix2<T>>>(
+        detach(std::move(a)), detach(std::move(b)));
+    return detail::enqueue<T>(
+        mkn,
+        [ops, threads] {
+            return Multiplication::blocked(ops->first, ops->second, threads);
+        },
+        ex);
+}
+
+/**
+ * @brief Computes AB on an executor, keeping shared operands alive until
+ * the product is done. The operands must not be modified meanwhile. Small
+ * products with the same b are coalesced into one kernel call.
+ */
+template <class T>
+std::future<Matrix2<T>> multiply_async(std::shared_ptr<const Matrix2<T>> a,
+                                       std::shared_ptr<const Matrix2<T>> b,
+                                       int threads = 1,
+                                       Executor &ex = Executor::instance()) {
+    long long mkn = (long long)a->m * a->n * b->n;
+    // Operands that do not conform take the plain path, which reports it
+    if (mkn < batch_threshold && a->n == b->m)
+        return detail::RhsGroups<T>::add(std::move(a), std::move(b), threads,
+                                         ex);
+    return detail::enqueue<T>(
+        mkn,
+        [a, b, threads] { return Multiplication::blocked(*a, *b, threads); },
+        ex);
+}
+
+/**
+ * @brief Submits many products at once. Small ones are grouped into
+ * batches of Executor::max_batch jobs.
+ * @return std::vector<std::future<Matrix2<T>>> One future per pair, in
+ * order
+ */
+template <class T>
+std::vector<std::future<Matrix2<T>>> multiply_batch(
+    std::vector<std::pair<Matrix2<T>, Matrix2<T>>> pairs,
+    Executor &ex = Executor::instance()) {
+    std::vector<std::future<Matrix2<T>>> futures;
+    futures.reserve(pairs.size());
+    for (auto &&p : pairs)
+        futures.push_back(
+            multiply_async(std::move(p.first), std::move(p.second), 1, ex));
+    return futures;
+}
+}  // namespace MatMulImpl
+
+#endif  // ASYNC_HPP
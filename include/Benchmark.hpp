@@ -0,0 +1,460 @@
+/**
+ * @file Benchmark.hpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief Benchmark harness: streaming statistics, latency histogram and
+ * JSON records for the multiplication algorithms.
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * No sample is ever stored. Every repetition updates a running mean and
+ * variance (Welford) and a log-linear latency histogram, so a case can run
+ * for millions of repetitions in constant memory.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Algorithms.hpp"
+#include "Distributed.hpp"
+#include "Generator.hpp"
+#include "MemoryAccounting.hpp"
+#include "PerfCounters.hpp"
+
+namespace MatMulImpl {
+/**
+ * @brief Makes value, and everything written to memory before, observable
+ * to the optimizer, so the work producing it cannot be elided. Emits no
+ * instructions.
+ */
+template <class T>
+inline void do_not_optimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static const void *volatile escape;
+    escape = &value;
+#endif
+}
+
+/**
+ * @brief Running count, mean, variance, minimum and maximum (Welford).
+ */
+class OnlineStats {
+   public:
+    void add(double x) {
+        n++;
+        double d = x - mu;
+        mu += d / n;
+        m2 += d * (x - mu);
+        lo = std::min(lo, x);
+        hi = std::max(hi, x);
+    }
+    long long count() const { return n; }
+    double mean() const { return mu; }
+    double variance() const { return n > 1 ? m2 / (n - 1) : 0.0; }
+    double stddev() const { return std::sqrt(variance()); }
+    double min() const { return n ? lo : 0.0; }
+    double max() const { return n ? hi : 0.0; }
+
+   private:
+    long long n = 0;
+    double mu = 0, m2 = 0;
+    double lo = std::numeric_limits<double>::infinity();
+    double hi = -std::numeric_limits<double>::infinity();
+};
+
+/**
+ * @brief HDR-style histogram of non-negative integer values.
+ * Values below 2^sub_bits are counted exactly; above that every power of
+ * two is split into 2^sub_bits buckets, so a reported percentile is within
+ * 2^-sub_bits (under 1%) of the true sample.
+ */
+class LatencyHistogram {
+   public:
+    static constexpr int sub_bits = 7;
+
+    LatencyHistogram() : counts((64 - sub_bits + 1) << sub_bits, 0) {}
+    void add(std::uint64_t v) {
+        counts[index(v)]++;
+        total++;
+    }
+    long long count() const { return total; }
+    /**
+     * @brief Value at quantile q in [0, 1]; the upper edge of its bucket.
+     */
+    std::uint64_t percentile(double q) const {
+        if (total == 0) return 0;
+        long long rank = std::max<long long>(1, std::llround(q * total));
+        long long seen = 0;
+        for (std::size_t i = 0; i < counts.size(); i++) {
+            seen += counts[i];
+            if (seen >= rank) return upper(i);
+        }
+        return upper(counts.size() - 1);
+    }
+
+   private:
+    std::vector<long long> counts;
+    long long total = 0;
+    static constexpr std::uint64_t sub = std::uint64_t(1) << sub_bits;
+
+    static std::size_t index(std::uint64_t v) {
+        if (v < sub) return v;
+        int e = 63 - __builtin_clzll(v) - sub_bits;
+        return (e + 1) * sub + ((v >> e) - sub);
+    }
+    static std::uint64_t upper(std::size_t i) {
+        if (i < sub) return i;
+        int e = static_cast<int>(i / sub) - 1;
+        std::uint64_t mantissa = i % sub + sub;
+        return ((mantissa + 1) << e) - 1;
+    }
+};
+
+/**
+ * @brief What to measure: one algorithm on one element type and shape.
+ */
+struct BenchmarkCase {
+    std::string algorithm;
+    std::string type;
+    int m, k, n;  // A is m x k, B is k x n
+    int threads = 1;
+};
+
+/**
+ * @brief Outcome of one case. Times are in nanoseconds.
+ */
+struct BenchmarkResult {
+    BenchmarkCase spec;
+    long long warmup_reps = 0;
+    OnlineStats stats;
+    std::uint64_t p50 = 0, p99 = 0;
+    double gflops = 0;         // 2mkn / mean time
+    double bandwidth_gbs = 0;  // (|A| + |B| + |C|) bytes / mean time
+    // Additional named metrics (e.g. hardware counters), emitted as is
+    std::vector<std::pair<std::string, double>> extra;
+};
+
+struct BenchmarkConfig {
+    double budget_seconds = 0.5;  // Measured time per case
+    int warmup = 2;               // Untimed repetitions first
+    long long min_reps = 3;
+    long long max_reps = 1000000;
+    std::size_t pool_bytes = std::size_t(64) << 20;  // Input pool limit
+    int max_pool = 8;                                // Input pairs per case
+    bool counters = false;  // Attach hardware counters, per multiplication
+};
+
+/**
+ * @brief A multiplication algorithm as seen by the harness.
+ */
+template <class T>
+struct AlgorithmEntry {
+    std::string name;
+    bool needs_square_pow2;  // Only defined for n x n, n a power of two
+    bool parallel;           // Uses the thread count it is given
+    std::string model;       // Algorithm name known to MemoryModel, or ""
+    std::function<Matrix2<T>(const Matrix2<T> &, const Matrix2<T> &, int)>
+        run;
+};
+
+class Benchmark {
+   public:
+    /**
+     * @brief The algorithms of Multiplication, by name.
+     */
+    template <class T>
+    static std::vector<AlgorithmEntry<T>> algorithms() {
+        using Mtp = Multiplication;
+        using M = Matrix2<T>;
+        return {
+            {"naive", true, false, "naive",
+             [](const M &a, const M &b, int) { return Mtp::naive(a, b); }},
+            {"div_and_conquer", true, false, "div_and_conquer_sq2",
+             [](const M &a, const M &b, int) {
+                 return Mtp::div_and_conquer_sq2(a, b);
+             }},
+            {"strassen", true, false, "strassen",
+             [](const M &a, const M &b, int) { return Mtp::strassen(a, b); }},
+            {"strassen_dag", true, true, "",
+             [](const M &a, const M &b, int threads) {
+                 return Mtp::strassen_dag(a, b, threads);
+             }},
+            {"blocked", false, true, "blocked",
+             [](const M &a, const M &b, int threads) {
+                 return Mtp::blocked(a, b, threads);
+             }},
+            // The largest square grid of processes that fits the threads
+            {"summa", false, true, "",
+             [](const M &a, const M &b, int threads) {
+                 int grid = std::max(1, int(std::sqrt(double(threads))));
+                 return Distributed::multiply(a, b, grid,
+                                              threads / (grid * grid));
+             }},
+        };
+    }
+
+    /**
+     * @brief Times f on a pool of pre-generated inputs.
+     * Inputs are generated before the clock starts and reused round-robin.
+     * After the warmup, repetitions continue until the time budget is
+     * spent (but at least min_reps and at most max_reps times).
+     * @tparam T Type of element of matrix
+     * @param spec The case; its shape sizes the inputs
+     * @param f Runs one multiplication
+     * @param config Budget and pool settings
+     * @param around Optional hook called as around(true) right before and
+     * around(false) right after the measured loop
+     */
+    template <class T>
+    static BenchmarkResult run(
+        const BenchmarkCase &spec,
+        const std::function<Matrix2<T>(const Matrix2<T> &,
+                                       const Matrix2<T> &, int)> &f,
+        const BenchmarkConfig &config,
+        const std::function<void(bool)> &around = nullptr) {
+        using Clock = std::chrono::steady_clock;
+        std::size_t pair_bytes =
+            (std::size_t(spec.m) * spec.k + std::size_t(spec.k) * spec.n) *
+            sizeof(T);
+        std::size_t fits =
+            config.pool_bytes / std::max<std::size_t>(pair_bytes, 1);
+        int pool_size = static_cast<int>(std::max<std::size_t>(
+            1, std::min<std::size_t>(config.max_pool, fits)));
+        std::vector<Matrix2<T>> as, bs;
+        for (int p = 0; p < pool_size; p++) {
+            as.push_back(
+                MatrixGenerator<T>::random_fill_seeded(spec.m, spec.k, 2 * p));
+            bs.push_back(MatrixGenerator<T>::random_fill_seeded(spec.k, spec.n,
+                                                                2 * p + 1));
+        }
+
+        BenchmarkResult res;
+        res.spec = spec;
+        // One untimed call under accounting; the measured calls run
+        // without an open MemoryScope
+        {
+            MemoryScope scope;
+            auto c = f(as[0], bs[0], spec.threads);
+            do_not_optimize(c);
+            res.extra.emplace_back("peak_bytes", double(scope.peak_bytes()));
+            res.extra.emplace_back("alloc_count", double(scope.allocations()));
+            res.extra.emplace_back("alloc_bytes",
+                                   double(scope.allocated_bytes()));
+        }
+        for (int w = 0; w < config.warmup; w++) {
+            auto c = f(as[w % pool_size], bs[w % pool_size], spec.threads);
+            do_not_optimize(c);
+            res.warmup_reps++;
+        }
+        LatencyHistogram hist;
+        auto deadline =
+            Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                               std::chrono::duration<double>(
+                                   config.budget_seconds));
+        std::optional<PerfCounters> counters;
+        if (config.counters) counters.emplace();
+        const bool counting = counters && counters->available();
+        if (around) around(true);
+        if (counting) counters->start();
+        for (long long r = 0; r < config.max_reps; r++) {
+            int p = r % pool_size;
+            auto t0 = Clock::now();
+            auto c = f(as[p], bs[p], spec.threads);
+            auto t1 = Clock::now();
+            do_not_optimize(c);
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          t1 - t0)
+                          .count();
+            res.stats.add(double(ns));
+            hist.add(static_cast<std::uint64_t>(ns));
+            if (r + 1 >= config.min_reps && t1 >= deadline) break;
+        }
+        if (counting) counters->stop();
+        if (around) around(false);
+        if (counting) add_counters(res, counters->read());
+
+        res.p50 = hist.percentile(0.50);
+        res.p99 = hist.percentile(0.99);
+        double secs = res.stats.mean() * 1e-9;
+        if (secs > 0) {
+            double flops = 2.0 * spec.m * spec.k * spec.n;
+            double bytes = (double(spec.m) * spec.k + double(spec.k) * spec.n +
+                            double(spec.m) * spec.n) *
+                           sizeof(T);
+            res.gflops = flops / secs * 1e-9;
+            res.bandwidth_gbs = bytes / secs * 1e-9;
+        }
+        return res;
+    }
+
+    /**
+     * @brief As above, and adds the peak predicted by MemoryModel when the
+     * algorithm has a model.
+     */
+    template <class T>
+    static BenchmarkResult run(
+        const BenchmarkCase &spec, const AlgorithmEntry<T> &alg,
+        const BenchmarkConfig &config,
+        const std::function<void(bool)> &around = nullptr) {
+        BenchmarkResult res = run<T>(spec, alg.run, config, around);
+        if (alg.model.empty()) return res;
+        res.extra.emplace_back(
+            "predicted_peak_bytes",
+            double(MemoryModel::predict_peak_bytes(alg.model, spec.m, spec.k,
+                                                   spec.n, sizeof(T))));
+        return res;
+    }
+
+    /**
+     * @brief Appends counter totals to the extras, per multiplication, and
+     * the derived instructions per cycle. Counters the kernel refused are
+     * written as null.
+     */
+    static void add_counters(BenchmarkResult &r, const PerfSample &total) {
+        double reps = double(std::max<long long>(r.stats.count(), 1));
+        for (int e = 0; e < PerfSample::events; e++)
+            r.extra.emplace_back(PerfCounters::name(e),
+                                 total.value[e] / reps);
+        r.extra.emplace_back("ipc",
+                             total.value[PerfCounters::Instructions] /
+                                 total.value[PerfCounters::Cycles]);
+    }
+
+    /**
+     * @brief One JSON object per result.
+     */
+    static std::string to_json(const BenchmarkResult &r) {
+        std::ostringstream os;
+        os << std::setprecision(6);
+        os << "{\"algorithm\": \"" << r.spec.algorithm << "\", \"type\": \""
+           << r.spec.type << "\", \"m\": " << r.spec.m
+           << ", \"k\": " << r.spec.k << ", \"n\": " << r.spec.n
+           << ", \"threads\": " << r.spec.threads
+           << ", \"warmup_reps\": " << r.warmup_reps
+           << ", \"reps\": " << r.stats.count()
+           << ", \"mean_ns\": " << r.stats.mean()
+           << ", \"stddev_ns\": " << r.stats.stddev()
+           << ", \"min_ns\": " << r.stats.min()
+           << ", \"max_ns\": " << r.stats.max() << ", \"p50_ns\": " << r.p50
+           << ", \"p99_ns\": " << r.p99 << ", \"gflops\": " << r.gflops
+           << ", \"bandwidth_gbs\": " << r.bandwidth_gbs;
+        for (auto &&kv : r.extra) {
+            os << ", \"" << kv.first << "\": ";
+            if (std::isfinite(kv.second)) {
+                os << kv.second;
+            } else {
+                os << "null";
+            }
+        }
+        os << "}";
+        return os.str();
+    }
+
+    /**
+     * @brief Writes {"context": {...}, "results": [...]}.
+     */
+    static void write_json(std::ostream &os,
+                           const std::vector<BenchmarkResult> &results,
+                           const BenchmarkConfig &config) {
+        os << "{\n  \"context\": {\"budget_seconds\": "
+           << config.budget_seconds << ", \"warmup\": " << config.warmup
+           << ", \"hardware_threads\": " << default_thread_count()
+           << "},\n  \"results\": [";
+        for (std::size_t i = 0; i < results.size(); i++) {
+            os << (i ? ",\n    " : "\n    ") << to_json(results[i]);
+        }
+        os << "\n  ]\n}\n";
+    }
+
+    /**
+     * @brief A result read back from a report: field name to raw value.
+     */
+    using Record = std::map<std::string, std::string>;
+
+    /**
+     * @brief Reads the result objects of a report written by write_json.
+     * Only the flat objects this harness writes are understood.
+     */
+    static std::vector<Record> read_json(std::istream &is) {
+        std::string text((std::istreambuf_iterator<char>(is)),
+                         std::istreambuf_iterator<char>());
+        std::vector<Record> out;
+        std::size_t pos = text.find("\"results\"");
+        if (pos == std::string::npos) return out;
+        while ((pos = text.find('{', pos)) != std::string::npos) {
+            std::size_t end = text.find('}', pos);
+            if (end == std::string::npos) break;
+            Record r;
+            std::size_t p = pos + 1;
+            while (true) {
+                std::size_t k0 = text.find('"', p);
+                if (k0 == std::string::npos || k0 > end) break;
+                std::size_t k1 = text.find('"', k0 + 1);
+                std::size_t colon = text.find(':', k1);
+                std::size_t v0 = text.find_first_not_of(" \t\n", colon + 1);
+                std::size_t v1;
+                std::string value;
+                if (text[v0] == '"') {
+                    v1 = text.find('"', v0 + 1);
+                    value = text.substr(v0 + 1, v1 - v0 - 1);
+                    v1++;
+                } else {
+                    v1 = text.find_first_of(",}", v0);
+                    value = text.substr(v0, v1 - v0);
+                    while (!value.empty() &&
+                           std::isspace(static_cast<unsigned char>(
+                               value.back())))
+                        value.pop_back();
+                }
+                r[text.substr(k0 + 1, k1 - k0 - 1)] = value;
+                p = v1;
+            }
+            out.push_back(std::move(r));
+            pos = end + 1;
+        }
+        return out;
+    }
+
+    /**
+     * @brief Key identifying a case across runs.
+     */
+    static std::string case_key(const BenchmarkCase &c) {
+        std::ostringstream os;
+        os << c.algorithm << '/' << c.type << '/' << c.m << 'x' << c.k << 'x'
+           << c.n << "/t" << c.threads;
+        return os.str();
+    }
+    static std::string case_key(const Record &r) {
+        auto get = [&](const char *k) {
+            auto it = r.find(k);
+            return it == r.end() ? std::string() : it->second;
+        };
+        return get("algorithm") + '/' + get("type") + '/' + get("m") + 'x' +
+               get("k") + 'x' + get("n") + "/t" + get("threads");
+    }
+};
+}  // namespace MatMulImpl
+
+#endif  // BENCHMARK_HPP
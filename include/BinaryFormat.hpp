@@ -0,0 +1,415 @@
+/**
+ * @file BinaryFormat.hpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief Native binary file format for matrices, loadable without copying.
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * File layout:
+ * | Offset | Size | Field                                            |
+ * |--------|------|--------------------------------------------------|
+ * | 0      | 8    | Magic "MTX2BIN\0"                                |
+ * | 8      | 4    | Format version (1)                               |
+ * | 12     | 4    | Byte order mark 0x01020304, as written           |
+ * | 16     | 1    | Element type (ElementType)                       |
+ * | 17     | 1    | Element size in bytes                            |
+ * | 18     | 1    | Layout: 0 row-major, 1 column-major              |
+ * | 19     | 5    | Reserved, zero                                   |
+ * | 24     | 8    | Rows                                             |
+ * | 32     | 8    | Columns                                          |
+ * | 40     | 8    | Alignment of the data section                    |
+ * | 48     | 8    | Offset of the data section                       |
+ * | 56     | 8    | Checksum of the data section                     |
+ * Then zero padding up to the data offset (a multiple of the alignment,
+ * one page by default) and rows x columns raw items.
+ *
+ * Because the data section is page aligned, map() can hand out the items
+ * in place as a MappedMatrix; nothing is parsed or copied on load.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef BINARYFORMAT_HPP
+#define BINARYFORMAT_HPP
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "MappedMatrix.hpp"
+#include "Matrixv2.hpp"
+#include "Parallel.hpp"
+
+namespace MatMulImpl {
+enum class ElementType : std::uint8_t {
+    Unknown = 0,
+    Int8 = 1,
+    Int16 = 2,
+    Int32 = 3,
+    Int64 = 4,
+    UInt8 = 5,
+    UInt16 = 6,
+    UInt32 = 7,
+    UInt64 = 8,
+    Float32 = 9,
+    Float64 = 10,
+    Complex64 = 11,
+    Complex128 = 12
+};
+
+/**
+ * @brief The ElementType tag of a C++ type, Unknown if it has none.
+ */
+template <class T>
+constexpr ElementType element_type_of() {
+    if constexpr (std::is_same_v<T, float>) return ElementType::Float32;
+    if constexpr (std::is_same_v<T, double>) return ElementType::Float64;
+    if constexpr (std::is_same_v<T, std::complex<float>>)
+        return ElementType::Complex64;
+    if constexpr (std::is_same_v<T, std::complex<double>>)
+        return ElementType::Complex128;
+    if constexpr (std::is_integral_v<T>) {
+        constexpr bool s = std::is_signed_v<T>;
+        switch (sizeof(T)) {
+            case 1: return s ? ElementType::Int8 : ElementType::UInt8;
+            case 2: return s ? ElementType::Int16 : ElementType::UInt16;
+            case 4: return s ? ElementType::Int32 : ElementType::UInt32;
+            case 8: return s ? ElementType::Int64 : ElementType::UInt64;
+        }
+    }
+    return ElementType::Unknown;
+}
+
+class BinaryFormat {
+   public:
+    static constexpr char magic[8] = {'M', 'T', 'X', '2', 'B', 'I', 'N', 0};
+    static constexpr std::uint32_t version = 1;
+    static constexpr std::uint32_t byte_order_mark = 0x01020304;
+    static constexpr std::uint64_t default_alignment = 4096;
+
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byte_order;
+        ElementType type;
+        std::uint8_t elem_size;
+        std::uint8_t layout;  // 0 row-major, 1 column-major
+        std::uint8_t reserved[5];
+        std::uint64_t rows, cols;
+        std::uint64_t alignment;
+        std::uint64_t data_offset;
+        std::uint64_t checksum;
+    };
+    static_assert(sizeof(Header) == 64, "Header must be 64 bytes");
+
+    /**
+     * @brief Writes a matrix (or a view) to path in row-major layout.
+     * Rows are streamed out with large write() calls; the checksum is
+     * computed on the fly.
+     */
+    template <class T>
+    static void save(const Matrix2<T> &mat, const std::string &path) {
+        static_assert(element_type_of<T>() != ElementType::Unknown,
+                      "BinaryFormat: unsupported element type");
+        Header h = make_header<T>(mat.m, mat.n);
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) fail("cannot create", path);
+        std::vector<char> pad(h.data_offset, 0);
+        write_all(fd, pad.data(), pad.size(), path);  // header goes in last
+
+        // Contiguous rows are written in place; views are gathered into a
+        // buffer first so every write() stays large.
+        const std::size_t row_bytes = std::size_t(mat.n) * sizeof(T);
+        const std::size_t chunk_bytes = std::size_t(8) << 20;
+        int rows_per_chunk =
+            std::max<int>(1, row_bytes ? chunk_bytes / row_bytes : mat.m);
+        std::vector<char> buf;
+        Checksum sum;
+        for (int i = 0; i < mat.m; i += rows_per_chunk) {
+            int r_end = std::min(mat.m, i + rows_per_chunk);
+            std::size_t len = std::size_t(r_end - i) * row_bytes;
+            const char *src;
+            if (mat.row_stride() == mat.n) {
+                src = reinterpret_cast<const char *>(&mat.citem(i, 0));
+            } else {
+                buf.resize(len);
+                for (int r = i; r < r_end; r++)
+                    std::memcpy(buf.data() + std::size_t(r - i) * row_bytes,
+                                &mat.citem(r, 0), row_bytes);
+                src = buf.data();
+            }
+            sum.update(src, len);
+            write_all(fd, src, len, path);
+        }
+        h.checksum = sum.value();
+        if (pwrite(fd, &h, sizeof(h), 0) != sizeof(h)) {
+            ::close(fd);
+            fail("cannot write header", path);
+        }
+        if (::close(fd) != 0) fail("cannot close", path);
+    }
+
+    /**
+     * @brief Maps a file without copying. view() or tile() on the result
+     * give Matrix2 views straight into the page cache.
+     * @param path File to map
+     * @param verify_checksum Read the whole data section once and compare
+     * it with the stored checksum
+     * @param writable Map for writing; changes go to the file and the
+     * checksum must then be refreshed with seal()
+     */
+    template <class T>
+    static MappedMatrix<T> map(const std::string &path,
+                               bool verify_checksum = false,
+                               bool writable = false) {
+        Header h = read_header(path);
+        check_type<T>(h, path);
+        if (h.layout != 0)
+            throw MatrixIOException(
+                path + ": column-major data cannot be mapped as a row-major "
+                       "matrix; use load()");
+        auto mat = MappedMatrix<T>::open(path, h.rows, h.cols, h.data_offset,
+                                         writable);
+        if (verify_checksum &&
+            checksum(mat.row(0), data_bytes(h)) != h.checksum)
+            throw MatrixIOException(path + ": checksum mismatch");
+        return mat;
+    }
+
+    /**
+     * @brief Reads a file into a new heap matrix. Column-major files are
+     * transposed into the row-major Matrix2 layout.
+     */
+    template <class T>
+    static Matrix2<T> load(const std::string &path,
+                           bool verify_checksum = true) {
+        Header h = read_header(path);
+        check_type<T>(h, path);
+        if (h.rows > INT32_MAX || h.cols > INT32_MAX)
+            throw BadDimensionException(
+                "BinaryFormat::load: matrix too large for Matrix2; use map()");
+        auto src = MappedMatrix<T>::open(path, h.layout ? h.cols : h.rows,
+                                         h.layout ? h.rows : h.cols,
+                                         h.data_offset);
+        if (verify_checksum &&
+            checksum(src.row(0), data_bytes(h)) != h.checksum)
+            throw MatrixIOException(path + ": checksum mismatch");
+        int m = static_cast<int>(h.rows), n = static_cast<int>(h.cols);
+        Matrix2<T> mat(m, n);
+        parallel_for_rows(m, default_thread_count(), [&](int i0, int i1, int) {
+            for (int i = i0; i < i1; i++) {
+                if (h.layout == 0) {
+                    std::memcpy(&mat.item(i, 0), src.row(i), n * sizeof(T));
+                } else {
+                    for (int j = 0; j < n; j++) mat.item(i, j) = src.row(j)[i];
+                }
+            }
+        });
+        return mat;
+    }
+
+    /**
+     * @brief Creates a zero-filled file of the given shape and maps it for
+     * writing, e.g. to hold the result of OutOfCore::multiply. Call seal()
+     * once the data is final.
+     */
+    template <class T>
+    static MappedMatrix<T> create(const std::string &path, std::int64_t rows,
+                                  std::int64_t cols) {
+        Header h = make_header<T>(rows, cols);
+        h.checksum = 0;
+        auto mat = MappedMatrix<T>::create(path, rows, cols, h.data_offset);
+        int fd = ::open(path.c_str(), O_WRONLY);
+        if (fd < 0 || pwrite(fd, &h, sizeof(h), 0) != sizeof(h)) {
+            if (fd >= 0) ::close(fd);
+            fail("cannot write header", path);
+        }
+        ::close(fd);
+        return mat;
+    }
+
+    /**
+     * @brief Recomputes and stores the checksum of a file.
+     */
+    static void seal(const std::string &path) {
+        Header h = read_header(path);
+        auto bytes = MappedMatrix<char>::open(path, 1, h.data_offset +
+                                                           data_bytes(h));
+        h.checksum = checksum(bytes.row(0) + h.data_offset, data_bytes(h));
+        int fd = ::open(path.c_str(), O_WRONLY);
+        if (fd < 0 || pwrite(fd, &h, sizeof(h), 0) != sizeof(h)) {
+            if (fd >= 0) ::close(fd);
+            fail("cannot write header", path);
+        }
+        ::close(fd);
+    }
+
+    /**
+     * @brief Reads and validates the header of a file.
+     */
+    static Header read_header(const std::string &path) {
+        Header h;
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) fail("cannot open", path);
+        ssize_t got = pread(fd, &h, sizeof(h), 0);
+        ::close(fd);
+        if (got != sizeof(h) || std::memcmp(h.magic, magic, sizeof(magic)))
+            throw MatrixIOException(path + ": not a matrix file");
+        if (h.byte_order != byte_order_mark)
+            throw MatrixIOException(path +
+                                    ": written with another byte order");
+        if (h.version != version)
+            throw MatrixIOException(path + ": unsupported format version " +
+                                    std::to_string(h.version));
+        if (h.alignment == 0 || h.data_offset % h.alignment ||
+            h.data_offset < sizeof(Header))
+            throw MatrixIOException(path + ": corrupt header");
+        return h;
+    }
+
+    /**
+     * @brief Checksum of a byte range. The range is cut into fixed chunks
+     * hashed in parallel, then the chunk hashes are folded in order, so the
+     * value does not depend on the number of threads.
+     */
+    static std::uint64_t checksum(const void *data, std::size_t len) {
+        const std::size_t chunk = Checksum::chunk_bytes;
+        const auto *p = static_cast<const char *>(data);
+        std::size_t n_chunks = (len + chunk - 1) / chunk;
+        std::vector<std::uint64_t> parts(n_chunks);
+        parallel_for_rows(static_cast<int>(n_chunks), default_thread_count(),
+                          [&](int c0, int c1, int) {
+                              for (int c = c0; c < c1; c++) {
+                                  std::size_t off = std::size_t(c) * chunk;
+                                  parts[c] = Checksum::hash_chunk(
+                                      p + off, std::min(chunk, len - off));
+                              }
+                          });
+        std::uint64_t h = Checksum::seed;
+        for (auto part : parts) h = Checksum::fold(h, part);
+        return h;
+    }
+
+   private:
+    /**
+     * @brief Streaming form of checksum(), for data that arrives in pieces.
+     */
+    class Checksum {
+       public:
+        static constexpr std::size_t chunk_bytes = std::size_t(1) << 20;
+        static constexpr std::uint64_t seed = 0x9E3779B97F4A7C15ULL;
+
+        void update(const char *p, std::size_t len) {
+            while (len > 0) {
+                if (pending.empty() && len >= chunk_bytes) {
+                    h = fold(h, hash_chunk(p, chunk_bytes));
+                    p += chunk_bytes, len -= chunk_bytes;
+                    continue;
+                }
+                std::size_t take = std::min(len, chunk_bytes - pending.size());
+                pending.insert(pending.end(), p, p + take);
+                p += take, len -= take;
+                if (pending.size() == chunk_bytes) flush();
+            }
+        }
+        std::uint64_t value() {
+            if (!pending.empty()) flush();
+            return h;
+        }
+        static std::uint64_t fold(std::uint64_t h, std::uint64_t part) {
+            return mix(h ^ part) * 0xFF51AFD7ED558CCDULL;
+        }
+        static std::uint64_t hash_chunk(const char *p, std::size_t len) {
+            // Four independent lanes keep the multiplier pipeline busy
+            std::uint64_t lane[4] = {seed, seed + 1, seed + 2, seed + 3};
+            std::size_t words = len / 8, k = 0;
+            for (; k + 4 <= words; k += 4) {
+                for (int l = 0; l < 4; l++) {
+                    std::uint64_t w;
+                    std::memcpy(&w, p + 8 * (k + l), 8);
+                    lane[l] = round(lane[l], w);
+                }
+            }
+            for (std::size_t off = 8 * k; off + 8 <= len; off += 8) {
+                std::uint64_t w;
+                std::memcpy(&w, p + off, 8);
+                lane[0] = round(lane[0], w);
+            }
+            std::uint64_t tail = 0;
+            std::memcpy(&tail, p + 8 * words, len % 8);
+            lane[1] = round(lane[1], tail ^ len);
+            return mix(lane[0] ^ rotl(lane[1], 17) ^ rotl(lane[2], 31) ^
+                       rotl(lane[3], 47));
+        }
+
+       private:
+        std::vector<char> pending;
+        std::uint64_t h = seed;
+        void flush() {
+            h = fold(h, hash_chunk(pending.data(), pending.size()));
+            pending.clear();
+        }
+        static std::uint64_t rotl(std::uint64_t x, int r) {
+            return (x << r) | (x >> (64 - r));
+        }
+        static std::uint64_t round(std::uint64_t acc, std::uint64_t w) {
+            return rotl(acc + w * 0xC2B2AE3D27D4EB4FULL, 31) *
+                   0x9E3779B185EBCA87ULL;
+        }
+        static std::uint64_t mix(std::uint64_t x) {
+            x ^= x >> 33;
+            x *= 0xC4CEB9FE1A85EC53ULL;
+            return x ^ (x >> 29);
+        }
+    };
+
+    template <class T>
+    static Header make_header(std::int64_t rows, std::int64_t cols) {
+        Header h{};
+        std::memcpy(h.magic, magic, sizeof(magic));
+        h.version = version;
+        h.byte_order = byte_order_mark;
+        h.type = element_type_of<T>();
+        h.elem_size = sizeof(T);
+        h.layout = 0;
+        h.rows = rows, h.cols = cols;
+        h.alignment = default_alignment;
+        h.data_offset = default_alignment;
+        return h;
+    }
+    template <class T>
+    static void check_type(const Header &h, const std::string &path) {
+        if (h.type != element_type_of<T>() || h.elem_size != sizeof(T))
+            throw MatrixIOException(path + ": element type does not match");
+    }
+    static std::size_t data_bytes(const Header &h) {
+        return std::size_t(h.rows) * h.cols * h.elem_size;
+    }
+    static void write_all(int fd, const char *p, std::size_t len,
+                          const std::string &path) {
+        while (len > 0) {
+            ssize_t w = ::write(fd, p, len);
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) {
+                ::close(fd);
+                fail("cannot write", path);
+            }
+            p += w, len -= w;
+        }
+    }
+    [[noreturn]] static void fail(const char *what, const std::string &path) {
+        throw MatrixIOException(path + ": " + what + ": " +
+                                std::strerror(errno));
+    }
+};
+}  // namespace MatMulImpl
+
+#endif  // BINARYFORMAT_HPP
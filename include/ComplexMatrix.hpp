@@ -0,0 +1,223 @@
+/**
+ * @file ComplexMatrix.hpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief Complex matrices in split storage, multiplied with three real
+ * products (the 3M method).
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * A ComplexMatrix2 keeps its real and imaginary parts in two separate real
+ * Matrix2 planes, so each plane is contiguous and the real kernels
+ * vectorize over it, which interleaved std::complex items defeat. With
+ * A = Ar + i Ai and B = Br + i Bi, the 3M method (Gauss's trick, as in
+ * Karatsuba) forms
+ *     T1 = Ar Br,  T2 = Ai Bi,  T3 = (Ar + Ai)(Br + Bi)
+ *     Re C = T1 - T2,  Im C = T3 - T1 - T2,
+ * i.e. three real products instead of four, for about 25% fewer flops. The
+ * real products go through the blocked kernel or through strassen_dag.
+ * The imaginary part is slightly less accurate than with four products
+ * when |Ar| and |Ai| (or |Br| and |Bi|) differ widely in size.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef COMPLEX_MATRIX_HPP
+#define COMPLEX_MATRIX_HPP
+
+#include <algorithm>
+#include <complex>
+#include <sstream>
+#include <utility>
+
+#include "Algorithms.hpp"
+#include "Matrixv2.hpp"
+
+namespace MatMulImpl {
+template <class T>
+class ComplexMatrix2 {
+   public:
+    ComplexMatrix2(int m, int n) : re(m, n), im(m, n), m(m), n(n) {}
+    ComplexMatrix2(ComplexMatrix2<T>&& o) noexcept = default;
+
+    /**
+     * @brief Takes two planes of the same shape as the real and imaginary
+     * parts. Either may be a view.
+     */
+    static ComplexMatrix2<T> of(Matrix2<T>&& re, Matrix2<T>&& im) {
+        if (re.dim() != im.dim())
+            throw BadDimensionException(
+                "ComplexMatrix2: real and imaginary parts differ in size.");
+        return ComplexMatrix2<T>(std::move(re), std::move(im));
+    }
+    /**
+     * @brief Splits a matrix of interleaved complex numbers.
+     */
+    static ComplexMatrix2<T> from_interleaved(
+        const Matrix2<std::complex<T> >& z) {
+        ComplexMatrix2<T> c(z.m, z.n);
+        for (int i = 0; i < z.m; i++) {
+            const std::complex<T>* row = &z.citem(i, 0);
+            T *r = &c.re.item(i, 0), *s = &c.im.item(i, 0);
+            for (int j = 0; j < z.n; j++) {
+                r[j] = row[j].real();
+                s[j] = row[j].imag();
+            }
+        }
+        return c;
+    }
+    Matrix2<std::complex<T> > to_interleaved() const {
+        Matrix2<std::complex<T> > z(m, n);
+        for (int i = 0; i < m; i++) {
+            const T *r = &re.citem(i, 0), *s = &im.citem(i, 0);
+            std::complex<T>* row = &z.item(i, 0);
+            for (int j = 0; j < n; j++) row[j] = {r[j], s[j]};
+        }
+        return z;
+    }
+
+    std::complex<T> citem(int i, int j) const {
+        return {re.citem(i, j), im.citem(i, j)};
+    }
+    void set(int i, int j, std::complex<T> z) {
+        re.item(i, j) = z.real();
+        im.item(i, j) = z.imag();
+    }
+    /**
+     * @brief A view of the block of m x n items at (i, j).
+     */
+    ComplexMatrix2<T> sub(int i, int j, int m, int n) {
+        return ComplexMatrix2<T>(re.sub(i, j, m, n), im.sub(i, j, m, n));
+    }
+    Dim_t dim() const { return re.dim(); }
+
+    Matrix2<T> re, im;
+    const int m, n;
+
+   private:
+    ComplexMatrix2(Matrix2<T>&& re, Matrix2<T>&& im)
+        : re(std::move(re)), im(std::move(im)), m(this->re.m),
+          n(this->re.n) {}
+};
+
+/**
+ * @brief Contains functions for complex matrix multiplication
+ */
+class ComplexMultiplication {
+   public:
+    /**
+     * @brief Kernel of the real products
+     */
+    enum class Kernel {
+        Blocked,  // Multiplication::multiply_add
+        Strassen  // Multiplication::strassen_dag; n x n, n a power of 2
+    };
+
+    /**
+     * @brief C = AB with three real products (see ComplexMatrix.hpp).
+     * @tparam T float or double
+     * @param a Left operand matrix (m x k)
+     * @param b Right operand matrix (k x n)
+     * @param threads Number of threads of each real product
+     * @param kernel Kernel of the real products
+     * @return ComplexMatrix2<T> The result matrix (m x n)
+     */
+    template <class T>
+    static ComplexMatrix2<T> multiply_3m(const ComplexMatrix2<T>& a,
+                                         const ComplexMatrix2<T>& b,
+                                         int threads = default_thread_count(),
+                                         Kernel kernel = Kernel::Blocked) {
+        check("multiply_3m", a, b);
+        MTP_MEMORY_TAG("complex_3m");
+        const int m = a.m, k = a.n, n = b.n;
+        Matrix2<T> sa(m, k), sb(k, n);
+        add(a.re, a.im, sa);
+        add(b.re, b.im, sb);
+        ComplexMatrix2<T> c(m, n);
+        Matrix2<T> t2(m, n);
+        product(a.re, b.re, c.re, threads, kernel);  // T1
+        product(a.im, b.im, t2, threads, kernel);    // T2
+        product(sa, sb, c.im, threads, kernel);      // T3
+        for (int i = 0; i < m; i++) {
+            T *r = &c.re.item(i, 0), *s = &c.im.item(i, 0);
+            const T* u = &t2.citem(i, 0);
+            for (int j = 0; j < n; j++) {
+                s[j] -= r[j] + u[j];
+                r[j] -= u[j];
+            }
+        }
+        return c;
+    }
+
+    /**
+     * @brief C = AB with the four real products of the textbook formula,
+     * Re C = Ar Br - Ai Bi and Im C = Ar Bi + Ai Br.
+     * @tparam T float or double
+     * @param a Left operand matrix (m x k)
+     * @param b Right operand matrix (k x n)
+     * @param threads Number of threads of each real product
+     * @return ComplexMatrix2<T> The result matrix (m x n)
+     */
+    template <class T>
+    static ComplexMatrix2<T> multiply_4m(const ComplexMatrix2<T>& a,
+                                         const ComplexMatrix2<T>& b,
+                                         int threads = default_thread_count()) {
+        check("multiply_4m", a, b);
+        MTP_MEMORY_TAG("complex_4m");
+        const int m = a.m, k = a.n, n = b.n;
+        Matrix2<T> neg(m, k);
+        for (int i = 0; i < m; i++) {
+            const T* s = &a.im.citem(i, 0);
+            T* t = &neg.item(i, 0);
+            for (int j = 0; j < k; j++) t[j] = -s[j];
+        }
+        ComplexMatrix2<T> c(m, n);
+        for (int i = 0; i < m; i++) {
+            std::fill_n(&c.re.item(i, 0), n, T(0));
+            std::fill_n(&c.im.item(i, 0), n, T(0));
+        }
+        Multiplication::multiply_add(a.re, b.re, c.re, threads);
+        Multiplication::multiply_add(neg, b.im, c.re, threads);
+        Multiplication::multiply_add(a.re, b.im, c.im, threads);
+        Multiplication::multiply_add(a.im, b.re, c.im, threads);
+        return c;
+    }
+
+   private:
+    template <class T>
+    static void check(const char* who, const ComplexMatrix2<T>& a,
+                      const ComplexMatrix2<T>& b) {
+        if (a.n != b.m) {
+            std::stringstream ss;
+            ss << who << ": cannot multiply a " << a.m << "x" << a.n
+               << " by a " << b.m << "x" << b.n << " matrix";
+            throw BadDimensionException(ss.str().c_str());
+        }
+    }
+
+    template <class T>
+    static void add(const Matrix2<T>& x, const Matrix2<T>& y, Matrix2<T>& s) {
+        for (int i = 0; i < s.m; i++) {
+            const T *p = &x.citem(i, 0), *q = &y.citem(i, 0);
+            T* r = &s.item(i, 0);
+            for (int j = 0; j < s.n; j++) r[j] = p[j] + q[j];
+        }
+    }
+
+    // c = ab
+    template <class T>
+    static void product(const Matrix2<T>& a, const Matrix2<T>& b,
+                        Matrix2<T>& c, int threads, Kernel kernel) {
+        if (kernel == Kernel::Strassen) {
+            Matrix2<T> p = Multiplication::strassen_dag(a, b, threads);
+            for (int i = 0; i < c.m; i++)
+                std::copy_n(&p.citem(i, 0), c.n, &c.item(i, 0));
+            return;
+        }
+        for (int i = 0; i < c.m; i++) std::fill_n(&c.item(i, 0), c.n, T(0));
+        Multiplication::multiply_add(a, b, c, threads);
+    }
+};
+}  // namespace MatMulImpl
+
+#endif  // COMPLEX_MATRIX_HPP
@@ -0,0 +1,459 @@
+/**
+ * @file Distributed.hpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief SUMMA across local worker processes, over a pluggable transport.
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * Distributed::multiply(a, b, grid) splits one product over a grid x grid
+ * square of processes: the caller is rank 0 and forks the others. Each
+ * process has its own address space and allocator, so a worker that
+ * crashes takes down only itself; the caller notices, kills the rest and
+ * throws DistributedException.
+ *
+ * Distributed::summa() is the algorithm proper and only talks to a
+ * Transport: ordered, blocking point-to-point messages between ranks. The
+ * processes of a launch share ShmTransport, a POSIX shared memory segment
+ * with one channel per ordered pair of ranks. A network transport only has
+ * to implement the same four methods.
+ *
+ * SUMMA on a p x p grid: rank (i, j) owns tiles A(i, j), B(i, j) and
+ * C(i, j). At step s, A(i, s) is broadcast along row i and B(s, j) along
+ * column j, and every rank accumulates C(i, j) += A(i, s) B(s, j) with the
+ * blocked kernel. Rank 0 scatters A and B at the start and gathers C at the
+ * end. Shapes need not divide evenly by p.
+ *
+ * Workers are forked, so call multiply() when no other thread of the
+ * process holds a lock (e.g. not while multiply_async work is running).
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DISTRIBUTED_HPP
+#define DISTRIBUTED_HPP
+
+#include <fcntl.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Algorithms.hpp"
+#include "Matrixv2.hpp"
+#include "Parallel.hpp"
+
+namespace MatMulImpl {
+class DistributedException : std::exception {
+   public:
+    DistributedException(const std::string& s);
+    const char* what();
+
+   private:
+    std::string explain;
+};
+inline DistributedException::DistributedException(const std::string& s)
+    : explain(s) {}
+inline const char* DistributedException::what() { return explain.c_str(); }
+
+/**
+ * @brief Blocking point-to-point messages between the ranks of a job.
+ * Messages from one rank to another arrive in the order they were sent,
+ * and the receiver knows the size of each.
+ */
+class Transport {
+   public:
+    virtual ~Transport() = default;
+    virtual int rank() const = 0;
+    virtual int size() const = 0;
+    virtual void send(int to, const void* data, std::size_t bytes) = 0;
+    virtual void recv(int from, void* data, std::size_t bytes) = 0;
+};
+
+/**
+ * @brief Transport between processes forked after its construction.
+ * Channel (from, to) has two slots of chunk_bytes in shared memory and a
+ * pair of process-shared semaphores; longer messages go through in chunks,
+ * so the sender copies one chunk in while the receiver copies the previous
+ * one out.
+ */
+class ShmTransport : public Transport {
+   public:
+    /**
+     * @param procs Number of ranks
+     * @param chunk_bytes Size of one slot
+     */
+    explicit ShmTransport(int procs, std::size_t chunk_bytes = 1 << 18)
+        : procs(procs),
+          chunk(chunk_bytes),
+          send_slot(procs, 0),
+          recv_slot(procs, 0) {
+        stride = (sizeof(Channel) + 63) / 64 * 64 + 2 * chunk;
+        bytes = 64 + stride * procs * procs;
+        static std::atomic<int> serial{0};
+        std::string name = "/mtp-" + std::to_string(getpid()) + "-" +
+                           std::to_string(serial++);
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) fail("shm_open " + name);
+        // The mapping outlives the name, so nothing is left in /dev/shm
+        // whatever happens to the processes
+        shm_unlink(name.c_str());
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            close(fd);
+            fail("ftruncate " + name);
+        }
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED,
+                       fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) fail("mmap " + name);
+        base = static_cast<char*>(p);
+        for (int i = 0; i < procs * procs; i++) {
+            Channel* ch = channel(i / procs, i % procs);
+            sem_init(&ch->full, 1, 0);
+            sem_init(&ch->empty, 1, 2);
+        }
+    }
+    ShmTransport(const ShmTransport&) = delete;
+    ShmTransport& operator=(const ShmTransport&) = delete;
+    ~ShmTransport() {
+        for (int i = 0; i < procs * procs; i++) {
+            Channel* ch = channel(i / procs, i % procs);
+            sem_destroy(&ch->full);
+            sem_destroy(&ch->empty);
+        }
+        munmap(base, bytes);
+    }
+
+    /**
+     * @brief Sets the rank of the calling process, after the fork.
+     */
+    void attach(int r) { me = r; }
+    int rank() const override { return me; }
+    int size() const override { return procs; }
+
+    void send(int to, const void* data, std::size_t n) override {
+        Channel* ch = channel(me, to);
+        const char* src = static_cast<const char*>(data);
+        for (std::size_t off = 0; off < n; off += chunk) {
+            wait(&ch->empty);
+            int s = send_slot[to];
+            send_slot[to] ^= 1;
+            std::memcpy(slot(ch, s), src + off, std::min(chunk, n - off));
+            sem_post(&ch->full);
+        }
+    }
+    void recv(int from, void* data, std::size_t n) override {
+        Channel* ch = channel(from, me);
+        char* dst = static_cast<char*>(data);
+        for (std::size_t off = 0; off < n; off += chunk) {
+            wait(&ch->full);
+            int s = recv_slot[from];
+            recv_slot[from] ^= 1;
+            std::memcpy(dst + off, slot(ch, s), std::min(chunk, n - off));
+            sem_post(&ch->empty);
+        }
+    }
+
+    /**
+     * @brief Makes every rank blocked in (or later entering) send or recv
+     * throw DistributedException.
+     */
+    void abort() { aborted().store(1); }
+    /**
+     * @brief Called about every 50 ms while this process is blocked; may
+     * throw to give up.
+     */
+    void on_wait(std::function<void()> f) { waiting = std::move(f); }
+
+   private:
+    struct Channel {
+        sem_t full, empty;
+    };
+    int procs, me = 0;
+    std::size_t chunk, stride, bytes;
+    char* base = nullptr;
+    std::vector<int> send_slot, recv_slot;  // Next slot of each channel
+    std::function<void()> waiting;
+
+    static void fail(const std::string& what) {
+        throw DistributedException(what + ": " + std::strerror(errno));
+    }
+    std::atomic<int>& aborted() {
+        return *reinterpret_cast<std::atomic<int>*>(base);
+    }
+    Channel* channel(int from, int to) {
+        return reinterpret_cast<Channel*>(base + 64 +
+                                          stride * (from * procs + to));
+    }
+    char* slot(Channel* ch, int s) {
+        return reinterpret_cast<char*>(ch) + (sizeof(Channel) + 63) / 64 * 64 +
+               s * chunk;
+    }
+    void wait(sem_t* sem) {
+        while (true) {
+            if (aborted().load())
+                throw DistributedException("aborted by another rank");
+            timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_nsec += 50000000;
+            if (ts.tv_nsec >= 1000000000) {
+                ts.tv_sec++;
+                ts.tv_nsec -= 1000000000;
+            }
+            if (sem_timedwait(sem, &ts) == 0) return;
+            if (errno != ETIMEDOUT && errno != EINTR) fail("sem_timedwait");
+            if (waiting) waiting();
+        }
+    }
+};
+
+class Distributed {
+   public:
+    /**
+     * @brief C = AB on a grid x grid square of processes over ShmTransport.
+     * @tparam T Type of element of matrix
+     * @param a Left operand matrix (m x k)
+     * @param b Right operand matrix (k x n)
+     * @param grid Side of the process grid; grid * grid - 1 workers are
+     * forked. 1 multiplies in this process.
+     * @param threads Threads of the blocked kernel in each process
+     * @return Matrix2<T> The result matrix (m x n)
+     * @throw DistributedException if a worker fails or cannot be started
+     */
+    template <class T>
+    static Matrix2<T> multiply(const Matrix2<T>& a, const Matrix2<T>& b,
+                               int grid = 2, int threads = 1) {
+        check(a, b);
+        if (grid <= 1) return Multiplication::blocked(a, b, threads);
+        const int procs = grid * grid;
+        ShmTransport t(procs);
+        std::vector<pid_t> workers;
+        auto kill_all = [&workers] {
+            for (pid_t pid : workers) {
+                if (pid <= 0) continue;
+                kill(pid, SIGKILL);
+                waitpid(pid, nullptr, 0);
+            }
+        };
+        const pid_t parent = getpid();
+        for (int r = 1; r < procs; r++) {
+            pid_t pid = fork();
+            if (pid < 0) {
+                t.abort();
+                kill_all();
+                throw DistributedException(std::string("fork: ") +
+                                           std::strerror(errno));
+            }
+            if (pid == 0) {
+#ifdef __linux__
+                prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+                if (getppid() != parent) _exit(1);
+                int status = 0;
+                try {
+                    t.attach(r);
+                    summa<T>(t, nullptr, nullptr, threads);
+                } catch (...) {
+                    t.abort();
+                    status = 1;
+                }
+                // Skip the parent's static destructors and atexit handlers
+                _exit(status);
+            }
+            workers.push_back(pid);
+        }
+        // A worker that exits early has failed unless it exited cleanly
+        auto reap = [&workers](bool block) {
+            for (std::size_t r = 0; r < workers.size(); r++) {
+                if (workers[r] <= 0) continue;
+                int st = 0;
+                pid_t got = waitpid(workers[r], &st, block ? 0 : WNOHANG);
+                if (got != workers[r]) continue;
+                workers[r] = 0;
+                if (WIFEXITED(st) && WEXITSTATUS(st) == 0) continue;
+                std::string why = WIFSIGNALED(st)
+                                      ? "killed by signal " +
+                                            std::to_string(WTERMSIG(st))
+                                      : "exited with status " +
+                                            std::to_string(WEXITSTATUS(st));
+                throw DistributedException("worker " +
+                                           std::to_string(r + 1) + " " + why);
+            }
+        };
+        t.attach(0);
+        t.on_wait([&reap] { reap(false); });
+        try {
+            Matrix2<T> c = summa<T>(t, &a, &b, threads);
+            reap(true);
+            return c;
+        } catch (...) {
+            t.abort();
+            kill_all();
+            throw;
+        }
+    }
+
+    /**
+     * @brief SUMMA on the ranks of a transport, whose size must be a
+     * square. Every rank calls it; rank 0 passes the operands and gets C,
+     * the others pass nullptr and get a 0 x 0 matrix.
+     */
+    template <class T>
+    static Matrix2<T> summa(Transport& t, const Matrix2<T>* a,
+                            const Matrix2<T>* b, int threads = 1) {
+        const int p = static_cast<int>(std::lround(std::sqrt(t.size())));
+        if (p * p != t.size())
+            throw DistributedException("summa: " + std::to_string(t.size()) +
+                                       " ranks do not form a square grid");
+        const int me = t.rank(), row = me / p, col = me % p;
+        int dims[3];
+        if (me == 0) {
+            check(*a, *b);
+            dims[0] = a->m, dims[1] = a->n, dims[2] = b->n;
+            for (int r = 1; r < t.size(); r++) t.send(r, dims, sizeof(dims));
+        } else {
+            t.recv(0, dims, sizeof(dims));
+        }
+        const int m = dims[0], k = dims[1], n = dims[2];
+        RowRange rows = partition_rows(m, p, row),
+                 cols = partition_rows(n, p, col);
+        const int my_m = rows.end - rows.begin, my_n = cols.end - cols.begin;
+        RowRange a_k = partition_rows(k, p, col),
+                 b_k = partition_rows(k, p, row);
+
+        // Scatter
+        Matrix2<T> a_own(my_m, a_k.end - a_k.begin),
+            b_own(b_k.end - b_k.begin, my_n);
+        if (me == 0) {
+            for (int r = 1; r < t.size(); r++) {
+                RowRange ri = partition_rows(m, p, r / p),
+                         cj = partition_rows(n, p, r % p),
+                         ak = partition_rows(k, p, r % p),
+                         bk = partition_rows(k, p, r / p);
+                send_tile(t, r,
+                          a->csub(ri.begin, ak.begin, ri.end - ri.begin,
+                                  ak.end - ak.begin));
+                send_tile(t, r,
+                          b->csub(bk.begin, cj.begin, bk.end - bk.begin,
+                                  cj.end - cj.begin));
+            }
+            copy(a->csub(rows.begin, a_k.begin, a_own.m, a_own.n), a_own);
+            copy(b->csub(b_k.begin, cols.begin, b_own.m, b_own.n), b_own);
+        } else {
+            recv_tile(t, 0, a_own);
+            recv_tile(t, 0, b_own);
+        }
+
+        Matrix2<T> c(my_m, my_n);
+        for (int i = 0; i < my_m; i++) std::fill_n(&c.item(i, 0), my_n, T(0));
+        const int k_max = (k + p - 1) / p;
+        Matrix2<T> a_buf(my_m, k_max), b_buf(k_max, my_n);
+        for (int s = 0; s < p; s++) {
+            RowRange ks = partition_rows(k, p, s);
+            const int kw = ks.end - ks.begin;
+            // A(row, s) along the row, then B(s, col) down the column
+            Matrix2<T> a_s = a_buf.sub(0, 0, my_m, kw);
+            if (col == s) {
+                for (int j = 0; j < p; j++) {
+                    if (j != col) send_tile(t, row * p + j, a_own);
+                }
+            } else {
+                recv_tile(t, row * p + s, a_s);
+            }
+            Matrix2<T> b_s = b_buf.sub(0, 0, kw, my_n);
+            if (row == s) {
+                for (int i = 0; i < p; i++) {
+                    if (i != row) send_tile(t, i * p + col, b_own);
+                }
+            } else {
+                recv_tile(t, s * p + col, b_s);
+            }
+            Multiplication::multiply_add(col == s ? a_own : a_s,
+                                         row == s ? b_own : b_s, c, threads);
+        }
+
+        // Gather
+        if (me != 0) {
+            send_tile(t, 0, c);
+            return Matrix2<T>(0, 0);
+        }
+        Matrix2<T> out(m, n);
+        copy(c, out.sub(0, 0, my_m, my_n));
+        for (int r = 1; r < t.size(); r++) {
+            RowRange ri = partition_rows(m, p, r / p),
+                     cj = partition_rows(n, p, r % p);
+            Matrix2<T> dst = out.sub(ri.begin, cj.begin, ri.end - ri.begin,
+                                     cj.end - cj.begin);
+            recv_tile(t, r, dst);
+        }
+        return out;
+    }
+
+   private:
+    template <class T>
+    static void check(const Matrix2<T>& a, const Matrix2<T>& b) {
+        if (a.n != b.m) {
+            std::stringstream ss;
+            ss << "Distributed: cannot multiply a " << a.m << "x" << a.n
+               << " by a " << b.m << "x" << b.n << " matrix";
+            throw BadDimensionException(ss.str().c_str());
+        }
+    }
+    template <class T>
+    static void copy(const Matrix2<T>& from, Matrix2<T>&& to) {
+        for (int i = 0; i < from.m; i++)
+            std::copy_n(&from.citem(i, 0), from.n, &to.item(i, 0));
+    }
+    template <class T>
+    static void copy(const Matrix2<T>& from, Matrix2<T>& to) {
+        copy(from, std::move(to));
+    }
+    // Tiles travel as m x n contiguous items; strided views are packed
+    template <class T>
+    static void send_tile(Transport& t, int to, const Matrix2<T>& tile) {
+        const std::size_t items = std::size_t(tile.m) * tile.n;
+        if (items == 0) return;
+        if (tile.row_stride() == tile.n || tile.m == 1) {
+            t.send(to, &tile.citem(0, 0), items * sizeof(T));
+            return;
+        }
+        std::vector<T> packed(items);
+        for (int i = 0; i < tile.m; i++)
+            std::copy_n(&tile.citem(i, 0), tile.n,
+                        packed.data() + std::size_t(i) * tile.n);
+        t.send(to, packed.data(), items * sizeof(T));
+    }
+    template <class T>
+    static void recv_tile(Transport& t, int from, Matrix2<T>& tile) {
+        const std::size_t items = std::size_t(tile.m) * tile.n;
+        if (items == 0) return;
+        if (tile.row_stride() == tile.n || tile.m == 1) {
+            t.recv(from, &tile.item(0, 0), items * sizeof(T));
+            return;
+        }
+        std::vector<T> packed(items);
+        t.recv(from, packed.data(), items * sizeof(T));
+        for (int i = 0; i < tile.m; i++)
+            std::copy_n(packed.data() + std::size_t(i) * tile.n, tile.n,
+                        &tile.item(i, 0));
+    }
+};
+}  // namespace MatMulImpl
+
+#endif  // DISTRIBUTED_HPP
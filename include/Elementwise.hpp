@@ -0,0 +1,306 @@
+/**
+ * @file Elementwise.hpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief Elementwise maps and zips, and reductions, over Matrix2 and its
+ * views.
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * Every operation walks its matrices a row at a time through raw row
+ * pointers, with the function object inlined into the loop so that the
+ * compiler vectorizes it. Above parallel_threshold items the rows are
+ * split between threads with parallel_for_rows().
+ *
+ * A reduction keeps eight interleaved accumulators per row, which lets
+ * its loop vectorize without reassociating the operation behind the
+ * caller's back. map_reduce and zip_reduce apply their function on the
+ * way, in the same pass, so the mapped matrix is never stored. The rows
+ * are cut into chunks whose size depends only on the shape of the matrix;
+ * each chunk is reduced on its own and the chunk results are combined in
+ * order, so the result is the same, bit for bit, for any number of
+ * threads.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef ELEMENTWISE_HPP
+#define ELEMENTWISE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <type_traits>
+#include <vector>
+
+#include "Matrixv2.hpp"
+#include "MemoryAccounting.hpp"
+#include "Parallel.hpp"
+
+namespace MatMulImpl {
+/**
+ * @brief Contains the elementwise operations. Function objects are called
+ * from several threads at once and must not keep state between calls. A
+ * reduction's op must be associative, and init must be its identity (0
+ * for a sum, the lowest value for a maximum): each lane and each chunk
+ * starts from it.
+ */
+class Elementwise {
+   public:
+    static constexpr long long parallel_threshold = 1LL << 16;  // Items
+
+    template <class F, class... T>
+    using result_t = std::decay_t<std::invoke_result_t<F &, const T &...>>;
+
+    /**
+     * @brief f applied to every item of a
+     * @return Matrix2<R> The m x n matrix f(a(i, j))
+     */
+    template <class T, class F>
+    static Matrix2<result_t<F, T>> map(const Matrix2<T> &a, F f,
+                                       int threads = default_thread_count()) {
+        MTP_MEMORY_TAG("map");
+        Matrix2<result_t<F, T>> out(a.m, a.n);
+        transform("map", out, f, threads, a);
+        return out;
+    }
+    /**
+     * @brief out(i, j) = f(a(i, j)). out may be a itself.
+     */
+    template <class T, class F, class R>
+    static void map_into(const Matrix2<T> &a, F f, Matrix2<R> &out,
+                         int threads = default_thread_count()) {
+        transform("map_into", out, f, threads, a);
+    }
+    /**
+     * @brief f applied to the items of a and b pairwise
+     * @return Matrix2<R> The m x n matrix f(a(i, j), b(i, j))
+     */
+    template <class T, class U, class F>
+    static Matrix2<result_t<F, T, U>> zip(
+        const Matrix2<T> &a, const Matrix2<U> &b, F f,
+        int threads = default_thread_count()) {
+        MTP_MEMORY_TAG("zip");
+        Matrix2<result_t<F, T, U>> out(a.m, a.n);
+        transform("zip", out, f, threads, a, b);
+        return out;
+    }
+    /**
+     * @brief out(i, j) = f(a(i, j), b(i, j)). out may be a or b.
+     */
+    template <class T, class U, class F, class R>
+    static void zip_into(const Matrix2<T> &a, const Matrix2<U> &b, F f,
+                         Matrix2<R> &out,
+                         int threads = default_thread_count()) {
+        transform("zip_into", out, f, threads, a, b);
+    }
+
+    /**
+     * @brief op folded over the items of a, starting from init
+     */
+    template <class T, class R, class Op>
+    static R reduce(const Matrix2<T> &a, R init, Op op,
+                    int threads = default_thread_count()) {
+        return map_reduce(
+            a, [](const T &x) { return x; }, init, op, threads);
+    }
+    /**
+     * @brief op folded over f(a(i, j)), in one pass over a
+     */
+    template <class T, class F, class R, class Op>
+    static R map_reduce(const Matrix2<T> &a, F f, R init, Op op,
+                        int threads = default_thread_count()) {
+        return fold(a.m, a.n, f, init, op, threads, a);
+    }
+    /**
+     * @brief op folded over f(a(i, j), b(i, j)), in one pass over a and b
+     */
+    template <class T, class U, class F, class R, class Op>
+    static R zip_reduce(const Matrix2<T> &a, const Matrix2<U> &b, F f,
+                        R init, Op op, int threads = default_thread_count()) {
+        check("zip_reduce", a, b);
+        return fold(a.m, a.n, f, init, op, threads, a, b);
+    }
+
+    template <class T>
+    static Matrix2<T> scale(const Matrix2<T> &a, T s,
+                            int threads = default_thread_count()) {
+        return map(
+            a, [s](T x) { return s * x; }, threads);
+    }
+    /**
+     * @brief y += alpha x
+     */
+    template <class T>
+    static void axpy(T alpha, const Matrix2<T> &x, Matrix2<T> &y,
+                     int threads = default_thread_count()) {
+        zip_into(
+            x, y, [alpha](T p, T q) { return alpha * p + q; }, y, threads);
+    }
+    /**
+     * @brief The elementwise product a(i, j) b(i, j)
+     */
+    template <class T>
+    static Matrix2<T> hadamard(const Matrix2<T> &a, const Matrix2<T> &b,
+                               int threads = default_thread_count()) {
+        return zip(
+            a, b, [](T p, T q) { return p * q; }, threads);
+    }
+    /**
+     * @brief Every item of a limited to [lo, hi]
+     */
+    template <class T>
+    static Matrix2<T> clamp(const Matrix2<T> &a, T lo, T hi,
+                            int threads = default_thread_count()) {
+        return map(
+            a, [lo, hi](T x) { return x < lo ? lo : (hi < x ? hi : x); },
+            threads);
+    }
+    template <class T>
+    static T sum(const Matrix2<T> &a, int threads = default_thread_count()) {
+        return reduce(
+            a, T(0), [](T p, T q) { return p + q; }, threads);
+    }
+    /**
+     * @brief Sum of a(i, j) b(i, j)
+     */
+    template <class T>
+    static T dot(const Matrix2<T> &a, const Matrix2<T> &b,
+                 int threads = default_thread_count()) {
+        return zip_reduce(
+            a, b, [](T p, T q) { return p * q; }, T(0),
+            [](T p, T q) { return p + q; }, threads);
+    }
+    /**
+     * @brief Frobenius norm, accumulated in double
+     */
+    template <class T>
+    static double norm_fro(const Matrix2<T> &a,
+                           int threads = default_thread_count()) {
+        return std::sqrt(map_reduce(
+            a,
+            [](T x) {
+                const double d = static_cast<double>(x);
+                return d * d;
+            },
+            0.0, [](double p, double q) { return p + q; }, threads));
+    }
+    /**
+     * @brief Largest absolute value of an item (0 for an empty matrix)
+     */
+    template <class T>
+    static T max_abs(const Matrix2<T> &a,
+                     int threads = default_thread_count()) {
+        return map_reduce(
+            a, [](T x) { return magnitude(x); }, T(0),
+            [](T p, T q) { return p < q ? q : p; }, threads);
+    }
+    /**
+     * @brief Sum of the diagonal of a square matrix
+     */
+    template <class T>
+    static T trace(const Matrix2<T> &a) {
+        if (a.m != a.n) {
+            std::stringstream ss;
+            ss << "trace: a " << a.m << "x" << a.n << " matrix is not square";
+            throw BadDimensionException(ss.str().c_str());
+        }
+        T t = T(0);
+        for (int i = 0; i < a.n; i++) t += a.citem(i, i);
+        return t;
+    }
+
+   private:
+    static constexpr int lanes = 8;  // Accumulators of a row reduction
+    static constexpr long long chunk_items = 1LL << 14;
+
+    static int threads_for(long long items, int threads) {
+        return items < parallel_threshold ? 1 : threads;
+    }
+
+    template <class T>
+    static T magnitude(T x) {
+        if constexpr (std::is_unsigned<T>::value) {
+            return x;
+        } else {
+            return x < T(0) ? -x : x;
+        }
+    }
+
+    template <class T, class... S>
+    static void check(const char *who, const Matrix2<T> &a,
+                      const Matrix2<S> &...x) {
+        if (((x.m == a.m && x.n == a.n) && ...)) return;
+        std::stringstream ss;
+        ss << who << ": the matrices differ in size: " << a.m << "x" << a.n;
+        ((ss << ", " << x.m << "x" << x.n), ...);
+        throw BadDimensionException(ss.str().c_str());
+    }
+
+    // out(i, j) = f(x(i, j)...); out may be one of x
+    template <class R, class F, class... S>
+    static void transform(const char *who, Matrix2<R> &out, F &f,
+                          int threads, const Matrix2<S> &...x) {
+        check(who, out, x...);
+        if (out.m == 0 || out.n == 0) return;
+        out.unshare();  // Before the threads write to it
+        const int n = out.n;
+        parallel_for_rows(
+            out.m, threads_for((long long)out.m * n, threads),
+            [&](int begin, int end, int) {
+                for (int i = begin; i < end; i++)
+                    transform_row(n, f, &out.item(i, 0), &x.citem(i, 0)...);
+            });
+    }
+    template <class R, class F, class... S>
+    static void transform_row(int n, F &f, R *out, const S *...x) {
+        for (int j = 0; j < n; j++) out[j] = f(x[j]...);
+    }
+
+    // op folded over f(x(i, j)...), by chunks of rows combined in order
+    template <class F, class R, class Op, class... S>
+    static R fold(int m, int n, F &f, const R &init, Op &op, int threads,
+                  const Matrix2<S> &...x) {
+        if (m == 0 || n == 0) return init;
+        struct Partial {
+            R value;
+        };
+        const int rows_per_chunk =
+            static_cast<int>(std::max<long long>(1, chunk_items / n));
+        const int chunks = (m + rows_per_chunk - 1) / rows_per_chunk;
+        std::vector<Partial> partial(chunks, Partial{init});
+        parallel_for_rows(
+            chunks, threads_for((long long)m * n, threads),
+            [&](int begin, int end, int) {
+                for (int c = begin; c < end; c++) {
+                    const int i0 = c * rows_per_chunk,
+                              i1 = std::min(m, i0 + rows_per_chunk);
+                    R acc = init;
+                    for (int i = i0; i < i1; i++)
+                        acc = op(acc,
+                                 fold_row(n, f, init, op, &x.citem(i, 0)...));
+                    partial[c].value = acc;
+                }
+            });
+        R r = init;
+        for (const Partial &p : partial) r = op(r, p.value);
+        return r;
+    }
+    template <class F, class R, class Op, class... S>
+    static R fold_row(int n, F &f, const R &init, Op &op, const S *...x) {
+        R acc[lanes];
+        for (int l = 0; l < lanes; l++) acc[l] = init;
+        int j = 0;
+        for (; j + lanes <= n; j += lanes) {
+            for (int l = 0; l < lanes; l++)
+                acc[l] = op(acc[l], f(x[j + l]...));
+        }
+        for (; j < n; j++) acc[0] = op(acc[0], f(x[j]...));
+        R r = acc[0];
+        for (int l = 1; l < lanes; l++) r = op(r, acc[l]);
+        return r;
+    }
+};
+}  // namespace MatMulImpl
+
+#endif  // ELEMENTWISE_HPP
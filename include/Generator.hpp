@@ -5,6 +5,12 @@
  * @version 0.1
  * @date 29-03-2024
  *
+ * Random matrices are produced by a counter-based generator (Philox4x32-10,
+ * Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC'11).
+ * Item (i, j) of a matrix generated with seed s is a pure function of
+ * (s, i, j), so any tile can be generated on its own, rows can be filled by
+ * any number of threads, and the result is reproducible everywhere.
+ *
  * @copyright Copyright (c) 2024
  *
  */
@@ -12,58 +18,258 @@
 #ifndef GENERATOR_HPP
 #define GENERATOR_HPP
 
+#include <cstdint>
 #include <random>
 
 #include "Matrixv2.hpp"
+#include "Parallel.hpp"
 
 namespace MatMulImpl {
+/**
+ * @brief The Philox4x32-10 block function.
+ * Lanes are processed in struct-of-arrays form so that the rounds
+ * vectorize across lanes.
+ */
+class Philox4x32 {
+   public:
+    static constexpr int lanes = 8;
+    using Block = std::uint32_t[4][lanes];
+
+    /**
+     * @brief Encrypts the counters {c0[l], c1, c2, 0} under the key.
+     * @param c0 Per-lane first counter word
+     * @param c1 Second counter word, shared by all lanes
+     * @param c2 Third counter word, shared by all lanes
+     * @param key 64-bit key (the seed)
+     * @param out out[w][l] is word w of lane l
+     */
+    static void generate(const std::uint32_t (&c0)[lanes], std::uint32_t c1,
+                         std::uint32_t c2, std::uint64_t key, Block &out) {
+        std::uint32_t x0[lanes], x1[lanes], x2[lanes], x3[lanes];
+        for (int l = 0; l < lanes; l++) {
+            x0[l] = c0[l], x1[l] = c1, x2[l] = c2, x3[l] = 0;
+        }
+        std::uint32_t k0 = static_cast<std::uint32_t>(key);
+        std::uint32_t k1 = static_cast<std::uint32_t>(key >> 32);
+        for (int r = 0; r < 10; r++) {
+            for (int l = 0; l < lanes; l++) {
+                std::uint64_t p0 = std::uint64_t(m0) * x0[l];
+                std::uint64_t p1 = std::uint64_t(m1) * x2[l];
+                std::uint32_t y0 = static_cast<std::uint32_t>(p1 >> 32) ^
+                                   x1[l] ^ k0;
+                std::uint32_t y1 = static_cast<std::uint32_t>(p1);
+                std::uint32_t y2 = static_cast<std::uint32_t>(p0 >> 32) ^
+                                   x3[l] ^ k1;
+                std::uint32_t y3 = static_cast<std::uint32_t>(p0);
+                x0[l] = y0, x1[l] = y1, x2[l] = y2, x3[l] = y3;
+            }
+            k0 += w0, k1 += w1;
+        }
+        for (int l = 0; l < lanes; l++) {
+            out[0][l] = x0[l], out[1][l] = x1[l];
+            out[2][l] = x2[l], out[3][l] = x3[l];
+        }
+    }
+
+   private:
+    static constexpr std::uint32_t m0 = 0xD2511F53, m1 = 0xCD9E8D57;
+    static constexpr std::uint32_t w0 = 0x9E3779B9, w1 = 0xBB67AE85;
+};
+
+/**
+ * @brief Fills matrices from Philox output through a mapping of raw words
+ * to items.
+ */
+class CounterFill {
+   public:
+    /**
+     * @brief Fills tile as the block at (row0, col0) of the matrix with
+     * the given seed.
+     * @tparam T Type of element of matrix
+     * @tparam Map Has `static constexpr int words` (1 to 4 words consumed
+     * per item) and `T operator()(const std::uint32_t *w) const`
+     * @param tile Matrix or view to fill
+     * @param seed Seed of the whole matrix
+     * @param row0 Row of the tile within the whole matrix
+     * @param col0 Column of the tile within the whole matrix
+     * @param map Word-to-item mapping
+     * @param threads Number of threads; small tiles use one
+     */
+    template <class T, class Map>
+    static void fill(Matrix2<T> &tile, std::uint64_t seed, int row0,
+                     int col0, const Map &map,
+                     int threads = default_thread_count()) {
+        constexpr int per_block = 4 / Map::words;  // items per Philox block
+        constexpr int span = per_block * Philox4x32::lanes;
+        if ((long long)tile.m * tile.n < parallel_threshold) threads = 1;
+        tile.unshare();  // Before the threads write to it
+        parallel_for_rows(tile.m, threads, [&](int i0, int i1, int) {
+            Philox4x32::Block out;
+            std::uint32_t ctr[Philox4x32::lanes];
+            std::uint32_t words[4];
+            for (int i = i0; i < i1; i++) {
+                T *row = &tile.item(i, 0);
+                const int gi = row0 + i;
+                // Blocks are aligned to global columns, so a tile starting
+                // mid-block skips the leading items of its first block.
+                int g = col0 - col0 % span;
+                for (; g < col0 + tile.n; g += span) {
+                    for (int l = 0; l < Philox4x32::lanes; l++)
+                        ctr[l] = static_cast<std::uint32_t>(g / per_block + l);
+                    Philox4x32::generate(ctr, static_cast<std::uint32_t>(gi),
+                                         stream, seed, out);
+                    int lo = std::max(g, col0);
+                    int hi = std::min(g + span, col0 + tile.n);
+                    for (int gj = lo; gj < hi; gj++) {
+                        int e = gj - g;
+                        int lane = e / per_block;
+                        int w = (e % per_block) * Map::words;
+                        for (int q = 0; q < Map::words; q++)
+                            words[q] = out[w + q][lane];
+                        row[gj - col0] = map(words);
+                    }
+                }
+            }
+        });
+    }
+
+    /**
+     * @brief A fresh non-deterministic seed, for callers that do not care
+     * about reproducibility.
+     */
+    static std::uint64_t fresh_seed() {
+        std::random_device rdev;
+        return (std::uint64_t(rdev()) << 32) ^ rdev();
+    }
+
+   private:
+    static constexpr std::uint32_t stream = 0x4D415432;  // "MAT2"
+    static constexpr long long parallel_threshold = 1LL << 16;
+};
+
+/**
+ * @brief Raw 32-bit words, converted to T.
+ */
+template <class T>
+struct RawWordMap {
+    static constexpr int words = 1;
+    T operator()(const std::uint32_t *w) const { return T(w[0]); }
+};
+
+/**
+ * @brief Uniform integers in [lo, hi]. Uses Lemire's multiply-shift
+ * reduction without rejection; the bias is below range / 2^32.
+ */
+struct UniformIntMap {
+    static constexpr int words = 1;
+    int lo;
+    std::uint64_t range;
+    UniformIntMap(int lo, int hi)
+        : lo(lo), range(std::uint64_t(std::int64_t(hi) - lo) + 1) {}
+    int operator()(const std::uint32_t *w) const {
+        return static_cast<int>(lo + std::int64_t((w[0] * range) >> 32));
+    }
+};
+
+/**
+ * @brief Uniform doubles in [0, 1) with 53 random bits.
+ */
+struct UniformRealMap {
+    static constexpr int words = 2;
+    double operator()(const std::uint32_t *w) const {
+        std::uint64_t bits = (std::uint64_t(w[0]) << 21) ^ (w[1] >> 11);
+        return double(bits & ((std::uint64_t(1) << 53) - 1)) * 0x1.0p-53;
+    }
+};
+
+/**
+ * @brief Uniform floats in [0, 1) with 24 random bits.
+ */
+struct UniformFloatMap {
+    static constexpr int words = 1;
+    float operator()(const std::uint32_t *w) const {
+        return float(w[0] >> 8) * 0x1.0p-24f;
+    }
+};
+
 template <class T>
 class MatrixGenerator {
    public:
     static Matrix2<T> random_fill(int m, int n) {
-        std::random_device rdev;
+        return random_fill_seeded(m, n, CounterFill::fresh_seed());
+    }
+    /**
+     * @brief Reproducible random matrix; item (i, j) depends only on
+     * (seed, i, j).
+     */
+    static Matrix2<T> random_fill_seeded(int m, int n, std::uint64_t seed) {
         Matrix2<T> mat(m, n);
-        for (int i = 0; i < m; i++) {
-            for (int j = 0; j < n; j++) {
-                mat.item(i, j) = rdev();
-            }
-        }
+        CounterFill::fill(mat, seed, 0, 0, RawWordMap<T>());
         return mat;
     }
+    /**
+     * @brief Fills tile with block (row0, col0) of the matrix that
+     * random_fill_seeded(..., seed) would produce.
+     */
+    static void fill_tile(Matrix2<T> &tile, std::uint64_t seed, int row0,
+                          int col0) {
+        CounterFill::fill(tile, seed, row0, col0, RawWordMap<T>());
+    }
 };
 template <>
 class MatrixGenerator<int> {
    public:
     static Matrix2<int> random_fill(int m, int n, int minX = -10,
                                     int maxX = 10) {
-        std::uniform_int_distribution<> irdist(minX, maxX);
-        std::random_device rdev;
-        std::mt19937 gen(rdev());
+        return random_fill_seeded(m, n, CounterFill::fresh_seed(), minX,
+                                  maxX);
+    }
+    static Matrix2<int> random_fill_seeded(int m, int n, std::uint64_t seed,
+                                           int minX = -10, int maxX = 10) {
         Matrix2<int> mat(m, n);
-        for (int i = 0; i < m; i++) {
-            for (int j = 0; j < n; j++) {
-                mat.item(i, j) = irdist(gen);
-            }
-        }
+        CounterFill::fill(mat, seed, 0, 0, UniformIntMap(minX, maxX));
         return mat;
     }
+    static void fill_tile(Matrix2<int> &tile, std::uint64_t seed, int row0,
+                          int col0, int minX = -10, int maxX = 10) {
+        CounterFill::fill(tile, seed, row0, col0, UniformIntMap(minX, maxX));
+    }
 };
 
 template <>
 class MatrixGenerator<double> {
    public:
     static Matrix2<double> random_fill(int m, int n) {
-        std::uniform_real_distribution<> rrdist;
-        std::random_device rdev;
-        std::mt19937 gen(rdev());
+        return random_fill_seeded(m, n, CounterFill::fresh_seed());
+    }
+    static Matrix2<double> random_fill_seeded(int m, int n,
+                                              std::uint64_t seed) {
         Matrix2<double> mat(m, n);
-        for (int i = 0; i < m; i++) {
-            for (int j = 0; j < n; j++) {
-                mat.item(i, j) = rrdist(gen);
-            }
-        }
+        CounterFill::fill(mat, seed, 0, 0, UniformRealMap());
+        return mat;
+    }
+    static void fill_tile(Matrix2<double> &tile, std::uint64_t seed,
+                          int row0, int col0) {
+        CounterFill::fill(tile, seed, row0, col0, UniformRealMap());
+    }
+};
+
+template <>
+class MatrixGenerator<float> {
+   public:
+    static Matrix2<float> random_fill(int m, int n) {
+        return random_fill_seeded(m, n, CounterFill::fresh_seed());
+    }
+    static Matrix2<float> random_fill_seeded(int m, int n,
+                                             std::uint64_t seed) {
+        Matrix2<float> mat(m, n);
+        CounterFill::fill(mat, seed, 0, 0, UniformFloatMap());
         return mat;
     }
+    static void fill_tile(Matrix2<float> &tile, std::uint64_t seed, int row0,
+                          int col0) {
+        CounterFill::fill(tile, seed, row0, col0, UniformFloatMap());
+    }
 };
 }  // namespace MatMulImpl
 
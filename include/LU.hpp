@@ -0,0 +1,340 @@
+/**
+ * @file LU.hpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief Blocked LU factorization with partial pivoting, and what builds on
+ * it: linear solves, determinant and inverse.
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * The factorization is right-looking and runs on a TaskGraph over square
+ * tiles of nb x nb items. At step k:
+ * - "panel" factors the k-th block column with partial pivoting,
+ * - "swap_trsm" applies the row swaps of the panel to one block column
+ *   to its right, and solves for its tile of U,
+ * - "update" subtracts L(i, k) U(k, j) from one trailing tile with the
+ *   multiply kernel.
+ * Almost all of the work is in the updates, which run in parallel. Since
+ * the panel of step k + 1 waits only for the updates of its own column, it
+ * overlaps the rest of step k.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef LU_HPP
+#define LU_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Algorithms.hpp"
+#include "Matrixv2.hpp"
+#include "TaskGraph.hpp"
+
+namespace MatMulImpl {
+class SingularMatrixException : std::exception {
+   public:
+    SingularMatrixException(const std::string& s);
+    const char* what();
+
+   private:
+    std::string explain;
+};
+inline SingularMatrixException::SingularMatrixException(const std::string& s)
+    : explain(s) {}
+inline const char* SingularMatrixException::what() { return explain.c_str(); }
+
+/**
+ * @brief PA = LU of a square matrix A, where P is a permutation, L is unit
+ * lower triangular and U is upper triangular.
+ * @tparam T float or double
+ */
+template <class T>
+class LU {
+    static_assert(std::is_floating_point<T>::value,
+                  "LU needs a floating point element type");
+
+   public:
+    /**
+     * @brief Factors a. A singular matrix is factored all the same (see
+     * singular()); only solve() and inverse() refuse it.
+     * @param a Square matrix to factor; it is copied
+     * @param block Side of the tiles
+     * @param threads Number of workers
+     * @param strassen Multiply full tiles in the trailing update with
+     * Strassen's algorithm. Only pays for large blocks (512 or more), and
+     * only applies when the block is a power of 2.
+     */
+    explicit LU(const Matrix2<T>& a, int block = 64,
+                int threads = default_thread_count(), bool strassen = false)
+        : n(a.m), nb(std::max(1, std::min(block, std::max(1, a.m)))),
+          lu(a.m, a.m), piv(a.m) {
+        if (a.m != a.n) {
+            std::stringstream ss;
+            ss << "LU: cannot factor a " << a.m << "x" << a.n << " matrix";
+            throw BadDimensionException(ss.str().c_str());
+        }
+        MTP_MEMORY_TAG("lu");
+        for (int i = 0; i < n; i++)
+            std::copy_n(&a.citem(i, 0), n, &lu.item(i, 0));
+        factor(threads, strassen && isP2(nb));
+    }
+
+    /**
+     * @brief True if U has a zero on its diagonal, i.e. A is singular.
+     */
+    bool singular() const { return first_zero >= 0; }
+
+    T determinant() const {
+        T det = T(1);
+        for (int i = 0; i < n; i++) {
+            det *= lu.citem(i, i);
+            if (piv[i] != i) det = -det;
+        }
+        return det;
+    }
+
+    /**
+     * @brief Solves AX = B.
+     * @param b Right-hand sides (n x r)
+     * @param threads Number of threads of the multiply kernel
+     * @return Matrix2<T> X (n x r)
+     * @throw SingularMatrixException if A is singular
+     */
+    Matrix2<T> solve(const Matrix2<T>& b,
+                     int threads = default_thread_count()) const {
+        if (b.m != n) {
+            std::stringstream ss;
+            ss << "LU::solve: cannot solve a " << n << "x" << n
+               << " system for a " << b.m << "x" << b.n << " matrix";
+            throw BadDimensionException(ss.str().c_str());
+        }
+        Matrix2<T> x(b.m, b.n);
+        for (int i = 0; i < n; i++)
+            std::copy_n(&b.citem(i, 0), b.n, &x.item(i, 0));
+        solve_in_place(x, threads);
+        return x;
+    }
+
+    /**
+     * @brief The inverse of A, solving AX = I.
+     * @throw SingularMatrixException if A is singular
+     */
+    Matrix2<T> inverse(int threads = default_thread_count()) const {
+        Matrix2<T> x(n, n);
+        for (int i = 0; i < n; i++) {
+            std::fill_n(&x.item(i, 0), n, T(0));
+            x.item(i, i) = T(1);
+        }
+        solve_in_place(x, threads);
+        return x;
+    }
+
+    /**
+     * @brief L below the diagonal (its unit diagonal is not stored) and U
+     * on and above it.
+     */
+    const Matrix2<T>& factors() const { return lu; }
+    /**
+     * @brief Row i of A was swapped with row pivots()[i] >= i, in order of
+     * increasing i.
+     */
+    const std::vector<int>& pivots() const { return piv; }
+
+    const int n;
+
+   private:
+    const int nb;
+    Matrix2<T> lu;
+    std::vector<int> piv;
+    int first_zero = -1;  // First column without a nonzero pivot
+
+    // Tile (i, j) is named by its first item
+    TaskGraph::Tile tile(int i, int j) const {
+        return &lu.citem(i * nb, j * nb);
+    }
+
+    void factor(int threads, bool strassen) {
+        const int nt = (n + nb - 1) / nb;
+        // -U(k, j) of the current step k, for every block column j
+        std::deque<Matrix2<T>> neg_u;
+        for (int j = 0; j < nt; j++)
+            neg_u.emplace_back(nb, std::min(nb, n - j * nb));
+        TaskGraph graph;
+        for (int k = 0; k < nt; k++) {
+            const int k0 = k * nb, k1 = std::min(n, k0 + nb);
+            std::vector<TaskGraph::Tile> column;
+            for (int i = k; i < nt; i++) column.push_back(tile(i, k));
+            graph.add("panel", {}, column, [this, k0, k1] {
+                factor_panel(k0, k1);
+            });
+            for (int j = k + 1; j < nt; j++) {
+                const int j0 = j * nb, j1 = std::min(n, j0 + nb);
+                std::vector<TaskGraph::Tile> writes{&neg_u[j]};
+                for (int i = k; i < nt; i++) writes.push_back(tile(i, j));
+                Matrix2<T>* nu = &neg_u[j];
+                graph.add("swap_trsm", column, writes,
+                          [this, k0, k1, j0, j1, nu] {
+                              swap_trsm(k0, k1, j0, j1, *nu);
+                          });
+            }
+            for (int j = k + 1; j < nt; j++) {
+                const int j0 = j * nb, j1 = std::min(n, j0 + nb);
+                Matrix2<T>* nu = &neg_u[j];
+                for (int i = k + 1; i < nt; i++) {
+                    const int i0 = i * nb, i1 = std::min(n, i0 + nb);
+                    graph.add(
+                        "update", {tile(i, k), &neg_u[j]}, {tile(i, j)},
+                        [this, i0, i1, j0, j1, k0, k1, nu, strassen] {
+                            update(i0, i1, j0, j1, k0, k1, *nu, strassen);
+                        });
+                }
+            }
+        }
+        graph.run(threads);
+        // The swaps of each panel still have to reach the columns of L to
+        // its left
+        for (int k0 = nb; k0 < n; k0 += nb) {
+            for (int c = k0; c < std::min(n, k0 + nb); c++) {
+                if (piv[c] != c)
+                    std::swap_ranges(&lu.item(c, 0), &lu.item(c, 0) + k0,
+                                     &lu.item(piv[c], 0));
+            }
+        }
+    }
+
+    // Unblocked LU with partial pivoting of columns [k0, k1), rows k0 on
+    void factor_panel(int k0, int k1) {
+        for (int c = k0; c < k1; c++) {
+            int p = c;
+            T best = std::abs(lu.citem(c, c));
+            for (int r = c + 1; r < n; r++) {
+                T v = std::abs(lu.citem(r, c));
+                if (v > best) {
+                    best = v;
+                    p = r;
+                }
+            }
+            piv[c] = p;
+            if (p != c)
+                std::swap_ranges(&lu.item(c, k0), &lu.item(c, k0) + (k1 - k0),
+                                 &lu.item(p, k0));
+            if (best == T(0)) {
+                if (first_zero < 0) first_zero = c;
+                continue;
+            }
+            const T inv = T(1) / lu.citem(c, c);
+            const T* u_row = &lu.citem(c, c);
+            for (int r = c + 1; r < n; r++) {
+                T* row = &lu.item(r, c);
+                const T l = row[0] *= inv;
+                for (int j = 1; j < k1 - c; j++) row[j] -= l * u_row[j];
+            }
+        }
+    }
+
+    // Applies the swaps of panel [k0, k1) to columns [j0, j1), solves
+    // L(k, k) U(k, j) = A(k, j), and stores -U(k, j) in neg_u
+    void swap_trsm(int k0, int k1, int j0, int j1, Matrix2<T>& neg_u) {
+        const int w = j1 - j0;
+        for (int c = k0; c < k1; c++) {
+            if (piv[c] != c)
+                std::swap_ranges(&lu.item(c, j0), &lu.item(c, j0) + w,
+                                 &lu.item(piv[c], j0));
+        }
+        for (int r = k0; r < k1; r++) {
+            T* x = &lu.item(r, j0);
+            for (int c = k0; c < r; c++) {
+                const T l = lu.citem(r, c);
+                const T* y = &lu.citem(c, j0);
+                for (int j = 0; j < w; j++) x[j] -= l * y[j];
+            }
+            T* nu = &neg_u.item(r - k0, 0);
+            for (int j = 0; j < w; j++) nu[j] = -x[j];
+        }
+    }
+
+    // A(i, j) -= L(i, k) U(k, j)
+    void update(int i0, int i1, int j0, int j1, int k0, int k1,
+                Matrix2<T>& neg_u, bool strassen) {
+        const int h = i1 - i0, w = j1 - j0, kb = k1 - k0;
+        Matrix2<T> c = lu.sub(i0, j0, h, w);
+        const Matrix2<T> u = neg_u.csub(0, 0, kb, w);
+        if (strassen && h == nb && w == nb && kb == nb) {
+            Matrix2<T> p =
+                Multiplication::strassen_dag(lu.csub(i0, k0, h, kb), u, 1);
+            c.sum_from(c, p);
+        } else {
+            Multiplication::multiply_add(lu.csub(i0, k0, h, kb), u, c);
+        }
+    }
+
+    // Overwrites B with A^-1 B, one block row at a time, so that most of
+    // the work is in the multiply kernel
+    void solve_in_place(Matrix2<T>& x, int threads) const {
+        if (singular()) {
+            std::stringstream ss;
+            ss << "LU::solve: the matrix is singular (no pivot in column "
+               << first_zero << ")";
+            throw SingularMatrixException(ss.str());
+        }
+        const int r = x.n;
+        if (r == 0) return;
+        for (int i = 0; i < n; i++) {
+            if (piv[i] != i)
+                std::swap_ranges(&x.item(i, 0), &x.item(i, 0) + r,
+                                 &x.item(piv[i], 0));
+        }
+        Matrix2<T> neg(nb, r);
+        // Forward substitution with L
+        for (int k0 = 0; k0 < n; k0 += nb) {
+            const int k1 = std::min(n, k0 + nb);
+            for (int i = k0; i < k1; i++) {
+                T* xi = &x.item(i, 0);
+                for (int c = k0; c < i; c++) {
+                    const T l = lu.citem(i, c);
+                    const T* xc = &x.citem(c, 0);
+                    for (int j = 0; j < r; j++) xi[j] -= l * xc[j];
+                }
+                T* ni = &neg.item(i - k0, 0);
+                for (int j = 0; j < r; j++) ni[j] = -xi[j];
+            }
+            if (k1 < n) {
+                Matrix2<T> rest = x.sub(k1, 0, n - k1, r);
+                Multiplication::multiply_add(lu.csub(k1, k0, n - k1, k1 - k0),
+                                             neg.csub(0, 0, k1 - k0, r), rest,
+                                             threads);
+            }
+        }
+        // Back substitution with U
+        for (int k1 = n; k1 > 0; k1 -= nb) {
+            const int k0 = std::max(0, k1 - nb);
+            for (int i = k1 - 1; i >= k0; i--) {
+                T* xi = &x.item(i, 0);
+                for (int c = i + 1; c < k1; c++) {
+                    const T u = lu.citem(i, c);
+                    const T* xc = &x.citem(c, 0);
+                    for (int j = 0; j < r; j++) xi[j] -= u * xc[j];
+                }
+                const T inv = T(1) / lu.citem(i, i);
+                T* ni = &neg.item(i - k0, 0);
+                for (int j = 0; j < r; j++) ni[j] = -(xi[j] *= inv);
+            }
+            if (k0 > 0) {
+                Matrix2<T> rest = x.sub(0, 0, k0, r);
+                Multiplication::multiply_add(lu.csub(0, k0, k0, k1 - k0),
+                                             neg.csub(0, 0, k1 - k0, r), rest,
+                                             threads);
+            }
+        }
+    }
+};
+}  // namespace MatMulImpl
+
+#endif  // LU_HPP
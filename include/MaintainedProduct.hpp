@@ -0,0 +1,260 @@
+/**
+ * @file MaintainedProduct.hpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief C = AB kept up to date as A and B change.
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * A MaintainedProduct owns A, B and C. Updates to A or B are recorded
+ * rather than applied to C:
+ * - setting a row of A or a column of B marks that row or column of C
+ *   dirty, to be recomputed;
+ * - any other change is a low-rank correction C += XY, of rank 1 for a
+ *   column of A or a row of B and of rank r for A += UV^T or B += UV^T.
+ *   X and Y are formed when the update is made, against the A and B of
+ *   that moment, which is what makes the corrections additive.
+ * Reading C applies everything at once: the corrections are stacked into
+ * one product of inner size equal to their total rank, then the dirty rows
+ * and columns are recomputed. When that would cost as much as AB itself,
+ * C is recomputed instead.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef MAINTAINED_PRODUCT_HPP
+#define MAINTAINED_PRODUCT_HPP
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+#include "Algorithms.hpp"
+#include "Matrixv2.hpp"
+
+namespace MatMulImpl {
+template <class T>
+class MaintainedProduct {
+   public:
+    /**
+     * @param a Left operand (m x k); it is copied
+     * @param b Right operand (k x n); it is copied
+     * @param threads Number of threads of the multiply kernel
+     */
+    MaintainedProduct(const Matrix2<T> &a, const Matrix2<T> &b,
+                      int threads = default_thread_count())
+        : a_(a.m, a.n), b_(b.m, b.n), c_(a.m, b.n), threads(threads),
+          row_dirty(a.m, 0), col_dirty(b.n, 0) {
+        if (a.n != b.m) {
+            std::stringstream ss;
+            ss << "MaintainedProduct: cannot multiply a " << a.m << "x"
+               << a.n << " by a " << b.m << "x" << b.n << " matrix";
+            throw BadDimensionException(ss.str().c_str());
+        }
+        copy(a, a_);
+        copy(b, b_);
+        recompute();
+    }
+    MaintainedProduct(const MaintainedProduct &) = delete;
+    MaintainedProduct &operator=(const MaintainedProduct &) = delete;
+
+    /**
+     * @brief Replaces row i of A with row (1 x k).
+     */
+    void set_a_row(int i, const Matrix2<T> &row) {
+        check(row, 1, a_.n, "set_a_row");
+        std::copy_n(&row.citem(0, 0), a_.n, &a_.item(i, 0));
+        mark(row_dirty, dirty_rows, i);
+    }
+    /**
+     * @brief Replaces column j of B with col (k x 1).
+     */
+    void set_b_col(int j, const Matrix2<T> &col) {
+        check(col, b_.m, 1, "set_b_col");
+        for (int i = 0; i < b_.m; i++) b_.item(i, j) = col.citem(i, 0);
+        mark(col_dirty, dirty_cols, j);
+    }
+    /**
+     * @brief Replaces column j of A with col (m x 1): a rank-1 correction
+     * (col - A(:, j)) B(j, :).
+     */
+    void set_a_col(int j, const Matrix2<T> &col) {
+        check(col, a_.m, 1, "set_a_col");
+        Matrix2<T> x(a_.m, 1), y(1, b_.n);
+        for (int i = 0; i < a_.m; i++) {
+            x.item(i, 0) = col.citem(i, 0) - a_.citem(i, j);
+            a_.item(i, j) = col.citem(i, 0);
+        }
+        std::copy_n(&b_.citem(j, 0), b_.n, &y.item(0, 0));
+        defer(std::move(x), std::move(y));
+    }
+    /**
+     * @brief Replaces row i of B with row (1 x n): a rank-1 correction
+     * A(:, i) (row - B(i, :)).
+     */
+    void set_b_row(int i, const Matrix2<T> &row) {
+        check(row, 1, b_.n, "set_b_row");
+        Matrix2<T> x(a_.m, 1), y(1, b_.n);
+        for (int r = 0; r < a_.m; r++) x.item(r, 0) = a_.citem(r, i);
+        for (int j = 0; j < b_.n; j++) {
+            y.item(0, j) = row.citem(0, j) - b_.citem(i, j);
+            b_.item(i, j) = row.citem(0, j);
+        }
+        defer(std::move(x), std::move(y));
+    }
+    /**
+     * @brief A += UV^T: the correction U (V^T B), costing O(rkn) now.
+     * @param u m x r
+     * @param v k x r
+     */
+    void update_a(const Matrix2<T> &u, const Matrix2<T> &v) {
+        check(u, a_.m, u.n, "update_a");
+        check(v, a_.n, u.n, "update_a");
+        const int r = u.n;
+        add_outer(a_, u, v);
+        Matrix2<T> x(a_.m, r), y(r, b_.n);
+        copy(u, x);
+        Multiplication::multiply_add(transposed(v), b_, zero(y), threads);
+        defer(std::move(x), std::move(y));
+    }
+    /**
+     * @brief B += UV^T: the correction (AU) V^T, costing O(mkr) now.
+     * @param u k x r
+     * @param v n x r
+     */
+    void update_b(const Matrix2<T> &u, const Matrix2<T> &v) {
+        check(u, b_.m, u.n, "update_b");
+        check(v, b_.n, u.n, "update_b");
+        const int r = u.n;
+        // AU against the A of this moment; B's own change does not enter
+        Matrix2<T> x(a_.m, r);
+        Multiplication::multiply_add(a_, u, zero(x), threads);
+        add_outer(b_, u, v);
+        defer(std::move(x), transposed(v));
+    }
+
+    /**
+     * @brief C, after applying every pending update.
+     */
+    const Matrix2<T> &c() {
+        flush();
+        return c_;
+    }
+    const Matrix2<T> &a() const { return a_; }
+    const Matrix2<T> &b() const { return b_; }
+    /**
+     * @brief Total rank of the corrections not yet applied to C.
+     */
+    int pending_rank() const { return rank; }
+
+   private:
+    Matrix2<T> a_, b_, c_;
+    int threads;
+    std::vector<char> row_dirty, col_dirty;
+    std::vector<int> dirty_rows, dirty_cols;
+    std::vector<Matrix2<T>> xs, ys;  // Pending C += xs[t] ys[t]
+    int rank = 0;
+
+    static void check(const Matrix2<T> &x, int m, int n, const char *who) {
+        if (x.m != m || x.n != n) {
+            std::stringstream ss;
+            ss << "MaintainedProduct::" << who << ": expected a " << m << "x"
+               << n << " matrix, got " << x.m << "x" << x.n;
+            throw BadDimensionException(ss.str().c_str());
+        }
+    }
+    static void copy(const Matrix2<T> &from, Matrix2<T> &to) {
+        for (int i = 0; i < from.m; i++)
+            std::copy_n(&from.citem(i, 0), from.n, &to.item(i, 0));
+    }
+    static Matrix2<T> &zero(Matrix2<T> &x) {
+        for (int i = 0; i < x.m; i++) std::fill_n(&x.item(i, 0), x.n, T(0));
+        return x;
+    }
+    static Matrix2<T> transposed(const Matrix2<T> &x) {
+        Matrix2<T> t(x.n, x.m);
+        for (int i = 0; i < x.m; i++) {
+            for (int j = 0; j < x.n; j++) t.item(j, i) = x.citem(i, j);
+        }
+        return t;
+    }
+    // x += u v^T
+    void add_outer(Matrix2<T> &x, const Matrix2<T> &u, const Matrix2<T> &v) {
+        Multiplication::multiply_add(u, transposed(v), x, threads);
+    }
+    static void mark(std::vector<char> &flags, std::vector<int> &list, int i) {
+        if (!flags[i]) {
+            flags[i] = 1;
+            list.push_back(i);
+        }
+    }
+    void defer(Matrix2<T> &&x, Matrix2<T> &&y) {
+        rank += x.n;
+        xs.push_back(std::move(x));
+        ys.push_back(std::move(y));
+    }
+
+    void recompute() {
+        Multiplication::multiply_add(a_, b_, zero(c_), threads);
+    }
+
+    void flush() {
+        if (rank == 0 && dirty_rows.empty() && dirty_cols.empty()) return;
+        const long long m = a_.m, k = a_.n, n = b_.n;
+        const long long cost = m * n * rank + (long long)dirty_rows.size() *
+                                                  k * n +
+                               m * k * (long long)dirty_cols.size();
+        if (cost >= m * k * n) {
+            recompute();
+        } else {
+            if (rank > 0) {
+                // One product for all corrections
+                Matrix2<T> x(a_.m, rank), y(rank, b_.n);
+                for (std::size_t t = 0, r0 = 0; t < xs.size(); t++) {
+                    const int r = xs[t].n;
+                    for (int i = 0; i < a_.m; i++)
+                        std::copy_n(&xs[t].citem(i, 0), r, &x.item(i, r0));
+                    for (int q = 0; q < r; q++)
+                        std::copy_n(&ys[t].citem(q, 0), b_.n,
+                                    &y.item(r0 + q, 0));
+                    r0 += r;
+                }
+                Multiplication::multiply_add(x, y, c_, threads);
+            }
+            if (!dirty_rows.empty()) {
+                const int d = static_cast<int>(dirty_rows.size());
+                Matrix2<T> rows(d, a_.n), out(d, b_.n);
+                for (int t = 0; t < d; t++)
+                    std::copy_n(&a_.citem(dirty_rows[t], 0), a_.n,
+                                &rows.item(t, 0));
+                Multiplication::multiply_add(rows, b_, zero(out), threads);
+                for (int t = 0; t < d; t++)
+                    std::copy_n(&out.citem(t, 0), b_.n,
+                                &c_.item(dirty_rows[t], 0));
+            }
+            if (!dirty_cols.empty()) {
+                const int d = static_cast<int>(dirty_cols.size());
+                Matrix2<T> cols(b_.m, d), out(a_.m, d);
+                for (int i = 0; i < b_.m; i++) {
+                    for (int t = 0; t < d; t++)
+                        cols.item(i, t) = b_.citem(i, dirty_cols[t]);
+                }
+                Multiplication::multiply_add(a_, cols, zero(out), threads);
+                for (int i = 0; i < a_.m; i++) {
+                    for (int t = 0; t < d; t++)
+                        c_.item(i, dirty_cols[t]) = out.citem(i, t);
+                }
+            }
+        }
+        xs.clear();
+        ys.clear();
+        rank = 0;
+        for (int i : dirty_rows) row_dirty[i] = 0;
+        for (int j : dirty_cols) col_dirty[j] = 0;
+        dirty_rows.clear();
+        dirty_cols.clear();
+    }
+};
+}  // namespace MatMulImpl
+
+#endif  // MAINTAINED_PRODUCT_HPP
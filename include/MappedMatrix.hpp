@@ -0,0 +1,221 @@
+/**
+ * @file MappedMatrix.hpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief A row-major matrix that lives in a memory-mapped file.
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * Unlike Matrix2, the dimensions and offsets are 64-bit, so the matrix can
+ * be far larger than both the heap and the 2^31 item limit of an int. The
+ * data is paged in by the kernel on demand; tile() hands out Matrix2 views
+ * of any block that fits in an int-sized Matrix2.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef MAPPEDMATRIX_HPP
+#define MAPPEDMATRIX_HPP
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "Matrixv2.hpp"
+
+namespace MatMulImpl {
+template <class T>
+class MappedMatrix {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "MappedMatrix stores raw bytes; T must be trivially "
+                  "copyable");
+
+   public:
+    MappedMatrix() = delete;
+    MappedMatrix(const MappedMatrix<T>&) = delete;
+    MappedMatrix(MappedMatrix<T>&& o) noexcept
+        : base(std::exchange(o.base, nullptr)),
+          map_len(std::exchange(o.map_len, 0)),
+          data(std::exchange(o.data, nullptr)),
+          n_rows(o.n_rows),
+          n_cols(o.n_cols) {}
+    ~MappedMatrix() {
+        if (base) munmap(base, map_len);
+    }
+
+    /**
+     * @brief Creates (or truncates) a file holding a zero rows x cols matrix
+     * and maps it for reading and writing.
+     * @param path File to create
+     * @param rows Number of rows
+     * @param cols Number of columns
+     * @param offset Bytes before the first item, e.g. for a header. Must be
+     * a multiple of alignof(T).
+     */
+    static MappedMatrix<T> create(const std::string& path, std::int64_t rows,
+                                  std::int64_t cols, std::size_t offset = 0) {
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) fail("cannot create", path);
+        std::size_t len = offset + bytes_for(rows, cols);
+        if (ftruncate(fd, static_cast<off_t>(len)) != 0) {
+            ::close(fd);
+            fail("cannot resize", path);
+        }
+        return MappedMatrix<T>(fd, path, len, offset, rows, cols, true);
+    }
+
+    /**
+     * @brief Maps an existing file holding a rows x cols matrix.
+     * @param path File to open
+     * @param rows Number of rows
+     * @param cols Number of columns
+     * @param offset Bytes before the first item
+     * @param writable Map for writing as well; writes go back to the file
+     */
+    static MappedMatrix<T> open(const std::string& path, std::int64_t rows,
+                                std::int64_t cols, std::size_t offset = 0,
+                                bool writable = false) {
+        int fd = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+        if (fd < 0) fail("cannot open", path);
+        struct stat st;
+        std::size_t len = offset + bytes_for(rows, cols);
+        if (fstat(fd, &st) != 0 ||
+            static_cast<std::size_t>(st.st_size) < len) {
+            ::close(fd);
+            throw MatrixIOException(path + ": file is smaller than a " +
+                                    std::to_string(rows) + "x" +
+                                    std::to_string(cols) + " matrix");
+        }
+        return MappedMatrix<T>(fd, path, len, offset, rows, cols, writable);
+    }
+
+    std::int64_t rows() const { return n_rows; }
+    std::int64_t cols() const { return n_cols; }
+    T* row(std::int64_t i) { return data + i * n_cols; }
+    const T* row(std::int64_t i) const { return data + i * n_cols; }
+
+    /**
+     * @brief A zero-copy view of the m x n block starting at (i, j).
+     * Pages are faulted in as the view is read.
+     */
+    Matrix2<T> tile(std::int64_t i, std::int64_t j, int m, int n) {
+        return Matrix2<T>::view_of(row(i) + j, m, n, stride());
+    }
+    const Matrix2<T> ctile(std::int64_t i, std::int64_t j, int m,
+                           int n) const {
+        return Matrix2<T>::view_of(const_cast<T*>(row(i) + j), m, n,
+                                   stride());
+    }
+    /**
+     * @brief A zero-copy view of the whole matrix.
+     * @throw BadDimensionException if it does not fit an int-sized Matrix2
+     */
+    Matrix2<T> view() {
+        if (n_rows > INT32_MAX)
+            throw BadDimensionException(
+                "MappedMatrix: too many rows to view as a Matrix2");
+        return tile(0, 0, static_cast<int>(n_rows), stride());
+    }
+
+    /**
+     * @brief Asks the kernel to start reading rows [i, i + m) in the
+     * background (MADV_WILLNEED). Returns immediately.
+     */
+    void prefetch(std::int64_t i, std::int64_t m) const {
+        advise(i, m, 0, n_cols, MADV_WILLNEED);
+    }
+    /**
+     * @brief Like prefetch(i, m), but only for columns [j, j + n) of those
+     * rows, so that reading one tile does not pull in the whole row slab.
+     */
+    void prefetch(std::int64_t i, std::int64_t m, std::int64_t j,
+                  std::int64_t n) const {
+        advise(i, m, j, n, MADV_WILLNEED);
+    }
+    /**
+     * @brief Tells the kernel rows [i, i + m) will not be read again soon,
+     * so their clean pages can be dropped first under memory pressure.
+     */
+    void evict(std::int64_t i, std::int64_t m) const {
+        advise(i, m, 0, n_cols, MADV_DONTNEED);
+    }
+    /**
+     * @brief Schedules dirty pages to be written back to the file.
+     * @param wait Block until the write-back finished
+     */
+    void sync(bool wait = false) {
+        if (base) msync(base, map_len, wait ? MS_SYNC : MS_ASYNC);
+    }
+
+   private:
+    void* base;
+    std::size_t map_len;
+    T* data;
+    std::int64_t n_rows, n_cols;
+
+    MappedMatrix(int fd, const std::string& path, std::size_t len,
+                 std::size_t offset, std::int64_t rows, std::int64_t cols,
+                 bool writable)
+        : base(nullptr), map_len(len), data(nullptr), n_rows(rows),
+          n_cols(cols) {
+        if (offset % alignof(T) != 0) {
+            ::close(fd);
+            throw MatrixIOException(path + ": data offset is misaligned");
+        }
+        int prot = PROT_READ | (writable ? PROT_WRITE : 0);
+        void* p = len ? mmap(nullptr, len, prot, MAP_SHARED, fd, 0) : nullptr;
+        ::close(fd);  // the mapping keeps the file referenced
+        if (p == MAP_FAILED) fail("cannot map", path);
+        base = p;
+        data = reinterpret_cast<T*>(static_cast<char*>(p) + offset);
+    }
+    static std::size_t bytes_for(std::int64_t rows, std::int64_t cols) {
+        if (rows < 0 || cols < 0)
+            throw BadDimensionException("MappedMatrix: negative dimension");
+        return static_cast<std::size_t>(rows) * cols * sizeof(T);
+    }
+    int stride() const {
+        if (n_cols > INT32_MAX)
+            throw BadDimensionException(
+                "MappedMatrix: rows too long to view as a Matrix2");
+        return static_cast<int>(n_cols);
+    }
+    // Advises the m x n block at (i, j), one range per row segment.
+    // madvise wants a page-aligned start, so each segment is widened to whole
+    // pages, and segments that then touch or overlap are merged into one
+    // call; whole rows always collapse into a single range.
+    void advise(std::int64_t i, std::int64_t m, std::int64_t j,
+                std::int64_t n, int advice) const {
+        if (!base || m <= 0 || n <= 0) return;
+        auto page = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+        std::uintptr_t lo = 0, hi = 0;
+        for (std::int64_t r = i; r < i + m; r++) {
+            auto s = reinterpret_cast<std::uintptr_t>(row(r) + j);
+            auto e = reinterpret_cast<std::uintptr_t>(row(r) + j + n);
+            s &= ~(page - 1);
+            if (hi != 0 && s <= hi) {
+                hi = e;
+                continue;
+            }
+            if (hi != 0) madvise(reinterpret_cast<void*>(lo), hi - lo, advice);
+            lo = s;
+            hi = e;
+        }
+        madvise(reinterpret_cast<void*>(lo), hi - lo, advice);
+    }
+    [[noreturn]] static void fail(const char* what, const std::string& path) {
+        throw MatrixIOException(path + ": " + what + ": " +
+                                std::strerror(errno));
+    }
+};
+}  // namespace MatMulImpl
+
+#endif  // MAPPEDMATRIX_HPP
@@ -5,32 +5,92 @@
  * @version 0.1
  * @date 28-03-2024
  *
+ * The items are kept in a Matrix2 (see MatrixBase.hpp), so the templates
+ * are defined in the headers like the rest of the library.
+ *
  * @copyright Copyright (c) 2024
  *
  */
 
 #pragma once
 
+#include <algorithm>
 #include <initializer_list>
-#include <memory>
+#include <utility>
 
 #include "MatrixBase.hpp"
+#include "MatrixExceptions.hpp"
+#include "MatrixView.hpp"
 
 namespace MatMulImpl {
 
 template <class T>
 class Matrix : public MatrixBase<T> {
    public:
-    Matrix(int m, int n);
+    /**
+     * @brief Construct an m x n matrix of zeros
+     */
+    Matrix(int m, int n) : MatrixBase<T>(zeros(m, n)) {}
     Matrix(Matrix<T>&& mat) = default;
-    Matrix(std::initializer_list<std::initializer_list<T>> l, int cols);
-    Matrix(std::initializer_list<T> l, int cols);
-    Matrix(std::initializer_list<T> l, int cols, int rows);
-
+    /**
+     * @brief Construct a new Matrix< T>:: Matrix object
+     *
+     * @param l 2d initializer list
+     * @param cols number of columns
+     */
+    Matrix(std::initializer_list<std::initializer_list<T>> l, int cols)
+        : MatrixBase<T>(zeros(static_cast<int>(l.size()), cols)) {
+        for (int i = 0; i < this->_dim.first; i++) {
+            const std::initializer_list<T>& r = l.begin()[i];
+            if (static_cast<int>(r.size()) > cols) {
+                throw TooManyInitializersException();
+            }
+            std::copy(r.begin(), r.end(), this->row(i));
+        }
+    }
+    /**
+     * @brief Construct a new Matrix< T>:: Matrix object
+     *
+     * @param l 1d initializer list
+     * @param cols number of columns
+     */
+    Matrix(std::initializer_list<T> l, int cols)
+        : MatrixBase<T>(zeros(
+              cols > 0 ? (static_cast<int>(l.size()) + cols - 1) / cols : 0,
+              cols)) {
+        fill(l);
+    }
+    /**
+     * @brief Construct a new Matrix< T>:: Matrix object
+     *
+     * @param l 1d initializer list
+     * @param cols number of columns
+     * @param rows number of rows
+     */
+    Matrix(std::initializer_list<T> l, int cols, int rows)
+        : MatrixBase<T>(zeros(rows, cols)) {
+        if (static_cast<long long>(l.size()) > (long long)rows * cols)
+            throw TooManyInitializersException();
+        fill(l);
+    }
 
    private:
-    std::shared_ptr<T[]> _mem;
-    std::shared_ptr<T[]> _get_mem() const override;
+    friend class MatrixBase<T>;
+    // Takes the items as they are
+    explicit Matrix(Matrix2<T>&& mat) : MatrixBase<T>(std::move(mat)) {}
+
+    static Matrix2<T> zeros(int m, int n) {
+        if (m <= 0 || n <= 0) throw BadDimensionException(std::make_pair(m, n));
+        Matrix2<T> mat(m, n);
+        for (int i = 0; i < m; i++) std::fill_n(&mat.item(i, 0), n, T(0));
+        return mat;
+    }
+    // Row-major, the rest left zero
+    void fill(std::initializer_list<T> l) {
+        const int cols = this->_dim.second;
+        for (int k = 0; k < static_cast<int>(l.size()); k++)
+            this->row(k / cols)[k % cols] = l.begin()[k];
+    }
 };
 
 }  // namespace MatMulImpl
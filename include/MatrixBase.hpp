@@ -1,43 +1,221 @@
 
 #pragma once
 
+#include <iomanip>
 #include <iostream>
-#include <memory>
 #include <utility>
 
+#include "Algorithms.hpp"
+#include "MatrixExceptions.hpp"
+#include "Matrixv2.hpp"
+
 namespace MatMulImpl {
 using Dim_t = std::pair<int, int>;
+constexpr int DP_WIDTH = 6;
 
 template <class T>
 class Matrix;
 template <class T>
 class MatrixView;
 
+/**
+ * @brief Common interface of Matrix and MatrixView. The items are kept in
+ * a Matrix2, owned by a Matrix and shared by its views, so whole-matrix
+ * operations run on the Matrix2 kernels and on raw rows. Only at() checks
+ * its indices.
+ *
+ * @tparam T Type of element of matrix
+ */
 template <class T>
 class MatrixBase {
     MatrixBase() = delete;
 
    public:
-    const Dim_t& dim() const;
+    const Dim_t& dim() const { return _dim; }
     MatrixView<T> sub(int n, int m, int off_x, int off_y) const;
-    const MatrixView<const T> csub(int n, int m, int off_x, int off_y) const;
+    const MatrixView<T> csub(int n, int m, int off_x, int off_y) const;
     Matrix<T> operator+(const MatrixBase<T>& other) const;
     Matrix<T> operator*(const T& lambda) const;
-    Matrix<T> virtual operator*(const MatrixBase<T>& other) const;
+    Matrix<T> operator*(const MatrixBase<T>& other) const;
     bool operator==(const MatrixBase<T>& other) const;
-    T& at(int r, int c) const;
+    /**
+     * @brief Get the value at the given index
+     *
+     * @param r row index
+     * @param c column index
+     * @return T&
+     */
+    T& at(int r, int c) const {
+        if (r < 0 || c < 0 || r >= _dim.first || c >= _dim.second)
+            throw OutOfBoundsException(r, c, _dim, _main_dim);
+        return _mat.item(r, c);
+    }
+    /**
+     * @brief Row r, unchecked. Items of a row are contiguous; the rows are
+     * row_stride() items apart.
+     */
+    T* row(int r) const { return &_mat.item(r, 0); }
+    int row_stride() const { return _mat.row_stride(); }
+    /**
+     * @brief The Matrix2 holding the items, to hand the matrix to the
+     * kernels of Algorithms.hpp.
+     */
+    const Matrix2<T>& storage() const { return _mat; }
 
    protected:
-    std::shared_ptr<T[]> get_mem() const;
+    explicit MatrixBase(Matrix2<T>&& mat)
+        : _dim(mat.m, mat.n), _main_dim(_dim), _mat(std::move(mat)) {}
+    MatrixBase(Matrix2<T>&& mat, const Dim_t& main_dim)
+        : _dim(mat.m, mat.n), _main_dim(main_dim), _mat(std::move(mat)) {}
+
     Dim_t _dim;
     Dim_t _main_dim;  // copy for keeping track of main matrix size in views
-    Dim_t _offset = std::make_pair(0, 0);
+    mutable Matrix2<T> _mat;  // at() is const but hands out T&
 
    private:
-    std::shared_ptr<T[]> virtual _get_mem() const;
+    void check_sub(int n, int m, int off_x, int off_y) const;
 };
 
+/**
+ * @brief Get MatrixView of size n x m starting at given offset. The view
+ * keeps the items alive.
+ *
+ * @tparam T
+ * @param n row size of the view
+ * @param m column size of the view
+ * @param off_x offset in x direction from top left corner
+ * @param off_y offset in y direction from top left corner
+ * @return MatrixView<T>
+ */
+template <class T>
+MatrixView<T> MatrixBase<T>::sub(int n, int m, int off_x, int off_y) const {
+    check_sub(n, m, off_x, off_y);
+    return MatrixView<T>(_mat.sub(off_x, off_y, n, m), _main_dim);
+}
+
+/**
+ * @brief Get a read-only MatrixView of size n x m starting at given offset
+ *
+ * @tparam T
+ * @param n row size of the view
+ * @param m column size of the view
+ * @param off_x offset in x direction from top left corner
+ * @param off_y offset in y direction from top left corner
+ * @return const MatrixView<T>
+ */
+template <class T>
+const MatrixView<T> MatrixBase<T>::csub(int n, int m, int off_x,
+                                        int off_y) const {
+    return sub(n, m, off_x, off_y);
+}
+
+/**
+ * @brief Add two matrices
+ *
+ * @tparam T
+ * @param other Matrix to add
+ * @return Matrix<T>
+ */
+template <class T>
+Matrix<T> MatrixBase<T>::operator+(const MatrixBase<T>& other) const {
+    if (_dim != other._dim) throw BadDimensionException(_dim, other._dim);
+
+    Matrix<T> res(Matrix2<T>(_dim.first, _dim.second));
+    for (int i = 0; i < _dim.first; i++) {
+        const T *x = row(i), *y = other.row(i);
+        T* z = res.row(i);
+        for (int j = 0; j < _dim.second; j++) z[j] = x[j] + y[j];
+    }
+    return res;
+}
+
+/**
+ * @brief Multiply matrix with constant
+ *
+ * @tparam T
+ * @param lambda constant to multiply with
+ * @return Matrix<T>
+ */
+template <class T>
+Matrix<T> MatrixBase<T>::operator*(const T& lambda) const {
+    Matrix<T> res(Matrix2<T>(_dim.first, _dim.second));
+    for (int i = 0; i < _dim.first; i++) {
+        const T* x = row(i);
+        T* z = res.row(i);
+        for (int j = 0; j < _dim.second; j++) z[j] = x[j] * lambda;
+    }
+    return res;
+}
+
+/**
+ * @brief Multiply two matrices with the cache-blocked kernel
+ * (Multiplication::multiply_add)
+ *
+ * @tparam T
+ * @param other Matrix to multiply with
+ * @return Matrix<T>
+ */
+template <class T>
+Matrix<T> MatrixBase<T>::operator*(const MatrixBase<T>& other) const {
+    if (_dim.second != other._dim.first) {
+        throw BadDimensionException(_dim, other._dim);
+    }
+
+    Matrix<T> res(_dim.first, other._dim.second);
+    Multiplication::multiply_add(_mat, other._mat, res._mat,
+                                 default_thread_count());
+    return res;
+}
+
+/**
+ * @brief Check if two matrices are equal
+ *
+ * @tparam T
+ * @param other Matrix to compare with
+ * @return true if equal
+ * @return false if not equal
+ */
+template <class T>
+bool MatrixBase<T>::operator==(const MatrixBase<T>& other) const {
+    if (_dim != other._dim) {
+        return false;
+    }
+
+    for (int i = 0; i < _dim.first; i++) {
+        if (!std::equal(row(i), row(i) + _dim.second, other.row(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <class T>
+void MatrixBase<T>::check_sub(int n, int m, int off_x, int off_y) const {
+    if (n < 0 || m < 0 || off_x < 0 || off_y < 0 ||
+        off_x + n > _dim.first || off_y + m > _dim.second) {
+        throw OutOfBoundsException(off_x + n - 1, off_y + m - 1, _dim,
+                                   _main_dim);
+    }
+}
+
+/**
+ * @brief Output the matrix to the given stream
+ *
+ * @tparam T
+ * @param os output stream
+ * @param m matrix to output
+ * @return std::ostream&
+ */
 template <class T>
-std::ostream& operator<<(std::ostream& os, const MatrixBase<T>& m);
+std::ostream& operator<<(std::ostream& os, const MatrixBase<T>& m) {
+    for (int i = 0; i < m.dim().first; i++) {
+        const T* row = m.row(i);
+        for (int j = 0; j < m.dim().second; j++) {
+            os << std::setw(DP_WIDTH) << row[j];
+        }
+        os << "\n";
+    }
+    return os;
+}
 
 }  // namespace MatMulImpl
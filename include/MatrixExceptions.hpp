@@ -4,27 +4,17 @@
 #include <exception>
 #include <string>
 
-#include "Matrix.hpp"
+#include "Matrixv2.hpp"  // BadDimensionException, shared with Matrix2
 
 namespace MatMulImpl {
 
-class BadDimensionException : std::exception {
-   public:
-    BadDimensionException();
-    BadDimensionException(const char* s);
-    BadDimensionException(const Dim_t& a);
-    BadDimensionException(const Dim_t& a, const Dim_t& b);
-    const char* what() const noexcept override;
-
-   private:
-    std::string explain;
-};
 
 class OutOfBoundsException : std::exception {
    public:
     OutOfBoundsException();
     OutOfBoundsException(const char* s);
-    OutOfBoundsException(int i, int j, Dim_t& dim, Dim_t& main_dim);
+    OutOfBoundsException(int i, int j, const Dim_t& dim,
+                         const Dim_t& main_dim);
     const char* what() const noexcept override;
 
    private:
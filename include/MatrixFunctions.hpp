@@ -0,0 +1,319 @@
+/**
+ * @file MatrixFunctions.hpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief Integer powers and the exponential of square matrices.
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * Both are built from a fixed set of buffers allocated up front. Every
+ * product is written into a spare buffer with Multiplication::multiply_add
+ * and the buffers are then swapped, so no step allocates, however large
+ * the power.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef MATRIX_FUNCTIONS_HPP
+#define MATRIX_FUNCTIONS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Algorithms.hpp"
+#include "LU.hpp"
+#include "Matrixv2.hpp"
+
+namespace MatMulImpl {
+class NonFiniteMatrixException : std::exception {
+   public:
+    NonFiniteMatrixException(const std::string &s);
+    const char *what();
+
+   private:
+    std::string explain;
+};
+inline NonFiniteMatrixException::NonFiniteMatrixException(
+    const std::string &s)
+    : explain(s) {}
+inline const char *NonFiniteMatrixException::what() {
+    return explain.c_str();
+}
+
+class MatrixFunctions {
+   public:
+    /**
+     * @brief A^k by square-and-multiply, scanning the bits of k from the
+     * top: floor(log2 k) squarings and one product per further set bit.
+     * Uses two buffers besides A.
+     * @tparam T Type of element of matrix
+     * @param a Square matrix
+     * @param k Power; A^0 is the identity
+     * @param threads Number of threads of the multiply kernel
+     * @return Matrix2<T> A^k
+     */
+    template <class T>
+    static Matrix2<T> power(const Matrix2<T> &a, unsigned long long k,
+                            int threads = default_thread_count()) {
+        check_square("power", a);
+        MTP_MEMORY_TAG("power");
+        const int n = a.m;
+        Matrix2<T> x(n, n), y(n, n);
+        if (k == 0) {
+            set_identity(x);
+            return x;
+        }
+        copy(a, x);
+        Matrix2<T> *r = &x, *spare = &y;
+        int bit = 63;
+        while (!((k >> bit) & 1)) bit--;
+        for (bit--; bit >= 0; bit--) {
+            multiply_into(*r, *r, *spare, threads);
+            std::swap(r, spare);
+            if ((k >> bit) & 1) {
+                multiply_into(*r, a, *spare, threads);
+                std::swap(r, spare);
+            }
+        }
+        return std::move(*r);
+    }
+
+    /**
+     * @brief The matrix exponential e^A by scaling and squaring (Higham,
+     * "The scaling and squaring method for the matrix exponential
+     * revisited", 2005). A is scaled by 2^-s until a Pade approximant of
+     * degree 3 to 13 (3 to 7 for float) is accurate to working precision.
+     * The approximant takes at most six products and one LU solve, and is
+     * then squared s times.
+     * @tparam T float or double
+     * @param a Square matrix
+     * @param threads Number of threads of the multiply kernel
+     * @return Matrix2<T> e^A
+     * @throw NonFiniteMatrixException if A has an infinite or NaN item
+     */
+    template <class T>
+    static Matrix2<T> expm(const Matrix2<T> &a,
+                           int threads = default_thread_count()) {
+        static_assert(std::is_floating_point<T>::value,
+                      "expm needs a floating point element type");
+        check_square("expm", a);
+        MTP_MEMORY_TAG("expm");
+        const int n = a.m;
+        if (n == 0) return Matrix2<T>(0, 0);
+        constexpr bool single = sizeof(T) <= sizeof(float);
+        // Largest norms for which the Pade approximant of each degree is
+        // accurate to unit roundoff
+        constexpr int degrees[] = {3, 5, 7, 9, 13};
+        const double theta[] = {
+            single ? 4.258730016922831e-1 : 1.495585217958292e-2,
+            single ? 1.880152677804762e0 : 2.539398330063230e-1,
+            single ? 3.925724783138660e0 : 9.504178996162932e-1,
+            2.097847961257068e0, 5.371920351148152e0};
+        const int top = single ? 2 : 4;
+
+        const double norm = norm1(a);
+        // The scaling below would cast an infinite exponent to int
+        if (!std::isfinite(norm)) {
+            std::stringstream ss;
+            ss << "expm: the matrix has an infinite or NaN item (1-norm "
+               << norm << ")";
+            throw NonFiniteMatrixException(ss.str());
+        }
+        int d = 0, s = 0;
+        while (d < top && norm > theta[d]) d++;
+        if (norm > theta[d])
+            s = static_cast<int>(std::ceil(std::log2(norm / theta[d])));
+        const int m = degrees[d];
+
+        Matrix2<T> x(n, n), a2(n, n), a4(n, n), a6(n, n), u(n, n), v(n, n);
+        copy(a, x);
+        if (s > 0) {
+            const T scale = std::ldexp(T(1), -s);
+            for (int i = 0; i < n; i++) {
+                T *row = &x.item(i, 0);
+                for (int j = 0; j < n; j++) row[j] *= scale;
+            }
+        }
+        const double *c = pade(m);
+        multiply_into(x, x, a2, threads);
+        if (m >= 5) multiply_into(a2, a2, a4, threads);
+        if (m >= 7) multiply_into(a2, a4, a6, threads);
+        // u = x * (odd part), v = even part; x^8 for degree 9 goes into u
+        // while it is needed
+        if (m == 3) {
+            combine(v, c[3], a2, 0, a2, 0, a2, c[1]);
+            multiply_into(x, v, u, threads);
+            combine(v, c[2], a2, 0, a2, 0, a2, c[0]);
+        } else if (m == 5) {
+            combine(v, c[5], a4, c[3], a2, 0, a2, c[1]);
+            multiply_into(x, v, u, threads);
+            combine(v, c[4], a4, c[2], a2, 0, a2, c[0]);
+        } else if (m == 7) {
+            combine(v, c[7], a6, c[5], a4, c[3], a2, c[1]);
+            multiply_into(x, v, u, threads);
+            combine(v, c[6], a6, c[4], a4, c[2], a2, c[0]);
+        } else if (m == 9) {
+            Matrix2<T> &a8 = u;
+            multiply_into(a4, a4, a8, threads);
+            combine(v, c[8], a8, c[6], a6, c[4], a4, c[0]);
+            accumulate(v, T(c[2]), a2);
+            // a6 is not needed after this; it holds the odd part
+            combine(a6, c[9], a8, c[7], a6, c[5], a4, c[1]);
+            accumulate(a6, T(c[3]), a2);
+            multiply_into(x, a6, u, threads);
+        } else {
+            // u = x [a6 (c13 a6 + c11 a4 + c9 a2) + c7 a6 + c5 a4 + c3 a2
+            //        + c1 I]
+            combine(v, c[13], a6, c[11], a4, c[9], a2, 0);
+            multiply_into(a6, v, u, threads);
+            accumulate(u, T(c[7]), a6);
+            accumulate(u, T(c[5]), a4);
+            accumulate(u, T(c[3]), a2);
+            add_diagonal(u, T(c[1]));
+            multiply_into(x, u, v, threads);
+            swap_items(u, v);
+            // v = a6 (c12 a6 + c10 a4 + c8 a2) + c6 a6 + c4 a4 + c2 a2
+            //     + c0 I
+            combine(x, c[12], a6, c[10], a4, c[8], a2, 0);
+            multiply_into(a6, x, v, threads);
+            accumulate(v, T(c[6]), a6);
+            accumulate(v, T(c[4]), a4);
+            accumulate(v, T(c[2]), a2);
+            add_diagonal(v, T(c[0]));
+        }
+        // r = (v - u)^-1 (v + u)
+        for (int i = 0; i < n; i++) {
+            T *ui = &u.item(i, 0), *vi = &v.item(i, 0);
+            for (int j = 0; j < n; j++) {
+                const T p = vi[j] + ui[j];
+                ui[j] = vi[j] - ui[j];
+                vi[j] = p;
+            }
+        }
+        Matrix2<T> r = LU<T>(u, 64, threads).solve(v, threads);
+        Matrix2<T> *e = &r, *spare = &x;
+        for (int i = 0; i < s; i++) {
+            multiply_into(*e, *e, *spare, threads);
+            std::swap(e, spare);
+        }
+        return std::move(*e);
+    }
+
+   private:
+    template <class T>
+    static void check_square(const char *who, const Matrix2<T> &a) {
+        if (a.m != a.n) {
+            std::stringstream ss;
+            ss << who << ": a " << a.m << "x" << a.n << " matrix is not square";
+            throw BadDimensionException(ss.str().c_str());
+        }
+    }
+
+    // c = ab, c not aliasing a or b
+    template <class T>
+    static void multiply_into(const Matrix2<T> &a, const Matrix2<T> &b,
+                              Matrix2<T> &c, int threads) {
+        for (int i = 0; i < c.m; i++) std::fill_n(&c.item(i, 0), c.n, T(0));
+        Multiplication::multiply_add(a, b, c, threads);
+    }
+
+    template <class T>
+    static void copy(const Matrix2<T> &from, Matrix2<T> &to) {
+        for (int i = 0; i < from.m; i++)
+            std::copy_n(&from.citem(i, 0), from.n, &to.item(i, 0));
+    }
+
+    // Row by row: the buffers need not be contiguous
+    template <class T>
+    static void swap_items(Matrix2<T> &x, Matrix2<T> &y) {
+        for (int i = 0; i < x.m; i++)
+            std::swap_ranges(&x.item(i, 0), &x.item(i, 0) + x.n,
+                             &y.item(i, 0));
+    }
+
+    template <class T>
+    static void set_identity(Matrix2<T> &x) {
+        for (int i = 0; i < x.m; i++) {
+            std::fill_n(&x.item(i, 0), x.n, T(0));
+            x.item(i, i) = T(1);
+        }
+    }
+
+    // out = c1 x1 + c2 x2 + c3 x3 + c0 I
+    template <class T>
+    static void combine(Matrix2<T> &out, double c1, const Matrix2<T> &x1,
+                        double c2, const Matrix2<T> &x2, double c3,
+                        const Matrix2<T> &x3, double c0) {
+        for (int i = 0; i < out.m; i++) {
+            T *o = &out.item(i, 0);
+            const T *r1 = &x1.citem(i, 0), *r2 = &x2.citem(i, 0),
+                    *r3 = &x3.citem(i, 0);
+            for (int j = 0; j < out.n; j++)
+                o[j] = T(c1) * r1[j] + T(c2) * r2[j] + T(c3) * r3[j];
+            o[i] += T(c0);
+        }
+    }
+
+    // out += c x
+    template <class T>
+    static void accumulate(Matrix2<T> &out, T c, const Matrix2<T> &x) {
+        for (int i = 0; i < out.m; i++) {
+            T *o = &out.item(i, 0);
+            const T *r = &x.citem(i, 0);
+            for (int j = 0; j < out.n; j++) o[j] += c * r[j];
+        }
+    }
+
+    template <class T>
+    static void add_diagonal(Matrix2<T> &out, T c) {
+        for (int i = 0; i < out.m; i++) out.item(i, i) += c;
+    }
+
+    // Largest column sum of absolute values; NaN if any sum is NaN
+    template <class T>
+    static double norm1(const Matrix2<T> &a) {
+        std::vector<double> sums(a.n, 0.0);
+        for (int i = 0; i < a.m; i++) {
+            const T *row = &a.citem(i, 0);
+            for (int j = 0; j < a.n; j++) sums[j] += std::abs(row[j]);
+        }
+        double norm = 0.0;
+        for (double sum : sums)
+            if (sum > norm || std::isnan(sum)) norm = sum;
+        return norm;
+    }
+
+    // Coefficients of the degree m Pade approximant, constant term first
+    static const double *pade(int m) {
+        static const double p3[] = {120, 60, 12, 1};
+        static const double p5[] = {30240, 15120, 3360, 420, 30, 1};
+        static const double p7[] = {17297280, 8648640, 1995840, 277200,
+                                    25200,    1512,    56,      1};
+        static const double p9[] = {17643225600., 8821612800., 2075673600.,
+                                    302702400.,   30270240.,   2162160.,
+                                    110880.,      3960.,       90.,
+                                    1.};
+        static const double p13[] = {
+            64764752532480000., 32382376266240000., 7771770303897600.,
+            1187353796428800.,  129060195264000.,   10559470521600.,
+            670442572800.,      33522128640.,       1323241920.,
+            40840800.,          960960.,            16380.,
+            182.,               1.};
+        switch (m) {
+            case 3: return p3;
+            case 5: return p5;
+            case 7: return p7;
+            case 9: return p9;
+            default: return p13;
+        }
+    }
+};
+}  // namespace MatMulImpl
+
+#endif  // MATRIX_FUNCTIONS_HPP
@@ -0,0 +1,407 @@
+/**
+ * @file MatrixMarket.hpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief Reader and writer for MatrixMarket (.mtx) text files.
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * Both the dense "array" and the sparse "coordinate" formats are read into
+ * a dense Matrix2. The file is mapped, the body is cut into chunks at line
+ * boundaries and every chunk is parsed on its own thread with
+ * std::from_chars; only the final placement of the parsed values is
+ * sequential.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef MATRIXMARKET_HPP
+#define MATRIXMARKET_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "MappedMatrix.hpp"
+#include "Matrixv2.hpp"
+#include "Parallel.hpp"
+
+namespace MatMulImpl {
+class MatrixMarket {
+   public:
+    enum class Format { Array, Coordinate };
+    enum class Field { Real, Integer, Complex, Pattern };
+    enum class Symmetry { General, Symmetric, SkewSymmetric, Hermitian };
+
+    struct Banner {
+        Format format;
+        Field field;
+        Symmetry symmetry;
+        std::int64_t rows, cols, entries;  // entries: non-zeros or rows*cols
+    };
+
+    /**
+     * @brief Reads a .mtx file into a dense matrix. Missing coordinate
+     * entries are zero; symmetric storage is expanded.
+     * @tparam T Element type; Complex files need a std::complex T
+     * @param path File to read
+     * @param threads Number of parser threads
+     */
+    template <class T>
+    static Matrix2<T> read(const std::string &path,
+                           int threads = default_thread_count()) {
+        auto file = map_file(path);
+        const char *p = file.row(0), *end = p + file.cols();
+        Banner b = parse_banner(p, end, path);
+        if (b.field == Field::Complex && !is_complex<T>::value)
+            throw MatrixIOException(
+                path + ": complex data needs a std::complex element type");
+        if (b.rows > INT32_MAX || b.cols > INT32_MAX)
+            throw BadDimensionException(
+                "MatrixMarket::read: matrix too large for Matrix2");
+        int m = static_cast<int>(b.rows), n = static_cast<int>(b.cols);
+        Matrix2<T> mat(m, n);
+        for (int i = 0; i < m; i++) std::fill_n(&mat.item(i, 0), n, T(0));
+
+        // Split the body at line starts, one chunk per thread
+        int parts = std::max(1, threads);
+        std::vector<const char *> cut(parts + 1, end);
+        cut[0] = p;
+        for (int k = 1; k < parts; k++) {
+            const char *q = p + (end - p) * k / parts;
+            q = std::max(q, cut[k - 1]);
+            while (q < end && q > p && q[-1] != '\n') q++;
+            cut[k] = q;
+        }
+        const int per_entry = (b.format == Format::Coordinate ? 2 : 0) +
+                              (b.field == Field::Complex   ? 2
+                               : b.field == Field::Pattern ? 0
+                                                           : 1);
+        std::vector<std::vector<Entry<T>>> parsed(parts);
+        std::vector<std::string> errors(parts);
+        parallel_for_rows(parts, parts, [&](int k0, int k1, int) {
+            for (int k = k0; k < k1; k++) {
+                parse_chunk(cut[k], cut[k + 1], b, per_entry, parsed[k],
+                            errors[k]);
+            }
+        });
+        for (auto &&e : errors)
+            if (!e.empty()) throw MatrixIOException(path + ": " + e);
+
+        std::int64_t seen = 0;
+        for (auto &&chunk : parsed) seen += chunk.size();
+        if (seen != b.entries)
+            throw MatrixIOException(path + ": expected " +
+                                    std::to_string(b.entries) +
+                                    " entries but found " +
+                                    std::to_string(seen));
+        // Array data is column-major. Symmetric variants store only the lower
+        // triangle; skew-symmetric ones also leave out the (zero) diagonal.
+        const bool skew = b.symmetry == Symmetry::SkewSymmetric;
+        std::int64_t ai = skew ? 1 : 0, aj = 0;
+        for (auto &&chunk : parsed) {
+            for (auto &&e : chunk) {
+                std::int64_t i = e.i, j = e.j;
+                if (b.format == Format::Array) {
+                    i = ai, j = aj;
+                    if (++ai == m) {
+                        aj++;
+                        ai = b.symmetry == Symmetry::General ? 0
+                             : skew                          ? aj + 1
+                                                             : aj;
+                    }
+                }
+                // The mirrored item must be in range too; parse_banner
+                // only lets square matrices be symmetric, so this is cheap
+                if (i < 0 || i >= m || j < 0 || j >= n ||
+                    (i != j && b.symmetry != Symmetry::General &&
+                     (j >= m || i >= n)))
+                    throw MatrixIOException(path + ": entry out of range");
+                mat.item(i, j) = e.v;
+                if (i != j) mirror(mat, i, j, e.v, b.symmetry);
+            }
+        }
+        return mat;
+    }
+
+    /**
+     * @brief Writes a matrix as a general .mtx file.
+     * @param mat Matrix to write
+     * @param path Output file
+     * @param format Array writes every value; Coordinate only non-zeros
+     * @param threads Number of formatter threads
+     */
+    template <class T>
+    static void write(const Matrix2<T> &mat, const std::string &path,
+                      Format format = Format::Array,
+                      int threads = default_thread_count()) {
+        constexpr bool complex = is_complex<T>::value;
+        std::ofstream out(path, std::ios::binary);
+        if (!out) throw MatrixIOException(path + ": cannot create");
+        out << "%%MatrixMarket matrix "
+            << (format == Format::Array ? "array " : "coordinate ")
+            << (complex                     ? "complex"
+                : std::is_integral_v<T> ? "integer"
+                                        : "real")
+            << " general\n";
+        // Columns are formatted in parallel and written out in order
+        int parts = std::max(1, std::min(threads, mat.n));
+        std::vector<std::string> text(parts);
+        std::vector<std::int64_t> nnz(parts, 0);
+        parallel_for_rows(mat.n, parts, [&](int j0, int j1, int p) {
+            std::string &s = text[p];
+            for (int j = j0; j < j1; j++) {
+                for (int i = 0; i < mat.m; i++) {
+                    const T &v = mat.citem(i, j);
+                    if (format == Format::Coordinate) {
+                        if (v == T(0)) continue;
+                        append(s, std::int64_t(i) + 1);
+                        s += ' ';
+                        append(s, std::int64_t(j) + 1);
+                        s += ' ';
+                        nnz[p]++;
+                    }
+                    append_value(s, v);
+                    s += '\n';
+                }
+            }
+        });
+        std::int64_t total = 0;
+        for (auto c : nnz) total += c;
+        out << mat.m << ' ' << mat.n;
+        if (format == Format::Coordinate) out << ' ' << total;
+        out << '\n';
+        for (auto &&s : text) out.write(s.data(), s.size());
+        if (!out) throw MatrixIOException(path + ": write failed");
+    }
+
+    /**
+     * @brief Reads only the banner and size line of a file.
+     */
+    static Banner read_banner(const std::string &path) {
+        auto file = map_file(path);
+        const char *p = file.row(0);
+        return parse_banner(p, p + file.cols(), path);
+    }
+
+   private:
+    template <class T>
+    struct is_complex : std::false_type {};
+    template <class U>
+    struct is_complex<std::complex<U>> : std::true_type {};
+
+    template <class T>
+    struct real_of {
+        using type = T;
+    };
+    template <class U>
+    struct real_of<std::complex<U>> {
+        using type = U;
+    };
+
+    template <class T>
+    struct Entry {
+        std::int64_t i, j;
+        T v;
+    };
+
+    static MappedMatrix<char> map_file(const std::string &path) {
+        std::ifstream f(path, std::ios::binary | std::ios::ate);
+        if (!f) throw MatrixIOException(path + ": cannot open");
+        std::int64_t size = f.tellg();
+        return MappedMatrix<char>::open(path, 1, size);
+    }
+
+    static std::string lower(std::string s) {
+        for (auto &c : s) c = static_cast<char>(std::tolower(c));
+        return s;
+    }
+
+    static std::string next_line(const char *&p, const char *end) {
+        const char *q = std::find(p, end, '\n');
+        std::string s(p, q);
+        if (!s.empty() && s.back() == '\r') s.pop_back();
+        p = q < end ? q + 1 : end;
+        return s;
+    }
+
+    static Banner parse_banner(const char *&p, const char *end,
+                               const std::string &path) {
+        char obj[32] = {}, fmt[32] = {}, field[32] = {}, sym[32] = {};
+        std::string line = next_line(p, end);
+        if (line.rfind("%%MatrixMarket", 0) != 0 ||
+            std::sscanf(line.c_str() + 14, "%31s %31s %31s %31s", obj, fmt,
+                        field, sym) != 4 ||
+            lower(obj) != "matrix")
+            throw MatrixIOException(path + ": not a MatrixMarket matrix");
+        Banner b;
+        std::string f = lower(fmt), d = lower(field), s = lower(sym);
+        if (f == "array") b.format = Format::Array;
+        else if (f == "coordinate") b.format = Format::Coordinate;
+        else throw MatrixIOException(path + ": unknown format " + f);
+        if (d == "real" || d == "double") b.field = Field::Real;
+        else if (d == "integer") b.field = Field::Integer;
+        else if (d == "complex") b.field = Field::Complex;
+        else if (d == "pattern") b.field = Field::Pattern;
+        else throw MatrixIOException(path + ": unknown field " + d);
+        if (s == "general") b.symmetry = Symmetry::General;
+        else if (s == "symmetric") b.symmetry = Symmetry::Symmetric;
+        else if (s == "skew-symmetric") b.symmetry = Symmetry::SkewSymmetric;
+        else if (s == "hermitian") b.symmetry = Symmetry::Hermitian;
+        else throw MatrixIOException(path + ": unknown symmetry " + s);
+
+        do {
+            if (p >= end) throw MatrixIOException(path + ": missing size");
+            line = next_line(p, end);
+        } while (line.empty() || line[0] == '%');
+        long long r = 0, c = 0, e = 0;
+        int got = std::sscanf(line.c_str(), "%lld %lld %lld", &r, &c, &e);
+        if (got < (b.format == Format::Coordinate ? 3 : 2) || r < 0 || c < 0)
+            throw MatrixIOException(path + ": bad size line");
+        b.rows = r, b.cols = c;
+        if (b.symmetry != Symmetry::General && r != c)
+            throw MatrixIOException(path + ": a " + s +
+                                    " matrix must be square");
+        if (b.format == Format::Array) {
+            if (b.symmetry == Symmetry::General) {
+                e = r * c;
+            } else if (b.symmetry == Symmetry::SkewSymmetric) {
+                e = r * (r - 1) / 2;
+            } else {
+                e = r * (r + 1) / 2;
+            }
+        }
+        b.entries = e;
+        return b;
+    }
+
+    template <class T>
+    static void mirror(Matrix2<T> &mat, std::int64_t i, std::int64_t j,
+                       const T &v, Symmetry s) {
+        if (s == Symmetry::Symmetric) {
+            mat.item(j, i) = v;
+        } else if (s == Symmetry::SkewSymmetric) {
+            mat.item(j, i) = -v;
+        } else if (s == Symmetry::Hermitian) {
+            if constexpr (is_complex<T>::value) {
+                mat.item(j, i) = std::conj(v);
+            } else {
+                mat.item(j, i) = v;
+            }
+        }
+    }
+
+    static const char *skip_space(const char *p, const char *end) {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+        return p;
+    }
+
+    template <class U>
+    static const char *number(const char *p, const char *end, U &out) {
+        p = skip_space(p, end);
+        if (p < end && *p == '+') p++;  // from_chars rejects a leading '+'
+        auto res = std::from_chars(p, end, out);
+        if constexpr (std::is_integral_v<U>) {
+            // Integer matrices written as "3.0" or "1e3" are read; a value
+            // such as "3.5" is not an integer and is refused
+            const char *stop = res.ptr;
+            const bool fraction =
+                stop < end && (*stop == '.' || *stop == 'e' || *stop == 'E');
+            if (res.ec != std::errc() || fraction) {
+                double d;
+                auto real = std::from_chars(p, end, d);
+                const double limit =
+                    std::ldexp(1.0, std::numeric_limits<U>::digits);
+                const double lowest = std::is_signed_v<U> ? -limit : 0.0;
+                if (real.ec != std::errc() || d != std::trunc(d) ||
+                    d < lowest || d >= limit)
+                    return nullptr;
+                out = static_cast<U>(d);
+                return real.ptr;
+            }
+        }
+        if (res.ec != std::errc()) return nullptr;
+        return res.ptr;
+    }
+
+    template <class T>
+    static void parse_chunk(const char *p, const char *end, const Banner &b,
+                            int per_entry, std::vector<Entry<T>> &out,
+                            std::string &error) {
+        using Real = typename real_of<T>::type;
+        out.reserve((end - p) / (4 * std::max(per_entry, 1)));
+        while (p < end) {
+            p = skip_space(p, end);
+            if (p == end) break;
+            if (*p == '\n') {
+                p++;
+                continue;
+            }
+            if (*p == '%') {
+                p = std::find(p, end, '\n');
+                continue;
+            }
+            Entry<T> e{0, 0, T(1)};
+            if (b.format == Format::Coordinate) {
+                if (!(p = number(p, end, e.i)) || !(p = number(p, end, e.j))) {
+                    error = "malformed coordinate entry";
+                    return;
+                }
+                e.i--, e.j--;
+            }
+            if (b.field == Field::Complex) {
+                Real re, im;
+                if (!(p = number(p, end, re)) || !(p = number(p, end, im))) {
+                    error = "malformed complex value";
+                    return;
+                }
+                if constexpr (is_complex<T>::value) e.v = T(re, im);
+            } else if (b.field != Field::Pattern) {
+                Real v;
+                if (!(p = number(p, end, v))) {
+                    error = "malformed value";
+                    return;
+                }
+                e.v = T(v);
+            }
+            // Only blanks may follow the last field of an entry
+            p = skip_space(p, end);
+            if (p < end && *p != '\n') {
+                error = "unexpected text after an entry";
+                return;
+            }
+            out.push_back(e);
+        }
+    }
+
+    static void append(std::string &s, std::int64_t v) {
+        char buf[24];
+        auto res = std::to_chars(buf, buf + sizeof(buf), v);
+        s.append(buf, res.ptr);
+    }
+    template <class T>
+    static void append_value(std::string &s, const T &v) {
+        if constexpr (is_complex<T>::value) {
+            append_value(s, v.real());
+            s += ' ';
+            append_value(s, v.imag());
+        } else {
+            char buf[64];
+            // Shortest representation that round-trips
+            auto res = std::to_chars(buf, buf + sizeof(buf), v);
+            s.append(buf, res.ptr);
+        }
+    }
+};
+}  // namespace MatMulImpl
+
+#endif  // MATRIXMARKET_HPP
@@ -1,22 +1,31 @@
 #pragma once
 
-#include <memory>
+#include <utility>
 
 #include "MatrixBase.hpp"
 
 namespace MatMulImpl {
+/**
+ * @brief A block of a Matrix, from MatrixBase::sub(). Writes through the
+ * view are seen by the matrix, and the view keeps the items alive.
+ */
 template <class T>
 class MatrixView : public MatrixBase<T> {
     MatrixView() = delete;
 
-   protected:
-    MatrixView(std::shared_ptr<T[]> mem, int n, int m, int off_x, int off_y,
-               Dim_t orig_dim);
-    T& item(int i, int j) override;
-    std::shared_ptr<T[]> get_mem() const override;
+   public:
+    /**
+     * @brief Another view of the same items
+     */
+    MatrixView(const MatrixView<T>& o)
+        : MatrixBase<T>(o._mat.sub(0, 0, o._dim.first, o._dim.second),
+                        o._main_dim) {}
+    MatrixView(MatrixView<T>&& o) = default;
 
-   private:
-    std::weak_ptr<T[]> _get_mem;
+   protected:
+    friend class MatrixBase<T>;
+    MatrixView(Matrix2<T>&& view, const Dim_t& main_dim)
+        : MatrixBase<T>(std::move(view), main_dim) {}
 };
 
 }  // namespace MatMulImpl
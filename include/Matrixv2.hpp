@@ -10,6 +10,17 @@
  * has to be in the same compilation unit as the caller for it to be compiled,
  * and to do that we put the source in the header file.
  *
+ * Storage is reference counted. A copy shares the storage of the matrix
+ * it was copied from, and the first write through either one (any call to
+ * item()) gives that one storage of its own, so a copy costs O(1) until it
+ * is written. A view from sub() or csub() also shares the storage and
+ * keeps it alive, however long it outlives the matrix, and a write through
+ * a view is seen by the matrix. Copying a matrix that has views copies
+ * its items, so the copy never sees writes through those views. Only the
+ * first item() after a copy touches the reference counts; other accesses
+ * test one flag of the matrix itself. Pointers obtained from item() are
+ * not covered: copying a matrix makes them point into shared storage.
+ *
  * @copyright Copyright (c) 2024
  *
  */
@@ -17,39 +28,129 @@
 #ifndef MATRIXV2_HPP
 #define MATRIXV2_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <initializer_list>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "Storage.hpp"
+
+// Keeps a rarely taken path out of the code inlined into callers
+#if defined(__GNUC__)
+#define MTP_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define MTP_NOINLINE __declspec(noinline)
+#else
+#define MTP_NOINLINE
+#endif
+
 namespace MatMulImpl {
 using Dim_t = std::pair<int, int>;
 class BadDimensionException : std::exception {
    public:
     BadDimensionException();
     BadDimensionException(const char* s);
+    BadDimensionException(const Dim_t& a);
+    BadDimensionException(const Dim_t& a, const Dim_t& b);
     const char* what();
 
    private:
     std::string explain;
 };
-BadDimensionException::BadDimensionException() : explain("") {}
-BadDimensionException::BadDimensionException(const char* s) : explain(s) {}
-const char* BadDimensionException::what() { return explain.c_str(); }
+inline BadDimensionException::BadDimensionException() : explain("") {}
+inline BadDimensionException::BadDimensionException(const char* s)
+    : explain(s) {}
+inline BadDimensionException::BadDimensionException(const Dim_t& a) {
+    std::stringstream ss;
+    ss << "Invalid dimension: (" << a.first << ", " << a.second << ")";
+    explain = ss.str();
+}
+inline BadDimensionException::BadDimensionException(const Dim_t& a,
+                                                    const Dim_t& b) {
+    std::stringstream ss;
+    ss << "Bad dimension: (" << a.first << ", " << a.second << ") vs ("
+       << b.first << ", " << b.second << ")";
+    explain = ss.str();
+}
+inline const char* BadDimensionException::what() { return explain.c_str(); }
+class MatrixIOException : std::exception {
+   public:
+    MatrixIOException(const std::string& s);
+    const char* what();
+
+   private:
+    std::string explain;
+};
+inline MatrixIOException::MatrixIOException(const std::string& s)
+    : explain(s) {}
+inline const char* MatrixIOException::what() { return explain.c_str(); }
 template <class T>
 class Matrix2 {
    public:
     Matrix2() = delete;
-    Matrix2(int m, int n) : mem(new T[m * n]), m(m), n(n), mem_row_sz(n) {}
-    Matrix2(const Matrix2<T>& m) =
-        delete;  // no copying for now: not implemented
-    Matrix2(Matrix2<T>&& m) = default;
+    Matrix2(int m, int n) : m(m), n(n), mem_row_sz(n) {
+        mem = StorageAllocator::allocate<T>(m, n, StoragePolicy(),
+                                            mapped_bytes);
+    }
+    /**
+     * @brief Allocates the matrix with an explicit storage policy (NUMA
+     * placement and/or huge pages). See Storage.hpp.
+     */
+    Matrix2(int m, int n, const StoragePolicy& policy)
+        : m(m), n(n), mem_row_sz(n) {
+        mem = StorageAllocator::allocate<T>(m, n, policy, mapped_bytes);
+    }
+    /**
+     * @brief Shares the storage of o until either is written, unless o is
+     * a view or has views, in which case the items are copied.
+     */
+    Matrix2(const Matrix2<T>& o)
+        : print_width(o.print_width), m(o.m), n(o.n), mem_row_sz(o.n) {
+        if (Block* b = o.is_view ? nullptr : o.shared_block()) {
+            std::uint64_t refs = b->refs.load(std::memory_order_relaxed);
+            while (refs < one_view) {  // No views
+                if (b->refs.compare_exchange_weak(refs, refs + 1,
+                                                  std::memory_order_relaxed)) {
+                    mem = o.mem;
+                    block.store(b, std::memory_order_relaxed);
+                    o.shared.store(true, std::memory_order_relaxed);
+                    shared.store(true, std::memory_order_relaxed);
+                    return;
+                }
+            }
+        }
+        mem = StorageAllocator::allocate<T>(m, n, StoragePolicy(),
+                                            mapped_bytes);
+        for (int i = 0; i < m; i++)
+            std::copy_n(&o.citem(i, 0), n, mem + offset(i, 0));
+    }
+    Matrix2(Matrix2<T>&& o) noexcept
+        : print_width(o.print_width),
+          m(o.m),
+          n(o.n),
+          mem(std::exchange(o.mem, nullptr)),
+          mem_row_sz(o.mem_row_sz),
+          is_view(o.is_view),
+          mapped_bytes(o.mapped_bytes),
+          view_block(std::exchange(o.view_block, nullptr)),
+          block(o.block.exchange(nullptr, std::memory_order_relaxed)),
+          shared(o.shared.load(std::memory_order_relaxed)) {}
     Matrix2<T>& operator=(Matrix2<T>&& m) = default;
     ~Matrix2() {
-        if (!is_view) {
-            delete[] mem;
+        if (is_view) {
+            if (view_block) drop(view_block, one_view);
+        } else if (Block* b = block.load(std::memory_order_relaxed)) {
+            drop(b, 1);
+        } else {
+            StorageAllocator::release(mem, static_cast<std::size_t>(m) * n,
+                                      mapped_bytes);
         }
     }
     static Matrix2<T> from(std::initializer_list<std::initializer_list<T> > l) {
@@ -83,23 +184,82 @@ class Matrix2 {
         }
         return mat;
     }
-    inline T& item(int i, int j) { return mem[i * mem_row_sz + j]; }
-    inline const T& citem(int i, int j) const {
-        return mem[i * mem_row_sz + j];
+    inline T& item(int i, int j) {
+        if (shared.load(std::memory_order_relaxed)) unshare();
+        return mem[offset(i, j)];
+    }
+    inline const T& citem(int i, int j) const { return mem[offset(i, j)]; }
+    /**
+     * @brief Wraps memory owned by someone else (e.g. a mapped file) as a
+     * view. The memory must outlive the returned matrix.
+     * @param mem Address of item (0, 0)
+     * @param m Number of rows
+     * @param n Number of columns
+     * @param row_stride Number of items between the starts of two rows
+     */
+    static Matrix2<T> view_of(T* mem, int m, int n, int row_stride) {
+        return Matrix2<T>(mem, m, n, row_stride);
+    }
+    /**
+     * @brief Gives the matrix storage of its own if it shares it with
+     * copies. The first item() does this anyway; call it before several
+     * threads write to the matrix at once.
+     */
+    void unshare() {
+        if (!shared.load(std::memory_order_relaxed)) return;
+        shared.store(false, std::memory_order_relaxed);
+        Block* b = block.load(std::memory_order_relaxed);
+        if ((b->refs.load(std::memory_order_acquire) & owner_mask) == 1)
+            return;
+        Matrix2<T> own(m, n);
+        for (int i = 0; i < m; i++)
+            std::copy_n(mem + offset(i, 0), n, own.mem + own.offset(i, 0));
+        // own drops this matrix's reference to the shared block
+        own.block.store(b, std::memory_order_relaxed);
+        block.store(nullptr, std::memory_order_relaxed);
+        std::swap(mem, own.mem);
+        std::swap(mapped_bytes, own.mapped_bytes);
     }
+    /**
+     * @brief Distance in items between two rows of the underlying storage.
+     */
+    int row_stride() const { return mem_row_sz; }
+    /**
+     * @brief False for views. Views from sub() and csub() keep their
+     * storage alive; the memory under a view_of() view must outlive it.
+     */
+    bool owns_storage() const { return !is_view; }
     Dim_t dim() const { return Dim_t({m, n}); }
+    /**
+     * @brief A view of the block of m x n items at (i, j). Writes through
+     * the view are seen by the matrix, and the view keeps the storage
+     * alive.
+     */
     Matrix2<T> sub(int i, int j, int m, int n) {
-        // We don't have to keep track of the submatrices; we'll trust the
-        // caller (ourselves!) that we know what we are doing. I have no
-        // way of telling whether a submatrix is done being used or not.
-        // Besides, the sub matrix object should go out-of-scope with
-        // the parent matrix, right?
-        return Matrix2<T>(
-            mem + i * mem_row_sz + j, m, n,
-            mem_row_sz);  // bad idea; refactor later (if i feel like it)
+        unshare();
+        return Matrix2<T>(mem + offset(i, j), m, n, mem_row_sz,
+                          shared_block());
     }
+    /**
+     * @brief A read-only view, as sub(). It does not unshare the matrix:
+     * taken from a matrix that shares its storage with copies, it keeps
+     * showing the shared items if the matrix is then written.
+     */
     const Matrix2<T> csub(int i, int j, int m, int n) const {
-        return Matrix2<T>(mem + i * mem_row_sz + j, m, n, mem_row_sz);
+        return Matrix2<T>(mem + offset(i, j), m, n, mem_row_sz,
+                          shared_block());
+    }
+    /**
+     * @brief As sub() and csub(), but the view neither keeps the storage
+     * alive nor touches the reference counts. For the recursive kernels,
+     * whose views never outlive the matrix they are taken from.
+     */
+    Matrix2<T> borrow(int i, int j, int m, int n) {
+        unshare();
+        return Matrix2<T>(mem + offset(i, j), m, n, mem_row_sz);
+    }
+    const Matrix2<T> cborrow(int i, int j, int m, int n) const {
+        return Matrix2<T>(mem + offset(i, j), m, n, mem_row_sz);
     }
     Matrix2<T> operator+(const Matrix2<T>& b) const {
         if (!(Dim_t{m, n} == b.dim())) {
@@ -111,9 +271,8 @@ class Matrix2 {
         }
         Matrix2<T> c(m, n);
         for (int i = 0; i < m; i++) {
-            for (int j = 0; j < n; j++) {
-                c.item(i, j) = citem(i, j) + b.citem(i, j);
-            }
+            T* c_row = &c.item(i, 0);
+            for (int j = 0; j < n; j++) c_row[j] = citem(i, j) + b.citem(i, j);
         }
         return c;
     }
@@ -127,9 +286,8 @@ class Matrix2 {
         }
         Matrix2<T> c(m, n);
         for (int i = 0; i < m; i++) {
-            for (int j = 0; j < n; j++) {
-                c.item(i, j) = citem(i, j) - b.citem(i, j);
-            }
+            T* c_row = &c.item(i, 0);
+            for (int j = 0; j < n; j++) c_row[j] = citem(i, j) - b.citem(i, j);
         }
         return c;
     }
@@ -141,12 +299,13 @@ class Matrix2 {
                << " rows, but instead have " << b.dim().first;
             throw BadDimensionException(ss.str().c_str());
         }
-        Matrix2<T> c(m, n);
+        Matrix2<T> c(m, b.n);
         for (int i = 0; i < m; i++) {
-            for (int j = 0; j < n; j++) {
-                c.item(i, j) = citem(i, 0) * b.citem(0, j);
-                for (int k = 1; k < n; k++) {
-                    c.item(i, j) += citem(i, k) * b.citem(k, j);  // Traditional
+            T* row = c.mem + c.offset(i, 0);
+            for (int j = 0; j < b.n; j++) {
+                row[j] = T(0);
+                for (int k = 0; k < n; k++) {
+                    row[j] += citem(i, k) * b.citem(k, j);  // Traditional
                 }
             }
         }
@@ -170,10 +329,11 @@ class Matrix2 {
         if (this->dim() != a.dim())
             throw BadDimensionException(
                 "Target matrix is not the size of A and B.");
+        unshare();
         for (int i = 0; i < a.m; i++) {
-            for (int j = 0; j < a.n; j++) {
-                item(i, j) = a.citem(i, j) + b.citem(i, j);
-            }
+            T* row = mem + offset(i, 0);
+            for (int j = 0; j < a.n; j++)
+                row[j] = a.citem(i, j) + b.citem(i, j);
         }
     }
     /**
@@ -188,11 +348,13 @@ class Matrix2 {
                 "C is not the size of AB.");  // Insert more descriptive message
                                               // here
         }
+        unshare();
         for (int i = 0; i < m; i++) {
+            T* row = mem + offset(i, 0);
             for (int j = 0; j < n; j++) {
-                item(i, j) = a.citem(i, 0) * b.citem(0, j);
-                for (int k = 1; k < n; k++) {
-                    item(i, j) += b.citem(i, k) * b.citem(k, j);  // Traditional
+                row[j] = a.citem(i, 0) * b.citem(0, j);
+                for (int k = 1; k < a.n; k++) {
+                    row[j] += a.citem(i, k) * b.citem(k, j);  // Traditional
                 }
             }
         }
@@ -201,11 +363,59 @@ class Matrix2 {
     const int m, n;  // mxn matrix; it's constant so why not public
 
    private:
-    T* mem;
+    // Storage shared by a matrix, its copies and its views. A matrix gets
+    // one only when it is first copied or viewed, so that the many
+    // short-lived matrices of the recursive kernels never allocate one.
+    struct Block {
+        T* mem;
+        std::size_t count;
+        std::size_t mapped_bytes;
+        // Matrices using the storage: owners in the low 32 bits, views in
+        // the high 32 bits
+        std::atomic<std::uint64_t> refs{1};
+    };
+    static constexpr std::uint64_t one_view = std::uint64_t(1) << 32;
+    static constexpr std::uint64_t owner_mask = one_view - 1;
+    T* mem = nullptr;
     const int mem_row_sz;  // Number of items in a row in the actual matrix
     bool is_view = false;
-    Matrix2(T* mem, int m, int n, int mem_row_sz)
-        : mem(mem), m(m), n(n), mem_row_sz(mem_row_sz), is_view(true) {}
+    std::size_t mapped_bytes = 0;  // Non-zero if mem was mmap-ed
+    // Block of a view, fixed when it is made; null for view_of() views and
+    // borrowed views. Not atomic, so that the compiler can see through it.
+    Block* view_block = nullptr;
+    // Block of a matrix that is not a view, null until it is shared
+    mutable std::atomic<Block*> block{nullptr};
+    // The storage may be shared with copies; set by the copy constructor
+    mutable std::atomic<bool> shared{false};
+    Matrix2(T* mem, int m, int n, int mem_row_sz, Block* block = nullptr)
+        : m(m), n(n), mem(mem), mem_row_sz(mem_row_sz), is_view(true),
+          view_block(block) {
+        if (block) block->refs.fetch_add(one_view, std::memory_order_relaxed);
+    }
+    Block* shared_block() const {
+        if (is_view) return view_block;
+        Block* b = block.load(std::memory_order_acquire);
+        if (b || !mem) return b;
+        Block* fresh = new Block{mem, static_cast<std::size_t>(m) * n,
+                                 mapped_bytes};
+        if (block.compare_exchange_strong(b, fresh,
+                                          std::memory_order_acq_rel))
+            return fresh;
+        delete fresh;  // Another thread got there first
+        return b;
+    }
+    // Outlined so that the destructor of an uncounted view stays a no-op
+    // at its call sites
+    MTP_NOINLINE static void drop(Block* b, std::uint64_t ref) {
+        if (b->refs.fetch_sub(ref, std::memory_order_acq_rel) == ref) {
+            StorageAllocator::release(b->mem, b->count, b->mapped_bytes);
+            delete b;
+        }
+    }
+    // 64-bit so that matrices beyond 2^31 items can be addressed
+    inline std::ptrdiff_t offset(int i, int j) const {
+        return static_cast<std::ptrdiff_t>(i) * mem_row_sz + j;
+    }
 };
 template <class T1, class T2>
 Matrix2<T2> operator*(T1 k, const Matrix2<T2>& mat) {
@@ -213,9 +423,9 @@ Matrix2<T2> operator*(T1 k, const Matrix2<T2>& mat) {
     int m = dim.first, n = dim.second;
     Matrix2<T2> c(m, n);
     for (int i = 0; i < m; i++) {
-        for (int j = 0; j < n; j++) {
-            c.item(m, n) = k * mat.item(i, j);
-        }
+        const T2* x = &mat.citem(i, 0);
+        T2* row = &c.item(i, 0);
+        for (int j = 0; j < n; j++) row[j] = k * x[j];
     }
     return c;
 }
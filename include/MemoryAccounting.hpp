@@ -0,0 +1,345 @@
+/**
+ * @file MemoryAccounting.hpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief Accounting of Matrix2 storage, and a model of the peak memory of
+ * each multiplication algorithm.
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * StorageAllocator reports every allocation and release here. Counting is
+ * only done while accounting is active, i.e. while a MemoryScope is open or
+ * after MemoryAccounting::enable() (or MATMUL_MEMORY_ACCOUNTING=1 in the
+ * environment). Otherwise the cost is one relaxed load per allocation, which
+ * matters to the recursive algorithms: they allocate for every sum.
+ * Views and mapped files own no storage and are not counted. Allocator
+ * overhead and other heap use are not counted either.
+ *
+ * To measure a call, open a MemoryScope around it: it reports the bytes
+ * and allocations made inside it and the peak live bytes above the level at
+ * which it opened. Allocations made while a MemoryTag is active on the
+ * allocating thread are also totalled under the tag's name; the algorithms
+ * of Multiplication tag their allocations with their own names.
+ *
+ * MemoryModel predicts the peak of an algorithm from its recursion without
+ * running it.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef MEMORY_ACCOUNTING_HPP
+#define MEMORY_ACCOUNTING_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace MatMulImpl {
+/**
+ * @brief Totals of the allocations made under one tag.
+ */
+struct TagTotals {
+    long long allocations = 0;
+    std::size_t bytes = 0;
+};
+
+/**
+ * @brief Live counters of one tag. Obtained once per name from
+ * MemoryAccounting::tag(); the address never changes.
+ */
+struct TagCounter {
+    std::atomic<long long> allocations{0};
+    std::atomic<std::size_t> bytes{0};
+};
+
+class MemoryScope;
+
+class MemoryAccounting {
+   public:
+    /**
+     * @brief Keeps accounting active until the matching disable().
+     */
+    static void enable() { state().active++; }
+    static void disable() { state().active--; }
+    static bool active() { return state().active.load() > 0; }
+
+    /**
+     * @brief Bytes allocated minus bytes released while accounting was
+     * active. With accounting enabled from the start of the process, the
+     * bytes of matrix storage currently allocated.
+     */
+    static std::int64_t live_bytes() { return state().live.load(); }
+    /**
+     * @brief Highest live_bytes() so far.
+     */
+    static std::int64_t peak_bytes() { return state().peak.load(); }
+    /**
+     * @brief Number of allocations counted so far.
+     */
+    static long long allocations() { return state().allocations.load(); }
+    /**
+     * @brief Allocations by MemoryTag name.
+     */
+    static std::map<std::string, TagTotals> by_tag() {
+        std::lock_guard<std::mutex> lock(state().mtx);
+        std::map<std::string, TagTotals> out;
+        for (auto &&kv : state().tags) {
+            out[kv.first] = {kv.second->allocations.load(),
+                             kv.second->bytes.load()};
+        }
+        return out;
+    }
+    /**
+     * @brief The counters of a tag name, created on first use.
+     */
+    static TagCounter &tag(const std::string &name) {
+        std::lock_guard<std::mutex> lock(state().mtx);
+        auto &slot = state().tags[name];
+        if (!slot) slot.reset(new TagCounter);
+        return *slot;
+    }
+
+    /**
+     * @brief Called by StorageAllocator for every allocation.
+     */
+    static void on_allocate(std::size_t bytes) {
+        State &s = state();
+        if (s.active.load(std::memory_order_relaxed) == 0) return;
+        std::int64_t live =
+            s.live.fetch_add(std::int64_t(bytes)) + std::int64_t(bytes);
+        s.allocations.fetch_add(1, std::memory_order_relaxed);
+        std::int64_t p = s.peak.load(std::memory_order_relaxed);
+        while (live > p && !s.peak.compare_exchange_weak(p, live)) {
+        }
+        if (TagCounter *tag = current_tag()) {
+            tag->allocations.fetch_add(1, std::memory_order_relaxed);
+            tag->bytes.fetch_add(bytes, std::memory_order_relaxed);
+        }
+        if (s.scopes.load(std::memory_order_relaxed) > 0)
+            update_scopes(bytes, live);
+    }
+    /**
+     * @brief Called by StorageAllocator for every release.
+     */
+    static void on_release(std::size_t bytes) {
+        State &s = state();
+        if (s.active.load(std::memory_order_relaxed) == 0) return;
+        s.live -= std::int64_t(bytes);
+    }
+
+    /**
+     * @brief Counters of the innermost MemoryTag of the calling thread, or
+     * nullptr.
+     */
+    static TagCounter *&current_tag() {
+        thread_local TagCounter *tag = nullptr;
+        return tag;
+    }
+
+   private:
+    friend class MemoryScope;
+    struct State {
+        std::atomic<std::int64_t> live{0}, peak{0};
+        std::atomic<long long> allocations{0};
+        std::atomic<int> active{0};  // enable() calls plus open scopes
+        std::atomic<int> scopes{0};
+        std::mutex mtx;  // Guards tags and open
+        std::map<std::string, std::unique_ptr<TagCounter>> tags;
+        std::vector<MemoryScope *> open;
+
+        State() {
+            const char *env = std::getenv("MATMUL_MEMORY_ACCOUNTING");
+            if (env && std::atoi(env) > 0) active = 1;
+        }
+    };
+    static State &state() {
+        static State s;
+        return s;
+    }
+    static void update_scopes(std::size_t bytes, std::int64_t live);
+};
+
+/**
+ * @brief Measures the matrix storage used between its construction and
+ * destruction (or the latest query).
+ */
+class MemoryScope {
+   public:
+    MemoryScope() {
+        auto &s = MemoryAccounting::state();
+        std::lock_guard<std::mutex> lock(s.mtx);
+        s.open.push_back(this);
+        s.scopes++;
+        s.active++;
+        base = peak = s.live.load();
+    }
+    MemoryScope(const MemoryScope &) = delete;
+    MemoryScope &operator=(const MemoryScope &) = delete;
+    ~MemoryScope() {
+        auto &s = MemoryAccounting::state();
+        std::lock_guard<std::mutex> lock(s.mtx);
+        s.open.erase(std::find(s.open.begin(), s.open.end(), this));
+        s.scopes--;
+        s.active--;
+    }
+
+    /**
+     * @brief Highest live bytes inside the scope, above the live bytes when
+     * it opened.
+     */
+    std::size_t peak_bytes() const {
+        std::lock_guard<std::mutex> lock(MemoryAccounting::state().mtx);
+        return static_cast<std::size_t>(peak - base);
+    }
+    /**
+     * @brief Bytes allocated inside the scope, freed or not.
+     */
+    std::size_t allocated_bytes() const {
+        std::lock_guard<std::mutex> lock(MemoryAccounting::state().mtx);
+        return bytes;
+    }
+    long long allocations() const {
+        std::lock_guard<std::mutex> lock(MemoryAccounting::state().mtx);
+        return count;
+    }
+
+   private:
+    friend class MemoryAccounting;
+    std::int64_t base = 0, peak = 0;
+    std::size_t bytes = 0;
+    long long count = 0;
+};
+
+inline void MemoryAccounting::update_scopes(std::size_t bytes,
+                                            std::int64_t live) {
+    State &s = state();
+    std::lock_guard<std::mutex> lock(s.mtx);
+    for (MemoryScope *scope : s.open) {
+        scope->count++;
+        scope->bytes += bytes;
+        scope->peak = std::max(scope->peak, live);
+    }
+}
+
+/**
+ * @brief Attributes the calling thread's allocations to a tag until it
+ * goes out of scope. The innermost tag wins. In hot code use
+ * MTP_MEMORY_TAG, which looks the name up once per call site.
+ */
+class MemoryTag {
+   public:
+    explicit MemoryTag(TagCounter &counter)
+        : saved(MemoryAccounting::current_tag()) {
+        MemoryAccounting::current_tag() = &counter;
+    }
+    explicit MemoryTag(const std::string &name)
+        : MemoryTag(MemoryAccounting::tag(name)) {}
+    MemoryTag(const MemoryTag &) = delete;
+    MemoryTag &operator=(const MemoryTag &) = delete;
+    ~MemoryTag() { MemoryAccounting::current_tag() = saved; }
+
+   private:
+    TagCounter *saved;
+};
+
+/**
+ * @brief Peak matrix storage of the algorithms of Multiplication, derived
+ * from their recursions. Counts the result and every temporary; the inputs
+ * are not counted.
+ */
+class MemoryModel {
+   public:
+    /**
+     * @brief Predicted peak bytes of one multiplication of an m x k by a
+     * k x n matrix.
+     * @param algorithm "naive", "blocked", "div_and_conquer_sq2",
+     * "div_and_conquer" or "strassen"
+     * @param elem_size sizeof the element type
+     * @return std::size_t Predicted peak, or 0 for an unknown algorithm
+     */
+    static std::size_t predict_peak_bytes(const std::string &algorithm,
+                                          int m, int k, int n,
+                                          std::size_t elem_size) {
+        if (algorithm == "naive" || algorithm == "blocked")
+            return std::size_t(m) * n * elem_size;
+        if (algorithm == "div_and_conquer_sq2")
+            return div_and_conquer_sq2(n) * elem_size;
+        if (algorithm == "strassen") return strassen(n) * elem_size;
+        if (algorithm == "div_and_conquer") {
+            std::map<std::tuple<int, int, int>, std::size_t> memo;
+            return (std::size_t(m) * n + div_and_conquer(m, k, n, memo)) *
+                   elem_size;
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Items live at the peak of strassen on n x n, n a power of 2.
+     * Seven products are formed one after another; the last, m7, runs while
+     * m1..m6 and its two operand sums are held (8 quadrants), and the
+     * combination holds m1..m7, C and two sums (13 quadrants).
+     */
+    static std::size_t strassen(int n) {
+        if (n <= 1) return 1;
+        std::size_t q = std::size_t(n / 2) * (n / 2);
+        return std::max(8 * q + strassen(n / 2), 13 * q);
+    }
+
+    /**
+     * @brief Items live at the peak of div_and_conquer_sq2 on n x n. C is
+     * allocated first; the second product of a quadrant runs while the
+     * first is held.
+     */
+    static std::size_t div_and_conquer_sq2(int n) {
+        if (n <= 1) return 1;
+        std::size_t q = std::size_t(n / 2) * (n / 2);
+        return std::size_t(n) * n + q + div_and_conquer_sq2(n / 2);
+    }
+
+   private:
+    // Items live at the peak of _div_and_conquer, excluding C
+    static std::size_t div_and_conquer(
+        int m, int k, int n,
+        std::map<std::tuple<int, int, int>, std::size_t> &memo) {
+        int sz_max = std::max({m, k, n});
+        if (sz_max <= 2) return 0;
+        auto key = std::make_tuple(m, k, n);
+        auto it = memo.find(key);
+        if (it != memo.end()) return it->second;
+        std::size_t peak;
+        if (sz_max == m) {
+            peak = std::max(div_and_conquer(m / 2, k, n, memo),
+                            div_and_conquer(m - m / 2, k, n, memo));
+        } else if (sz_max == n) {
+            peak = std::max(div_and_conquer(m, k, n / 2, memo),
+                            div_and_conquer(m, k, n - n / 2, memo));
+        } else {
+            // Both partial products are allocated before either is computed
+            peak = 2 * std::size_t(m) * n +
+                   std::max(div_and_conquer(m, k / 2, n, memo),
+                            div_and_conquer(m, k - k / 2, n, memo));
+        }
+        memo[key] = peak;
+        return peak;
+    }
+};
+}  // namespace MatMulImpl
+
+#define MTP_MEMORY_CONCAT2(a, b) a##b
+#define MTP_MEMORY_CONCAT(a, b) MTP_MEMORY_CONCAT2(a, b)
+#define MTP_MEMORY_TAG(name)                                            \
+    static ::MatMulImpl::TagCounter &MTP_MEMORY_CONCAT(                  \
+        mtp_memory_counter_, __LINE__) =                                 \
+        ::MatMulImpl::MemoryAccounting::tag(name);                       \
+    ::MatMulImpl::MemoryTag MTP_MEMORY_CONCAT(mtp_memory_tag_, __LINE__)( \
+        MTP_MEMORY_CONCAT(mtp_memory_counter_, __LINE__))
+
+#endif  // MEMORY_ACCOUNTING_HPP
@@ -0,0 +1,357 @@
+/**
+ * @file MultiplyService.hpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief Client side and wire protocol of the MtpDaemon multiply service.
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * MtpDaemon owns one pool of threads for every process on the host, so
+ * processes stop competing for cores with pools of their own. A client
+ * connects to its Unix domain socket and sends requests; each carries the
+ * file descriptors of three SharedMatrix (memfd) operands, which the daemon
+ * maps, so A, B and C are never copied through the socket. The reply comes
+ * once C has been written.
+ *
+ * Wire format, per request: a Request, with SCM_RIGHTS carrying the fds of
+ * A, B and C for Op::Multiply. The daemon refuses an fd that is not sealed
+ * with F_SEAL_SHRINK: a file cut short under its mapping would fault the
+ * daemon with SIGBUS. Per reply: a Reply followed by text_len
+ * bytes of text (the error message, or the metrics as JSON for Op::Stats).
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef MULTIPLY_SERVICE_HPP
+#define MULTIPLY_SERVICE_HPP
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "BinaryFormat.hpp"
+#include "Matrixv2.hpp"
+
+namespace MatMulImpl {
+class ServiceException : std::exception {
+   public:
+    ServiceException(const std::string& s);
+    const char* what();
+
+   private:
+    std::string explain;
+};
+inline ServiceException::ServiceException(const std::string& s)
+    : explain(s) {}
+inline const char* ServiceException::what() { return explain.c_str(); }
+
+namespace MultiplyService {
+constexpr std::uint32_t magic = 0x4d545044;  // "MTPD"
+
+enum class Op : std::uint32_t { Multiply = 1, Stats = 2 };
+
+struct Request {
+    std::uint32_t magic;
+    Op op;
+    ElementType type;  // Int32, Float32 or Float64
+    std::int32_t priority;  // Higher runs first among large requests
+    std::int32_t m, k, n;
+    std::uint64_t id;
+};
+
+struct Reply {
+    std::uint64_t id;
+    std::int32_t status;  // 0 on success
+    std::uint32_t text_len;
+    std::int64_t queue_ns;  // From arrival to the start of the kernel
+    std::int64_t run_ns;    // Kernel time (of the whole batch, if batched)
+    std::int32_t batch;     // Requests in the batch it ran in
+};
+
+/**
+ * @brief $MTP_DAEMON_SOCKET, or /tmp/mtp-daemon-<uid>.sock.
+ */
+inline std::string default_socket_path() {
+    if (const char* env = std::getenv("MTP_DAEMON_SOCKET")) return env;
+    return "/tmp/mtp-daemon-" + std::to_string(getuid()) + ".sock";
+}
+
+/**
+ * @brief One sendmsg() of up to len bytes, with fds attached to the first
+ * byte if n_fds > 0 (at most 3). Never raises SIGPIPE.
+ * @return ssize_t Bytes sent, or -1 with errno set (EAGAIN when a
+ * non-blocking socket is full)
+ */
+inline ssize_t send_some(int sock, const void* data, std::size_t len,
+                         const int* fds = nullptr, int n_fds = 0) {
+    iovec iov{const_cast<void*>(data), len};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * 3)];
+    if (n_fds > 0) {
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * n_fds);
+        cmsghdr* cm = CMSG_FIRSTHDR(&msg);
+        cm->cmsg_level = SOL_SOCKET;
+        cm->cmsg_type = SCM_RIGHTS;
+        cm->cmsg_len = CMSG_LEN(sizeof(int) * n_fds);
+        std::memcpy(CMSG_DATA(cm), fds, sizeof(int) * n_fds);
+    }
+    return sendmsg(sock, &msg, MSG_NOSIGNAL);
+}
+
+/**
+ * @brief One recvmsg() of up to len bytes. Passed fds are appended to fds
+ * while *n_fds < max_fds; any others are closed. A read never goes past
+ * the end of the message that passed fds, so fds belong to the message
+ * whose first byte this call returns.
+ * @return ssize_t Bytes received, 0 at end of stream, or -1 with errno
+ * set (EAGAIN when a non-blocking socket is empty)
+ */
+inline ssize_t recv_some(int sock, void* data, std::size_t len,
+                         int* fds = nullptr, int* n_fds = nullptr,
+                         int max_fds = 3) {
+    iovec iov{data, len};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * 3)];
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    ssize_t r = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    if (r < 0) return r;
+    for (cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+        if (cm->cmsg_level != SOL_SOCKET || cm->cmsg_type != SCM_RIGHTS)
+            continue;
+        int count = int((cm->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+        for (int i = 0; i < count; i++) {
+            int fd;
+            std::memcpy(&fd, CMSG_DATA(cm) + i * sizeof(int), sizeof(int));
+            if (fds && n_fds && *n_fds < max_fds) {
+                fds[(*n_fds)++] = fd;
+            } else {
+                close(fd);
+            }
+        }
+    }
+    return r;
+}
+
+/**
+ * @brief Sends all of a buffer on a blocking socket, with fds attached to
+ * the first byte if n_fds > 0. Returns false if the peer is gone.
+ */
+inline bool send_all(int sock, const void* data, std::size_t len,
+                     const int* fds = nullptr, int n_fds = 0) {
+    const char* p = static_cast<const char*>(data);
+    while (len > 0) {
+        ssize_t w = send_some(sock, p, len, fds, n_fds);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return false;
+        p += w;
+        len -= static_cast<std::size_t>(w);
+        n_fds = 0;
+    }
+    return true;
+}
+
+/**
+ * @brief Receives exactly len bytes from a blocking socket. Up to 3 passed
+ * fds are stored in fds and counted in n_fds; any others are closed.
+ * Returns false on end of stream or error.
+ */
+inline bool recv_all(int sock, void* data, std::size_t len,
+                     int* fds = nullptr, int* n_fds = nullptr) {
+    char* p = static_cast<char*>(data);
+    if (n_fds) *n_fds = 0;
+    while (len > 0) {
+        ssize_t r = recv_some(sock, p, len, fds, n_fds);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return false;
+        p += r;
+        len -= static_cast<std::size_t>(r);
+    }
+    return true;
+}
+}  // namespace MultiplyService
+
+/**
+ * @brief A matrix in an anonymous shared memory file (memfd), so it can be
+ * handed to the daemon by file descriptor instead of by copy. The file is
+ * sealed against shrinking once sized.
+ */
+template <class T>
+class SharedMatrix {
+   public:
+    SharedMatrix(int m, int n) : m(m), n(n) {
+        bytes = std::max<std::size_t>(1, std::size_t(m) * n * sizeof(T));
+        fd_ = memfd_create("mtp-matrix", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if (fd_ < 0) fail("memfd_create");
+        if (ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+            close(fd_);
+            fail("ftruncate");
+        }
+        if (fcntl(fd_, F_ADD_SEALS, F_SEAL_SHRINK) != 0) {
+            close(fd_);
+            fail("F_ADD_SEALS");
+        }
+        void* p =
+            mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) {
+            close(fd_);
+            fail("mmap");
+        }
+        data = static_cast<T*>(p);
+    }
+    SharedMatrix(const SharedMatrix&) = delete;
+    SharedMatrix& operator=(const SharedMatrix&) = delete;
+    SharedMatrix(SharedMatrix&& o) noexcept
+        : m(o.m),
+          n(o.n),
+          data(std::exchange(o.data, nullptr)),
+          fd_(std::exchange(o.fd_, -1)),
+          bytes(o.bytes) {}
+    ~SharedMatrix() {
+        if (data) munmap(data, bytes);
+        if (fd_ >= 0) close(fd_);
+    }
+
+    /**
+     * @brief A view of the items; fill operands and read results here.
+     */
+    Matrix2<T> view() const { return Matrix2<T>::view_of(data, m, n, n); }
+    int fd() const { return fd_; }
+
+    const int m, n;
+
+   private:
+    T* data = nullptr;
+    int fd_ = -1;
+    std::size_t bytes;
+
+    [[noreturn]] static void fail(const char* what) {
+        throw ServiceException(std::string("SharedMatrix: ") + what + ": " +
+                               std::strerror(errno));
+    }
+};
+
+/**
+ * @brief One connection to MtpDaemon. Requests on a connection are
+ * answered in turn; use one client per thread to have several in flight.
+ */
+class MultiplyClient {
+   public:
+    /**
+     * @brief Timings the daemon reports for a request.
+     */
+    struct Timing {
+        std::int64_t queue_ns, run_ns;
+        int batch;
+    };
+
+    explicit MultiplyClient(
+        const std::string& path = MultiplyService::default_socket_path()) {
+        sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (sock < 0) fail("socket");
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) {
+            close(sock);
+            throw ServiceException(path + ": socket path too long");
+        }
+        std::strcpy(addr.sun_path, path.c_str());
+        if (connect(sock, reinterpret_cast<sockaddr*>(&addr),
+                    sizeof(addr)) != 0) {
+            int err = errno;
+            close(sock);
+            errno = err;
+            fail("connect " + path);
+        }
+    }
+    MultiplyClient(const MultiplyClient&) = delete;
+    MultiplyClient& operator=(const MultiplyClient&) = delete;
+    ~MultiplyClient() { close(sock); }
+
+    /**
+     * @brief C = AB, computed by the daemon in place in c.
+     * @param priority Order among large requests; higher runs first
+     * @throw BadDimensionException if the shapes do not match
+     * @throw ServiceException if the daemon fails or is unreachable
+     */
+    template <class T>
+    Timing multiply(const SharedMatrix<T>& a, const SharedMatrix<T>& b,
+                    SharedMatrix<T>& c, int priority = 0) {
+        if (a.n != b.m || c.m != a.m || c.n != b.n) {
+            std::stringstream ss;
+            ss << "MultiplyClient: cannot put a " << a.m << "x" << a.n
+               << " by " << b.m << "x" << b.n << " product into a " << c.m
+               << "x" << c.n << " matrix";
+            throw BadDimensionException(ss.str().c_str());
+        }
+        MultiplyService::Request req{MultiplyService::magic,
+                                     MultiplyService::Op::Multiply,
+                                     element_type_of<T>(),
+                                     priority,
+                                     a.m,
+                                     a.n,
+                                     b.n,
+                                     ++last_id};
+        int fds[3] = {a.fd(), b.fd(), c.fd()};
+        if (!MultiplyService::send_all(sock, &req, sizeof(req), fds, 3))
+            fail("send");
+        std::string text;
+        MultiplyService::Reply r = reply(text);
+        if (r.status != 0) throw ServiceException("daemon: " + text);
+        return {r.queue_ns, r.run_ns, r.batch};
+    }
+
+    /**
+     * @brief The daemon's metrics as JSON: queue depth, request and batch
+     * counts, latency percentiles.
+     */
+    std::string stats() {
+        MultiplyService::Request req{};
+        req.magic = MultiplyService::magic;
+        req.op = MultiplyService::Op::Stats;
+        req.id = ++last_id;
+        if (!MultiplyService::send_all(sock, &req, sizeof(req)))
+            fail("send");
+        std::string text;
+        reply(text);
+        return text;
+    }
+
+   private:
+    int sock;
+    std::uint64_t last_id = 0;
+
+    MultiplyService::Reply reply(std::string& text) {
+        MultiplyService::Reply r;
+        if (!MultiplyService::recv_all(sock, &r, sizeof(r)))
+            throw ServiceException("daemon closed the connection");
+        text.assign(r.text_len, '\0');
+        if (r.text_len && !MultiplyService::recv_all(sock, &text[0],
+                                                     r.text_len))
+            throw ServiceException("daemon closed the connection");
+        return r;
+    }
+    [[noreturn]] static void fail(const std::string& what) {
+        throw ServiceException("MultiplyClient: " + what + ": " +
+                               std::strerror(errno));
+    }
+};
+}  // namespace MatMulImpl
+
+#endif  // MULTIPLY_SERVICE_HPP
@@ -0,0 +1,269 @@
+/**
+ * @file Npy.hpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief Reader and writer for NumPy .npy files.
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * An .npy file is a short text header describing a Python dict followed by
+ * the raw array. NumPy pads the header so the data starts on a 64-byte
+ * boundary, which lets map() expose the data in place as a MappedMatrix.
+ * A Fortran-order (column-major) m x n array is, byte for byte, the
+ * C-order n x m array of its transpose; map() returns that and reports it
+ * through NpyArray::transposed instead of copying.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef NPY_HPP
+#define NPY_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "MappedMatrix.hpp"
+#include "Matrixv2.hpp"
+#include "Parallel.hpp"
+
+namespace MatMulImpl {
+/**
+ * @brief A mapped .npy array. When transposed is set, data holds A^T.
+ */
+template <class T>
+struct NpyArray {
+    MappedMatrix<T> data;
+    bool transposed;
+    std::int64_t rows() const {
+        return transposed ? data.cols() : data.rows();
+    }
+    std::int64_t cols() const {
+        return transposed ? data.rows() : data.cols();
+    }
+};
+
+class Npy {
+   public:
+    struct Header {
+        std::string descr;
+        bool fortran_order;
+        std::vector<std::int64_t> shape;
+        std::size_t data_offset;
+    };
+
+    /**
+     * @brief NumPy dtype string of a type, e.g. "<f8" for double.
+     */
+    template <class T>
+    static std::string descr_of() {
+        const char endian = little_endian() ? '<' : '>';
+        std::string kind;
+        if constexpr (std::is_same_v<T, bool>) {
+            return "|b1";
+        } else if constexpr (std::is_floating_point_v<T>) {
+            kind = "f";
+        } else if constexpr (std::is_same_v<T, std::complex<float>> ||
+                             std::is_same_v<T, std::complex<double>>) {
+            kind = "c";
+        } else if constexpr (std::is_integral_v<T>) {
+            kind = std::is_signed_v<T> ? "i" : "u";
+        } else {
+            static_assert(std::is_arithmetic_v<T>,
+                          "Npy: unsupported element type");
+        }
+        return (sizeof(T) == 1 ? '|' : endian) + kind +
+               std::to_string(sizeof(T));
+    }
+
+    /**
+     * @brief Maps a 1-D or 2-D .npy file without copying. 1-D arrays are
+     * read as a single row.
+     */
+    template <class T>
+    static NpyArray<T> map(const std::string &path, bool writable = false) {
+        Header h = read_header(path);
+        check<T>(h, path);
+        std::int64_t r = h.shape.size() == 2 ? h.shape[0] : 1;
+        std::int64_t c = h.shape.empty() ? 1 : h.shape.back();
+        bool transposed = h.fortran_order && h.shape.size() == 2;
+        if (transposed) std::swap(r, c);
+        return NpyArray<T>{
+            MappedMatrix<T>::open(path, r, c, h.data_offset, writable),
+            transposed};
+    }
+
+    /**
+     * @brief Reads a .npy file into a new row-major heap matrix.
+     */
+    template <class T>
+    static Matrix2<T> load(const std::string &path,
+                           int threads = default_thread_count()) {
+        NpyArray<T> a = map<T>(path);
+        if (a.rows() > INT32_MAX || a.cols() > INT32_MAX)
+            throw BadDimensionException(
+                "Npy::load: matrix too large for Matrix2; use map()");
+        int m = static_cast<int>(a.rows()), n = static_cast<int>(a.cols());
+        Matrix2<T> mat(m, n);
+        if (!a.transposed) {
+            parallel_for_rows(m, threads, [&](int i0, int i1, int) {
+                for (int i = i0; i < i1; i++)
+                    std::memcpy(&mat.item(i, 0), a.data.row(i),
+                                n * sizeof(T));
+            });
+        } else {
+            // Transpose in square blocks so both sides stay cache friendly
+            constexpr int bs = 64;
+            parallel_for_rows(m, threads, [&](int i0, int i1, int) {
+                for (int ib = i0; ib < i1; ib += bs) {
+                    for (int jb = 0; jb < n; jb += bs) {
+                        int i_end = std::min(i1, ib + bs);
+                        int j_end = std::min(n, jb + bs);
+                        for (int j = jb; j < j_end; j++) {
+                            const T *src = a.data.row(j);
+                            for (int i = ib; i < i_end; i++)
+                                mat.item(i, j) = src[i];
+                        }
+                    }
+                }
+            });
+        }
+        return mat;
+    }
+
+    /**
+     * @brief Writes a matrix (or view) as a C-order version 1.0 .npy file.
+     */
+    template <class T>
+    static void save(const Matrix2<T> &mat, const std::string &path) {
+        std::string dict = "{'descr': '" + descr_of<T>() +
+                           "', 'fortran_order': False, 'shape': (" +
+                           std::to_string(mat.m) + ", " +
+                           std::to_string(mat.n) + "), }";
+        // Magic (6) + version (2) + length (2) + dict + padding + '\n' is
+        // a multiple of 64
+        std::size_t total = (10 + dict.size() + 1 + 63) / 64 * 64;
+        dict.append(total - 10 - dict.size() - 1, ' ');
+        dict += '\n';
+        std::ofstream out(path, std::ios::binary);
+        if (!out) throw MatrixIOException(path + ": cannot create");
+        std::uint16_t len = static_cast<std::uint16_t>(dict.size());
+        unsigned char len_le[2] = {static_cast<unsigned char>(len & 0xFF),
+                                   static_cast<unsigned char>(len >> 8)};
+        out.write("\x93NUMPY\x01\x00", 8);
+        out.write(reinterpret_cast<const char *>(len_le), 2);
+        out.write(dict.data(), dict.size());
+        for (int i = 0; i < mat.m; i++)
+            out.write(reinterpret_cast<const char *>(&mat.citem(i, 0)),
+                      std::streamsize(mat.n) * sizeof(T));
+        if (!out) throw MatrixIOException(path + ": write failed");
+    }
+
+    /**
+     * @brief Parses the header of a .npy file (format versions 1 to 3).
+     */
+    static Header read_header(const std::string &path) {
+        std::ifstream f(path, std::ios::binary);
+        if (!f) throw MatrixIOException(path + ": cannot open");
+        unsigned char pre[12];
+        if (!f.read(reinterpret_cast<char *>(pre), 10) ||
+            std::memcmp(pre, "\x93NUMPY", 6) != 0)
+            throw MatrixIOException(path + ": not an .npy file");
+        std::size_t len, start;
+        if (pre[6] == 1) {
+            len = pre[8] | (pre[9] << 8);
+            start = 10;
+        } else if (pre[6] == 2 || pre[6] == 3) {
+            if (!f.read(reinterpret_cast<char *>(pre) + 10, 2))
+                throw MatrixIOException(path + ": truncated header");
+            len = pre[8] | (pre[9] << 8) | (pre[10] << 16) |
+                  (std::size_t(pre[11]) << 24);
+            start = 12;
+        } else {
+            throw MatrixIOException(path + ": unsupported .npy version");
+        }
+        std::string dict(len, '\0');
+        if (!f.read(&dict[0], len))
+            throw MatrixIOException(path + ": truncated header");
+
+        Header h;
+        h.data_offset = start + len;
+        h.descr = quoted_value(dict, "descr", path);
+        h.fortran_order = raw_value(dict, "fortran_order", path)
+                              .compare(0, 4, "True") == 0;
+        std::string shape = raw_value(dict, "shape", path);
+        std::size_t pos = shape.find('(');
+        if (pos == std::string::npos)
+            throw MatrixIOException(path + ": bad shape");
+        for (pos++; pos < shape.size() && shape[pos] != ')';) {
+            if (std::isdigit(static_cast<unsigned char>(shape[pos]))) {
+                std::size_t used;
+                h.shape.push_back(std::stoll(shape.substr(pos), &used));
+                pos += used;
+            } else {
+                pos++;
+            }
+        }
+        return h;
+    }
+
+   private:
+    static bool little_endian() {
+        const std::uint16_t x = 1;
+        unsigned char b;
+        std::memcpy(&b, &x, 1);
+        return b == 1;
+    }
+    static std::size_t key_end(const std::string &dict, const char *key,
+                               const std::string &path) {
+        std::string k = std::string("'") + key + "'";
+        std::size_t pos = dict.find(k);
+        if (pos == std::string::npos)
+            throw MatrixIOException(path + ": header has no " + key);
+        pos = dict.find(':', pos + k.size());
+        if (pos == std::string::npos)
+            throw MatrixIOException(path + ": bad header");
+        return dict.find_first_not_of(' ', pos + 1);
+    }
+    static std::string quoted_value(const std::string &dict, const char *key,
+                                    const std::string &path) {
+        std::size_t pos = key_end(dict, key, path);
+        char q = dict[pos];
+        std::size_t close = dict.find(q, pos + 1);
+        if ((q != '\'' && q != '"') || close == std::string::npos)
+            throw MatrixIOException(path + ": bad " + key);
+        return dict.substr(pos + 1, close - pos - 1);
+    }
+    static std::string raw_value(const std::string &dict, const char *key,
+                                 const std::string &path) {
+        std::size_t pos = key_end(dict, key, path);
+        std::size_t close = dict[pos] == '(' ? dict.find(')', pos) + 1
+                                             : dict.find_first_of(",}", pos);
+        return dict.substr(pos, close - pos);
+    }
+    template <class T>
+    static void check(const Header &h, const std::string &path) {
+        std::string want = descr_of<T>();
+        std::string got = h.descr;
+        // NumPy writes '=' for native order and '|' when order is moot
+        if (!got.empty() && (got[0] == '=' || got[0] == '|'))
+            got[0] = want[0];
+        if (got != want)
+            throw MatrixIOException(path + ": dtype " + h.descr +
+                                    " does not match " + want);
+        if (h.shape.size() > 2)
+            throw BadDimensionException(
+                "Npy: only 0-, 1- and 2-dimensional arrays are matrices");
+        if (h.data_offset % alignof(T) != 0)
+            throw MatrixIOException(path + ": data is misaligned");
+    }
+};
+}  // namespace MatMulImpl
+
+#endif  // NPY_HPP
@@ -0,0 +1,152 @@
+/**
+ * @file OutOfCore.hpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief Blocked multiplication of memory-mapped matrices larger than RAM.
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * C is produced one tile at a time. For each tile of C, the matching tiles
+ * of A and B are copied out of the mapped files into heap buffers and
+ * accumulated with Multiplication::multiply_add. A reader thread copies the
+ * tiles of the next step into a second pair of buffers while the current
+ * step is being computed, and the kernel is asked to read ahead the row
+ * segments of the tiles after that, so disk I/O overlaps with compute. Row
+ * slabs of A are evicted once their last tile has been copied out.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef OUTOFCORE_HPP
+#define OUTOFCORE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <future>
+
+#include "Algorithms.hpp"
+#include "MappedMatrix.hpp"
+
+namespace MatMulImpl {
+class OutOfCore {
+   public:
+    /**
+     * @brief Side length of the square tiles used for a memory budget.
+     * Five tiles are resident at any time: two buffers each for A and B,
+     * plus the accumulator for C.
+     * @tparam T Type of element of matrix
+     * @param memory_budget Bytes available for tile buffers
+     * @return int Tile side, at least 1
+     */
+    template <class T>
+    static int tile_size(std::size_t memory_budget) {
+        double t = std::sqrt(double(memory_budget) / (5.0 * sizeof(T)));
+        return std::max(1, static_cast<int>(std::min(t, 32768.0)));
+    }
+
+    /**
+     * @brief Computes C = AB where all three live in mapped files.
+     * @tparam T Type of element of matrix
+     * @param a Left operand (m x k)
+     * @param b Right operand (k x n)
+     * @param c Result (m x n); must be mapped writable
+     * @param memory_budget Upper bound in bytes for the tile buffers
+     * @param threads Threads used by the in-memory kernel
+     */
+    template <class T>
+    static void multiply(const MappedMatrix<T> &a, const MappedMatrix<T> &b,
+                         MappedMatrix<T> &c, std::size_t memory_budget,
+                         int threads = default_thread_count()) {
+        if (a.cols() != b.rows() || c.rows() != a.rows() ||
+            c.cols() != b.cols())
+            throw BadDimensionException(
+                "OutOfCore::multiply: C is not the size of AB, or A and B "
+                "do not conform.");
+        if (a.rows() == 0 || b.cols() == 0) return;
+        MTP_PERF_REGION("out_of_core");
+        const std::int64_t t = tile_size<T>(memory_budget);
+        const std::int64_t ti_n = (a.rows() + t - 1) / t;
+        const std::int64_t tj_n = (b.cols() + t - 1) / t;
+        const std::int64_t tk_n =
+            std::max<std::int64_t>(1, (a.cols() + t - 1) / t);
+        const std::int64_t steps = ti_n * tj_n * tk_n;
+
+        Matrix2<T> a_buf[2] = {Matrix2<T>(t, t), Matrix2<T>(t, t)};
+        Matrix2<T> b_buf[2] = {Matrix2<T>(t, t), Matrix2<T>(t, t)};
+        Matrix2<T> c_buf(t, t);
+
+        // Step s computes tile (ti, tj) of C with the tk-th slab of A and B
+        auto decode = [&](std::int64_t s) {
+            Step st;
+            st.tk = s % tk_n;
+            st.tj = (s / tk_n) % tj_n;
+            st.ti = s / (tk_n * tj_n);
+            st.i = st.ti * t, st.j = st.tj * t, st.k = st.tk * t;
+            st.m = static_cast<int>(std::min(t, a.rows() - st.i));
+            st.n = static_cast<int>(std::min(t, b.cols() - st.j));
+            st.kk = static_cast<int>(std::min(t, a.cols() - st.k));
+            return st;
+        };
+        auto load = [&](std::int64_t s, int slot) {
+            Step st = decode(s);
+            copy_in(a, st.i, st.k, st.m, st.kk, a_buf[slot]);
+            copy_in(b, st.k, st.j, st.kk, st.n, b_buf[slot]);
+        };
+        auto hint = [&](std::int64_t s) {
+            if (s >= steps) return;
+            Step st = decode(s);
+            a.prefetch(st.i, st.m, st.k, st.kk);
+            b.prefetch(st.k, st.kk, st.j, st.n);
+        };
+
+        load(0, 0);
+        hint(1);
+        std::future<void> pending;
+        for (std::int64_t s = 0; s < steps; s++) {
+            int slot = s % 2;
+            if (pending.valid()) pending.get();
+            Step st = decode(s);
+            // Step s is in the buffers now. A row slab is never read again
+            // once its last step is; B is read again for every slab of A.
+            if (st.tj == tj_n - 1 && st.tk == tk_n - 1) a.evict(st.i, st.m);
+            if (s + 1 < steps) {
+                pending =
+                    std::async(std::launch::async, load, s + 1, 1 - slot);
+                hint(s + 2);
+            }
+            auto c_tile = c_buf.sub(0, 0, st.m, st.n);
+            if (st.tk == 0) {
+                for (int i = 0; i < st.m; i++)
+                    std::fill_n(&c_tile.item(i, 0), st.n, T(0));
+            }
+            if (st.kk > 0) {
+                Multiplication::multiply_add(
+                    a_buf[slot].csub(0, 0, st.m, st.kk),
+                    b_buf[slot].csub(0, 0, st.kk, st.n), c_tile, threads);
+            }
+            if (st.tk == tk_n - 1) {
+                for (int i = 0; i < st.m; i++)
+                    std::memcpy(c.row(st.i + i) + st.j, &c_tile.citem(i, 0),
+                                st.n * sizeof(T));
+            }
+        }
+        c.sync();
+    }
+
+   private:
+    struct Step {
+        std::int64_t ti, tj, tk, i, j, k;
+        int m, n, kk;
+    };
+    template <class T>
+    static void copy_in(const MappedMatrix<T> &src, std::int64_t i,
+                        std::int64_t j, int m, int n, Matrix2<T> &dst) {
+        for (int r = 0; r < m; r++)
+            std::memcpy(&dst.item(r, 0), src.row(i + r) + j, n * sizeof(T));
+    }
+};
+}  // namespace MatMulImpl
+
+#endif  // OUTOFCORE_HPP
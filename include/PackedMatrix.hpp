@@ -0,0 +1,117 @@
+/**
+ * @file PackedMatrix.hpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief A right-hand operand packed once for many products.
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * The blocked kernel walks B in panels of kc x nc items. Read in place, a
+ * panel is kc rows scattered across B, one page or more apart when B is
+ * wide. PackedMatrix copies each panel into its own contiguous block,
+ * 64-byte aligned, with rows padded to a whole number of cache lines, so
+ * the kernel streams it with unit stride and aligned vector loads. Packing
+ * is done once; after that a product costs only the work on A and C. A
+ * packed matrix is immutable and can be used by any number of threads at
+ * once.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef PACKED_MATRIX_HPP
+#define PACKED_MATRIX_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "Matrixv2.hpp"
+#include "MemoryAccounting.hpp"
+
+namespace MatMulImpl {
+class Multiplication;
+
+template <class T>
+class PackedMatrix {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "PackedMatrix needs a trivially copyable element type");
+
+   public:
+    static constexpr int kc = 256, nc = 512;  // Panel of kc x nc items
+    static constexpr std::size_t alignment = 64;
+
+    /**
+     * @brief Packs b. b is not referenced afterwards.
+     */
+    explicit PackedMatrix(const Matrix2<T> &b) : m(b.m), n(b.n) {
+        constexpr int lanes = static_cast<int>(alignment / sizeof(T)) > 0
+                                  ? static_cast<int>(alignment / sizeof(T))
+                                  : 1;
+        panels_j = (n + nc - 1) / nc;
+        for (int jj = 0; jj < n; jj += nc) {
+            int w = std::min(nc, n - jj);
+            strides.push_back((w + lanes - 1) / lanes * lanes);
+        }
+        std::size_t total = 0;
+        for (int kk = 0; kk < m; kk += kc) {
+            int h = std::min(kc, m - kk);
+            for (int pj = 0; pj < panels_j; pj++) {
+                offsets.push_back(total);
+                std::size_t items = std::size_t(h) * strides[pj];
+                // Every panel starts on an alignment boundary
+                total += (items * sizeof(T) + alignment - 1) / alignment *
+                         alignment / sizeof(T);
+            }
+        }
+        bytes = std::max<std::size_t>(1, total) * sizeof(T);
+        mem.reset(static_cast<T *>(
+            ::operator new(bytes, std::align_val_t(alignment))));
+        MemoryAccounting::on_allocate(bytes);
+        for (int kk = 0, pk = 0; kk < m; kk += kc, pk++) {
+            int h = std::min(kc, m - kk);
+            for (int pj = 0; pj < panels_j; pj++) {
+                int jj = pj * nc, w = std::min(nc, n - jj);
+                T *p = mem.get() + offsets[pk * panels_j + pj];
+                for (int k = 0; k < h; k++) {
+                    T *row = p + std::size_t(k) * strides[pj];
+                    std::copy_n(&b.citem(kk + k, jj), w, row);
+                    std::fill(row + w, row + strides[pj], T(0));
+                }
+            }
+        }
+    }
+    PackedMatrix(const PackedMatrix &) = delete;
+    PackedMatrix &operator=(const PackedMatrix &) = delete;
+    PackedMatrix(PackedMatrix &&o) noexcept = default;
+    ~PackedMatrix() {
+        if (mem) MemoryAccounting::on_release(bytes);
+    }
+
+    Dim_t dim() const { return Dim_t({m, n}); }
+
+    const int m, n;
+
+   private:
+    friend class Multiplication;
+    struct AlignedDelete {
+        void operator()(T *p) const {
+            ::operator delete(p, std::align_val_t(alignment));
+        }
+    };
+    std::unique_ptr<T, AlignedDelete> mem;
+    std::size_t bytes = 0;
+    int panels_j = 0;
+    std::vector<std::size_t> offsets;  // Of each panel, row-major by panel
+    std::vector<int> strides;          // Row stride of each panel column
+
+    // Panel of rows [pk * kc, ...) and columns [pj * nc, ...)
+    const T *panel(int pk, int pj) const {
+        return mem.get() + offsets[pk * panels_j + pj];
+    }
+};
+}  // namespace MatMulImpl
+
+#endif  // PACKED_MATRIX_HPP
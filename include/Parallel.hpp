@@ -0,0 +1,225 @@
+/**
+ * @file Parallel.hpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief Static row partitioning, a minimal fork-join helper and a
+ * persistent thread pool for it.
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * Every multithreaded routine in the library splits its rows with
+ * partition_rows(), so memory touched by part p at allocation time is the
+ * memory worked on by part p at compute time.
+ *
+ * By default parallel_for_rows() starts its threads on every call. A
+ * long-running process can create one ThreadPool instead and install it
+ * with ThreadPool::Use; every parallel_for_rows() on that thread, in any
+ * kernel, then runs its parts on the pool's workers.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace MatMulImpl {
+/**
+ * @brief Number of worker threads the library uses by default.
+ * Honours the MATMUL_NUM_THREADS environment variable, otherwise uses the
+ * hardware concurrency.
+ * @return int A positive thread count
+ */
+inline int default_thread_count() {
+    static const int count = [] {
+        if (const char* env = std::getenv("MATMUL_NUM_THREADS")) {
+            int k = std::atoi(env);
+            if (k > 0) return k;
+        }
+        int hw = static_cast<int>(std::thread::hardware_concurrency());
+        return hw > 0 ? hw : 1;
+    }();
+    return count;
+}
+
+/**
+ * @brief Half-open range [begin, end) of rows assigned to one part.
+ */
+struct RowRange {
+    int begin, end;
+};
+
+/**
+ * @brief Splits rows into n_parts contiguous, near-equal ranges.
+ * @param rows Total number of rows
+ * @param n_parts Number of parts
+ * @param part Index of the part, in [0, n_parts)
+ * @return RowRange Rows owned by the part
+ */
+inline RowRange partition_rows(int rows, int n_parts, int part) {
+    int base = rows / n_parts, extra = rows % n_parts;
+    int begin = part * base + std::min(part, extra);
+    return {begin, begin + base + (part < extra ? 1 : 0)};
+}
+
+/**
+ * @brief A fixed set of worker threads for parallel_for_rows().
+ */
+class ThreadPool {
+   public:
+    explicit ThreadPool(int threads = default_thread_count()) {
+        threads = std::max(1, threads);
+        for (int t = 0; t < threads; t++)
+            workers.emplace_back([this] { work(); });
+    }
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        cv.notify_all();
+        for (auto&& w : workers) w.join();
+    }
+
+    int size() const { return static_cast<int>(workers.size()); }
+
+    /**
+     * @brief Runs f(p) for every p in [0, parts) on the workers and waits
+     * for all of them. Rethrows the first exception of a part. Called
+     * from one of the workers, the parts run in turn on that worker, so
+     * nested calls cannot deadlock the pool.
+     */
+    template <class F>
+    void run(int parts, F&& f) {
+        if (worker_of() == this) {
+            for (int p = 0; p < parts; p++) f(p);
+            return;
+        }
+        std::mutex done_mtx;
+        std::condition_variable done_cv;
+        int left = parts;
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (int p = 0; p < parts; p++) {
+                tasks.push_back([&, p] {
+                    std::exception_ptr e;
+                    try {
+                        f(p);
+                    } catch (...) {
+                        e = std::current_exception();
+                    }
+                    std::lock_guard<std::mutex> done(done_mtx);
+                    if (e && !error) error = e;
+                    if (--left == 0) done_cv.notify_one();
+                });
+            }
+        }
+        cv.notify_all();
+        std::unique_lock<std::mutex> lock(done_mtx);
+        done_cv.wait(lock, [&left] { return left == 0; });
+        if (error) std::rethrow_exception(error);
+    }
+
+    /**
+     * @brief The pool parallel_for_rows() uses on this thread, if any.
+     */
+    static ThreadPool* current() { return slot(); }
+
+    /**
+     * @brief Makes parallel_for_rows() on this thread run on pool until
+     * the Use goes out of scope.
+     */
+    class Use {
+       public:
+        explicit Use(ThreadPool& pool) : prev(std::exchange(slot(), &pool)) {}
+        Use(const Use&) = delete;
+        Use& operator=(const Use&) = delete;
+        ~Use() { slot() = prev; }
+
+       private:
+        ThreadPool* prev;
+    };
+
+   private:
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> tasks;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    static ThreadPool*& slot() {
+        thread_local ThreadPool* pool = nullptr;
+        return pool;
+    }
+    static const ThreadPool*& worker_of() {
+        thread_local const ThreadPool* pool = nullptr;
+        return pool;
+    }
+
+    void work() {
+        worker_of() = this;
+        slot() = this;  // Kernels called by a part stay on the pool
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+};
+
+/**
+ * @brief Runs f(begin, end, part) over a static row partitioning.
+ * Part 0 runs on the calling thread. With one part (or a single row) no
+ * thread is spawned at all. Under ThreadPool::Use the parts run on the
+ * pool instead, and the calling thread waits for them.
+ * @tparam F Callable taking (int begin, int end, int part)
+ * @param rows Number of rows to split
+ * @param n_threads Requested number of parts; clamped to [1, rows]
+ * @param f Work function
+ */
+template <class F>
+void parallel_for_rows(int rows, int n_threads, F&& f) {
+    int parts = std::max(1, std::min(n_threads, rows));
+    if (parts == 1) {
+        f(0, rows, 0);
+        return;
+    }
+    if (ThreadPool* pool = ThreadPool::current()) {
+        pool->run(parts, [&f, rows, parts](int p) {
+            RowRange r = partition_rows(rows, parts, p);
+            f(r.begin, r.end, p);
+        });
+        return;
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(parts - 1);
+    for (int p = 1; p < parts; p++) {
+        RowRange r = partition_rows(rows, parts, p);
+        workers.emplace_back([&f, r, p] { f(r.begin, r.end, p); });
+    }
+    RowRange r0 = partition_rows(rows, parts, 0);
+    f(r0.begin, r0.end, 0);
+    for (auto&& w : workers) w.join();
+}
+}  // namespace MatMulImpl
+
+#endif  // PARALLEL_HPP
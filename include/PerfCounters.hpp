@@ -0,0 +1,270 @@
+/**
+ * @file PerfCounters.hpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief Hardware performance counters through Linux perf_event_open.
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * A PerfCounters opens one counter per event for the calling thread and the
+ * threads it creates afterwards (inherit), so work handed to
+ * parallel_for_rows is counted once the workers are joined. Counters the
+ * kernel refuses (no PMU in a container, perf_event_paranoid, another OS)
+ * are simply missing: their values read as NaN and nothing is reported.
+ * Set MATMUL_PERF=0 to never open counters.
+ *
+ * Library code marks regions with MTP_PERF_REGION("name"). Regions compile
+ * to nothing unless MATMUL_PERF_REGIONS is defined (the CMake option of
+ * the same name defines it); when enabled, each region adds its counter
+ * deltas to a process-wide table read with PerfRegion::totals().
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+namespace MatMulImpl {
+/**
+ * @brief Counter values, one per PerfCounters::Event; NaN if unavailable.
+ */
+struct PerfSample {
+    static constexpr int events = 6;
+    double value[events];
+
+    PerfSample() {
+        for (double &v : value) v = std::numeric_limits<double>::quiet_NaN();
+    }
+    PerfSample &operator+=(const PerfSample &o) {
+        for (int e = 0; e < events; e++) {
+            if (std::isnan(value[e])) {
+                value[e] = o.value[e];
+            } else if (!std::isnan(o.value[e])) {
+                value[e] += o.value[e];
+            }
+        }
+        return *this;
+    }
+    PerfSample operator-(const PerfSample &o) const {
+        PerfSample d;
+        for (int e = 0; e < events; e++) d.value[e] = value[e] - o.value[e];
+        return d;
+    }
+    bool any() const {
+        for (double v : value) {
+            if (!std::isnan(v)) return true;
+        }
+        return false;
+    }
+};
+
+class PerfCounters {
+   public:
+    enum Event {
+        Cycles,
+        Instructions,
+        L1DMisses,
+        LLCMisses,
+        DTLBMisses,
+        BranchMisses
+    };
+
+    /**
+     * @brief Field name of an event in benchmark records.
+     */
+    static const char *name(int e) {
+        static const char *names[PerfSample::events] = {
+            "cycles",      "instructions", "l1d_misses",
+            "llc_misses", "dtlb_misses",  "branch_misses"};
+        return names[e];
+    }
+
+    /**
+     * @brief Opens the counters, disabled. Never throws; unavailable
+     * counters are left closed.
+     */
+    PerfCounters() {
+        for (int &fd : fds) fd = -1;
+#ifdef __linux__
+        if (const char *env = std::getenv("MATMUL_PERF")) {
+            if (std::strcmp(env, "0") == 0) return;
+        }
+        static const std::uint32_t type[PerfSample::events] = {
+            PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+            PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE};
+        static const std::uint64_t config[PerfSample::events] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            cache_miss(PERF_COUNT_HW_CACHE_L1D),
+            PERF_COUNT_HW_CACHE_MISSES,
+            cache_miss(PERF_COUNT_HW_CACHE_DTLB),
+            PERF_COUNT_HW_BRANCH_MISSES};
+        for (int e = 0; e < PerfSample::events; e++) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = type[e];
+            attr.config = config[e];
+            attr.disabled = 1;
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                               PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds[e] = static_cast<int>(
+                syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+#endif
+    }
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+    ~PerfCounters() {
+#ifdef __linux__
+        for (int fd : fds) {
+            if (fd >= 0) close(fd);
+        }
+#endif
+    }
+
+    /**
+     * @brief Whether at least one counter could be opened.
+     */
+    bool available() const {
+        for (int fd : fds) {
+            if (fd >= 0) return true;
+        }
+        return false;
+    }
+
+    void start() { control(true); }
+    void stop() { control(false); }
+
+    /**
+     * @brief Current totals since the counters were opened. Counts are
+     * scaled up when the kernel had to multiplex the counters.
+     */
+    PerfSample read() const {
+        PerfSample s;
+#ifdef __linux__
+        for (int e = 0; e < PerfSample::events; e++) {
+            std::uint64_t buf[3];
+            if (fds[e] < 0 ||
+                ::read(fds[e], buf, sizeof(buf)) != ssize_t(sizeof(buf)))
+                continue;
+            // buf = {value, time enabled, time running}
+            s.value[e] = buf[2] ? double(buf[0]) * buf[1] / buf[2] : 0.0;
+        }
+#endif
+        return s;
+    }
+
+    /**
+     * @brief The calling thread's counters, opened and started on first
+     * use. Used by PerfRegion.
+     */
+    static PerfCounters &this_thread() {
+        thread_local PerfCounters counters;
+        thread_local bool started = (counters.start(), true);
+        (void)started;
+        return counters;
+    }
+
+   private:
+    int fds[PerfSample::events];
+
+#ifdef __linux__
+    static constexpr std::uint64_t cache_miss(std::uint64_t cache) {
+        return cache | (std::uint64_t(PERF_COUNT_HW_CACHE_OP_READ) << 8) |
+               (std::uint64_t(PERF_COUNT_HW_CACHE_RESULT_MISS) << 16);
+    }
+#endif
+    void control(bool on) {
+#ifdef __linux__
+        for (int fd : fds) {
+            if (fd >= 0)
+                ioctl(fd, on ? PERF_EVENT_IOC_ENABLE : PERF_EVENT_IOC_DISABLE,
+                      0);
+        }
+#else
+        (void)on;
+#endif
+    }
+};
+
+/**
+ * @brief Adds the counter deltas of a scope to a named, process-wide total.
+ * Nested regions each count their whole extent.
+ */
+class PerfRegion {
+   public:
+    struct Total {
+        long long calls = 0;
+        PerfSample counters;
+    };
+
+    explicit PerfRegion(const char *name)
+        : name(name), begin(PerfCounters::this_thread().read()) {}
+    PerfRegion(const PerfRegion &) = delete;
+    PerfRegion &operator=(const PerfRegion &) = delete;
+    ~PerfRegion() {
+        PerfSample delta = PerfCounters::this_thread().read() - begin;
+        std::lock_guard<std::mutex> lock(mutex());
+        Total &t = table()[name];
+        t.calls++;
+        t.counters += delta;
+    }
+
+    /**
+     * @brief Snapshot of all regions so far, by name.
+     */
+    static std::map<std::string, Total> totals() {
+        std::lock_guard<std::mutex> lock(mutex());
+        return table();
+    }
+    static void reset() {
+        std::lock_guard<std::mutex> lock(mutex());
+        table().clear();
+    }
+
+   private:
+    const char *name;
+    PerfSample begin;
+
+    static std::mutex &mutex() {
+        static std::mutex m;
+        return m;
+    }
+    static std::map<std::string, Total> &table() {
+        static std::map<std::string, Total> t;
+        return t;
+    }
+};
+}  // namespace MatMulImpl
+
+#define MTP_PERF_CONCAT2(a, b) a##b
+#define MTP_PERF_CONCAT(a, b) MTP_PERF_CONCAT2(a, b)
+#ifdef MATMUL_PERF_REGIONS
+#define MTP_PERF_REGION(name) \
+    ::MatMulImpl::PerfRegion MTP_PERF_CONCAT(mtp_perf_region_, __LINE__)(name)
+#else
+#define MTP_PERF_REGION(name) ((void)0)
+#endif
+
+#endif  // PERF_COUNTERS_HPP
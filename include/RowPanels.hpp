@@ -0,0 +1,170 @@
+/**
+ * @file RowPanels.hpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief Incremental C = AB, handed out one row-panel at a time.
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * RowPanels is a single-pass range over the row-panels of C. Each step of
+ * the iteration computes the next panel with the blocked kernel, so a
+ * consumer that reduces or writes C row by row starts on the first panel
+ * after computing panel_rows rows instead of all of them, and C is never
+ * held whole:
+ *
+ *     for (auto &&panel : row_panels(a, b, 64))
+ *         write(panel.row0, panel.rows);
+ *
+ * A panel is a view of an internal buffer and is valid until the next
+ * step. With lookahead, the next panel is computed on another thread while
+ * the consumer works on the current one; that takes a second buffer.
+ * A and B are referenced, not copied, and must outlive the range.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef ROW_PANELS_HPP
+#define ROW_PANELS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <future>
+#include <iterator>
+#include <optional>
+#include <sstream>
+#include <vector>
+
+#include "Algorithms.hpp"
+#include "Matrixv2.hpp"
+
+namespace MatMulImpl {
+/**
+ * @brief Rows [row0, row0 + rows.m) of C.
+ */
+template <class T>
+struct RowPanel {
+    int row0;
+    Matrix2<T> rows;
+
+    RowPanel(int row0, Matrix2<T> rows) : row0(row0), rows(std::move(rows)) {}
+};
+
+template <class T>
+class RowPanels {
+   public:
+    /**
+     * @param a Left operand matrix (m x k)
+     * @param b Right operand matrix (k x n)
+     * @param panel_rows Rows of C per panel; the last panel may be shorter
+     * @param threads Threads of the blocked kernel for each panel
+     * @param lookahead Compute the next panel while the current one is
+     * consumed
+     */
+    RowPanels(const Matrix2<T> &a, const Matrix2<T> &b, int panel_rows = 64,
+              int threads = 1, bool lookahead = false)
+        : a(a),
+          b(b),
+          p(std::max(1, std::min(panel_rows, a.m))),
+          threads(threads),
+          lookahead(lookahead) {
+        if (a.n != b.m) {
+            std::stringstream ss;
+            ss << "RowPanels: cannot multiply a " << a.m << "x" << a.n
+               << " by a " << b.m << "x" << b.n << " matrix";
+            throw BadDimensionException(ss.str().c_str());
+        }
+        buffers.reserve(2);
+        buffers.emplace_back(p, b.n);
+        if (lookahead) buffers.emplace_back(p, b.n);
+    }
+    RowPanels(const RowPanels &) = delete;
+    RowPanels &operator=(const RowPanels &) = delete;
+
+    class iterator {
+       public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = RowPanel<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const RowPanel<T> *;
+        using reference = const RowPanel<T> &;
+
+        reference operator*() const { return *s->current; }
+        pointer operator->() const { return &*s->current; }
+        iterator &operator++() {
+            s->advance();
+            return *this;
+        }
+        bool operator==(const iterator &o) const { return done() == o.done(); }
+        bool operator!=(const iterator &o) const { return !(*this == o); }
+
+       private:
+        friend class RowPanels;
+        RowPanels *s;
+        explicit iterator(RowPanels *s) : s(s) {}
+        bool done() const { return !s || !s->current; }
+    };
+
+    /**
+     * @brief Computes the first panel. Call once: the range is single-pass.
+     */
+    iterator begin() {
+        advance();
+        return iterator(this);
+    }
+    iterator end() { return iterator(nullptr); }
+
+    int panel_count() const { return (a.m + p - 1) / p; }
+    int panel_rows() const { return p; }
+
+   private:
+    const Matrix2<T> &a, &b;
+    int p, threads;
+    bool lookahead;
+    int next_row = 0;  // First row of the next panel to hand out
+    int ready = 0;     // Buffer holding (or computing) that panel
+    std::vector<Matrix2<T>> buffers;
+    std::optional<RowPanel<T>> current;
+    // Declared after buffers so a running lookahead ends before they go
+    std::future<void> pending;
+
+    void compute(int slot, int row0) {
+        int rows = std::min(p, a.m - row0);
+        Matrix2<T> c = buffers[slot].sub(0, 0, rows, b.n);
+        for (int i = 0; i < rows; i++)
+            std::fill_n(&c.item(i, 0), b.n, T(0));
+        Multiplication::multiply_add(a.csub(row0, 0, rows, a.n), b, c,
+                                     threads);
+    }
+
+    void advance() {
+        current.reset();
+        if (next_row >= a.m) return;
+        int row0 = next_row, rows = std::min(p, a.m - row0);
+        if (pending.valid()) {
+            pending.get();
+        } else {
+            compute(ready, row0);
+        }
+        current.emplace(row0, buffers[ready].sub(0, 0, rows, b.n));
+        next_row += rows;
+        if (lookahead && next_row < a.m) {
+            int slot = 1 - ready, next = next_row;
+            pending = std::async(std::launch::async,
+                                 [this, slot, next] { compute(slot, next); });
+            ready = slot;
+        }
+    }
+};
+
+/**
+ * @brief The row-panels of AB; see RowPanels.
+ */
+template <class T>
+RowPanels<T> row_panels(const Matrix2<T> &a, const Matrix2<T> &b,
+                        int panel_rows = 64, int threads = 1,
+                        bool lookahead = false) {
+    return RowPanels<T>(a, b, panel_rows, threads, lookahead);
+}
+}  // namespace MatMulImpl
+
+#endif  // ROW_PANELS_HPP
@@ -0,0 +1,252 @@
+/**
+ * @file Storage.hpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief Allocation of Matrix2 storage with NUMA placement and huge pages.
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * By default Matrix2 storage comes from new[]. A StoragePolicy can ask for
+ * the storage to be mapped directly with mmap instead, so that its pages can
+ * be placed on NUMA nodes and optionally backed by 2 MB huge pages. Every
+ * request is best effort: on a single-node machine, on a kernel without
+ * hugetlbfs pages reserved, or on a non-Linux system the storage silently
+ * falls back to an ordinary allocation.
+ *
+ * Every allocation and release is reported to MemoryAccounting.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef STORAGE_HPP
+#define STORAGE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "MemoryAccounting.hpp"
+#include "Parallel.hpp"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace MatMulImpl {
+/**
+ * @brief Where the pages of a matrix should live.
+ */
+enum class Placement {
+    Default,     // new[]; pages land wherever the constructor runs
+    FirstTouch,  // each row block is first written by a thread of its part
+    Interleave,  // pages are spread round-robin over all nodes
+    NodeLocal    // pages prefer one node (StoragePolicy::node), and go to
+                 // others once it is full
+};
+
+/**
+ * @brief Options for allocating the storage of a Matrix2.
+ */
+struct StoragePolicy {
+    Placement placement = Placement::Default;
+    bool huge_pages = false;  // Back with 2 MB pages (MAP_HUGETLB/madvise)
+    int node = -1;            // NodeLocal target; -1 means the current node
+    int threads = 0;          // FirstTouch parts; 0 means default_thread_count
+};
+
+/**
+ * @brief Allocates and releases matrix storage according to a StoragePolicy.
+ */
+class StorageAllocator {
+   public:
+    static constexpr std::size_t huge_page_size = std::size_t(2) << 20;
+
+    /**
+     * @brief Number of NUMA nodes online, 1 when it cannot be determined.
+     */
+    static int numa_node_count() {
+        static const int count = [] {
+            std::vector<int> nodes = online_nodes();
+            return nodes.empty() ? 1 : static_cast<int>(nodes.size());
+        }();
+        return count;
+    }
+
+    /**
+     * @brief Allocates storage for an m x n row-major matrix.
+     * @tparam T Element type
+     * @param m Number of rows
+     * @param n Number of columns
+     * @param policy Placement and page size options
+     * @param mapped_bytes Set to the length of the mapping, or 0 when the
+     * storage came from new[]. Pass it back to release().
+     * @return T* The storage. Mapped storage is zero-filled; storage from
+     * new[] is default-initialized, as it always was.
+     */
+    template <class T>
+    static T* allocate(int m, int n, const StoragePolicy& policy,
+                       std::size_t& mapped_bytes) {
+        std::size_t count = static_cast<std::size_t>(m) * n;
+        mapped_bytes = 0;
+#if defined(__linux__)
+        if constexpr (std::is_trivially_default_constructible_v<T> &&
+                      std::is_trivially_destructible_v<T>) {
+            if (policy.placement != Placement::Default || policy.huge_pages) {
+                std::size_t bytes = count * sizeof(T);
+                if (void* p = map(bytes, policy, mapped_bytes)) {
+                    MemoryAccounting::on_allocate(mapped_bytes);
+                    T* mem = static_cast<T*>(p);
+                    if (policy.placement == Placement::FirstTouch)
+                        first_touch(mem, m, n, policy.threads);
+                    return mem;
+                }
+            }
+        }
+#endif
+        T* mem = new T[count];
+        MemoryAccounting::on_allocate(count * sizeof(T));
+        return mem;
+    }
+
+    /**
+     * @brief Releases storage obtained from allocate().
+     * @param mem The storage; nullptr is ignored
+     * @param count Number of items it was allocated for
+     * @param mapped_bytes As set by allocate()
+     */
+    template <class T>
+    static void release(T* mem, std::size_t count, std::size_t mapped_bytes) {
+        if (!mem) return;
+#if defined(__linux__)
+        if (mapped_bytes != 0) {
+            munmap(static_cast<void*>(mem), mapped_bytes);
+            MemoryAccounting::on_release(mapped_bytes);
+            return;
+        }
+#endif
+        delete[] mem;
+        MemoryAccounting::on_release(count * sizeof(T));
+    }
+
+   private:
+    static std::vector<int> online_nodes() {
+        // Format is a list of ranges, e.g. "0-1,3"
+        std::vector<int> nodes;
+        std::ifstream f("/sys/devices/system/node/online");
+        std::string s;
+        if (!(f >> s)) return nodes;
+        std::size_t pos = 0;
+        while (pos < s.size()) {
+            std::size_t comma = s.find(',', pos);
+            std::string part = s.substr(pos, comma - pos);
+            std::size_t dash = part.find('-');
+            int lo = std::stoi(part.substr(0, dash));
+            int hi = dash == std::string::npos
+                         ? lo
+                         : std::stoi(part.substr(dash + 1));
+            for (int k = lo; k <= hi; k++) nodes.push_back(k);
+            if (comma == std::string::npos) break;
+            pos = comma + 1;
+        }
+        return nodes;
+    }
+
+#if defined(__linux__)
+    // Policy values from <linux/mempolicy.h>; spelled out so that libnuma is
+    // not needed at build or run time.
+    static constexpr int mpol_preferred = 1;
+    static constexpr int mpol_interleave = 3;
+
+    static void* map(std::size_t bytes, const StoragePolicy& policy,
+                     std::size_t& mapped_bytes) {
+        if (bytes == 0) return nullptr;
+        void* p = MAP_FAILED;
+        std::size_t len = bytes;
+#ifdef MAP_HUGETLB
+        if (policy.huge_pages) {
+            // Explicit huge pages only work if the administrator reserved
+            // some; fall through to transparent huge pages otherwise.
+            len = round_up(bytes, huge_page_size);
+            p = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        }
+#endif
+        if (p == MAP_FAILED) {
+            std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+            len = round_up(bytes, page);
+            p = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED) return nullptr;
+#ifdef MADV_HUGEPAGE
+            if (policy.huge_pages) madvise(p, len, MADV_HUGEPAGE);
+#endif
+        }
+        mapped_bytes = len;
+        if (numa_node_count() > 1) bind(p, len, policy);
+        return p;
+    }
+
+    static void bind(void* p, std::size_t len, const StoragePolicy& policy) {
+#ifdef SYS_mbind
+        std::vector<int> nodes = online_nodes();
+        int max_node = 0;
+        for (int k : nodes) max_node = std::max(max_node, k);
+        const std::size_t word_bits = 8 * sizeof(unsigned long);
+        std::vector<unsigned long> mask(max_node / word_bits + 1, 0);
+        int mode;
+        if (policy.placement == Placement::Interleave) {
+            mode = mpol_interleave;
+            for (int k : nodes) mask[k / word_bits] |= 1UL << (k % word_bits);
+        } else if (policy.placement == Placement::NodeLocal) {
+            // Preferred rather than bound: a bound mapping that outgrows
+            // its node is not moved elsewhere but fails at page-fault time
+            mode = mpol_preferred;
+            int node = policy.node >= 0 ? policy.node : current_node();
+            if (node < 0 || node > max_node) return;
+            mask[node / word_bits] |= 1UL << (node % word_bits);
+        } else {
+            return;  // FirstTouch needs no policy; the kernel default is local
+        }
+        // Failure (e.g. seccomp in containers) only loses the placement hint
+        syscall(SYS_mbind, p, len, mode, mask.data(),
+                mask.size() * word_bits + 1, 0);
+#endif
+    }
+
+    static int current_node() {
+#ifdef SYS_getcpu
+        unsigned cpu = 0, node = 0;
+        if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0)
+            return static_cast<int>(node);
+#endif
+        return -1;
+    }
+
+    template <class T>
+    static void first_touch(T* mem, int m, int n, int threads) {
+        // Same partitioning as parallel_for_rows. Best effort: neither these
+        // threads nor the compute threads are pinned, so a row block lands
+        // on the node its compute thread runs on only if the scheduler keeps
+        // part p on the same node both times.
+        parallel_for_rows(m, threads > 0 ? threads : default_thread_count(),
+                          [=](int begin, int end, int) {
+                              std::size_t lo = std::size_t(begin) * n;
+                              std::size_t hi = std::size_t(end) * n;
+                              for (std::size_t k = lo; k < hi; k++) mem[k] = T();
+                          });
+    }
+#endif
+
+    static std::size_t round_up(std::size_t x, std::size_t to) {
+        return (x + to - 1) / to * to;
+    }
+};
+}  // namespace MatMulImpl
+
+#endif  // STORAGE_HPP
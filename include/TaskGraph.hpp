@@ -0,0 +1,182 @@
+/**
+ * @file TaskGraph.hpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief A dependency-driven task graph over tiles.
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * Tasks are added in program order, each declaring the tiles it reads and
+ * the tiles it writes. A tile is any stable address used as a name (the
+ * Matrix2 holding it, typically). Dependencies follow from the order in
+ * which tasks are added, as in a sequential program:
+ * - a task that reads a tile runs after the last task that wrote it,
+ * - a task that writes a tile runs after the last writer and after every
+ *   reader since then.
+ * run() then executes the graph on a pool of threads, starting each task
+ * as soon as its predecessors are done, with no barrier between the
+ * "levels" of the algorithm that built it.
+ *
+ * A tile must be named the same way by every task that touches it: the
+ * graph does not know that two names overlap in memory.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef TASK_GRAPH_HPP
+#define TASK_GRAPH_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Parallel.hpp"
+#include "Trace.hpp"
+
+namespace MatMulImpl {
+class TaskGraph {
+   public:
+    using Tile = const void *;
+
+    /**
+     * @brief Adds a task after every task added so far.
+     * @param name Static string naming the task in traces
+     * @param reads Tiles the task reads
+     * @param writes Tiles the task writes (or reads and writes)
+     * @param work The task
+     * @return int Index of the task
+     */
+    int add(const char *name, const std::vector<Tile> &reads,
+            const std::vector<Tile> &writes, std::function<void()> work) {
+        int id = static_cast<int>(tasks.size());
+        tasks.push_back({name, std::move(work), {}, 0});
+        for (Tile t : reads) {
+            Access &acc = access[t];
+            depend(acc.last_writer, id);
+            acc.readers.push_back(id);
+        }
+        for (Tile t : writes) {
+            Access &acc = access[t];
+            depend(acc.last_writer, id);
+            for (int r : acc.readers) depend(r, id);
+            acc.readers.clear();
+            acc.last_writer = id;
+        }
+        return id;
+    }
+
+    std::size_t size() const { return tasks.size(); }
+    /**
+     * @brief Number of dependency edges, duplicates removed.
+     */
+    std::size_t edges() const {
+        std::size_t e = 0;
+        for (auto &&t : tasks) e += t.successors.size();
+        return e;
+    }
+
+    /**
+     * @brief Runs every task, then empties the graph. The calling thread
+     * is one of the workers. Once a task throws, the tasks not yet started
+     * are skipped, and the first exception is rethrown when the running
+     * ones have finished.
+     * @param threads Number of workers
+     */
+    void run(int threads = default_thread_count()) {
+        Run r;
+        r.remaining = tasks.size();
+        for (int id = 0; id < static_cast<int>(tasks.size()); id++) {
+            if (tasks[id].waiting == 0) r.ready.push_back(id);
+        }
+        int workers = std::max(
+            1, std::min(threads, static_cast<int>(tasks.size())));
+        std::vector<std::thread> pool;
+        pool.reserve(workers - 1);
+        for (int t = 1; t < workers; t++)
+            pool.emplace_back([this, &r] { work(r); });
+        work(r);
+        for (auto &&t : pool) t.join();
+        tasks.clear();
+        access.clear();
+        if (r.error) std::rethrow_exception(r.error);
+    }
+
+   private:
+    struct Task {
+        const char *name;
+        std::function<void()> work;
+        std::vector<int> successors;
+        int waiting;  // Predecessors not yet done
+    };
+    struct Access {
+        int last_writer = -1;
+        std::vector<int> readers;  // Since the last write
+    };
+    struct Run {
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::deque<int> ready;
+        std::size_t remaining;
+        std::exception_ptr error;
+    };
+    std::vector<Task> tasks;
+    std::unordered_map<Tile, Access> access;
+
+    void depend(int before, int after) {
+        if (before < 0 || before == after) return;
+        auto &succ = tasks[before].successors;
+        // Edges into a task are added while it is being added, so a
+        // duplicate would be the last edge
+        if (!succ.empty() && succ.back() == after) return;
+        succ.push_back(after);
+        tasks[after].waiting++;
+    }
+
+    void work(Run &r) {
+        std::unique_lock<std::mutex> lock(r.mtx);
+        while (true) {
+            r.cv.wait(lock,
+                      [&r] { return r.remaining == 0 || !r.ready.empty(); });
+            if (r.ready.empty()) return;
+            int id = r.ready.front();
+            r.ready.pop_front();
+            Task &task = tasks[id];
+            bool skip = static_cast<bool>(r.error);
+            lock.unlock();
+            if (!skip) {
+                try {
+                    MTP_TRACE_SPAN(task.name, 0);
+                    task.work();
+                } catch (...) {
+                    std::lock_guard<std::mutex> guard(r.mtx);
+                    if (!r.error) r.error = std::current_exception();
+                }
+            }
+            lock.lock();
+            r.remaining--;
+            int woken = 0;
+            for (int s : task.successors) {
+                if (--tasks[s].waiting == 0) {
+                    r.ready.push_back(s);
+                    woken++;
+                }
+            }
+            if (r.remaining == 0) {
+                r.cv.notify_all();
+            } else {
+                for (int i = 0; i < woken; i++) r.cv.notify_one();
+            }
+        }
+    }
+};
+}  // namespace MatMulImpl
+
+#endif  // TASK_GRAPH_HPP
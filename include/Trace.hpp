@@ -0,0 +1,221 @@
+/**
+ * @file Trace.hpp
+ * @author aydenwong (aydenwongfs@gmail.com)
+ * @brief Span tracing of the recursive algorithms, exported as Chrome Trace
+ * Event JSON.
+ * @version 0.1
+ * @date 18-10-2026
+ *
+ * The hooks in Algorithms.hpp are macros that expand to nothing unless
+ * MATMUL_TRACE is defined, so an untraced build runs exactly the untraced
+ * code. When enabled:
+ * - MTP_TRACE_FRAME(name, m, k, n) opens one recursion level: a span
+ *   for the whole call, with the recursion depth increased inside it.
+ * - MTP_TRACE_SPAN(name, bytes) times the rest of the enclosing scope,
+ *   e.g. "add", "alloc" or "base".
+ * - MTP_TRACED(name, bytes, expr) times one expression and yields its
+ *   value.
+ * Each thread appends to its own buffer, so tracing takes no lock on the
+ * hot path. Trace::write_chrome() writes everything recorded so far; load
+ * the file in chrome://tracing or https://ui.perfetto.dev.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace MatMulImpl {
+/**
+ * @brief One complete span.
+ */
+struct TraceEvent {
+    const char *name;
+    const char *category;  // "frame" for recursion levels, else "work"
+    int depth;
+    int m, k, n;        // Operand shape of the enclosing frame
+    std::size_t bytes;  // Bytes allocated inside the span, if known
+    std::int64_t begin_ns, duration_ns;
+};
+
+class Trace {
+   public:
+    /**
+     * @brief Per-thread event buffer.
+     */
+    struct ThreadLog {
+        int tid;
+        int depth = 0;
+        int m = 0, k = 0, n = 0;
+        std::vector<TraceEvent> events;
+    };
+
+    /**
+     * @brief The calling thread's log, created on first use.
+     */
+    static ThreadLog &local() {
+        thread_local std::shared_ptr<ThreadLog> log = [] {
+            auto l = std::make_shared<ThreadLog>();
+            std::lock_guard<std::mutex> lock(registry().mtx);
+            l->tid = static_cast<int>(registry().logs.size()) + 1;
+            registry().logs.push_back(l);
+            return l;
+        }();
+        return *log;
+    }
+
+    /**
+     * @brief Nanoseconds since the first call in the process.
+     */
+    static std::int64_t now_ns() {
+        using Clock = std::chrono::steady_clock;
+        static const Clock::time_point epoch = Clock::now();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   Clock::now() - epoch)
+            .count();
+    }
+
+    /**
+     * @brief Times f() as a span and returns its value.
+     */
+    template <class F>
+    static auto span(const char *name, std::size_t bytes, F &&f)
+        -> decltype(f()) {
+        Span s(name, bytes);
+        return f();
+    }
+
+    /**
+     * @brief Writes all recorded events as Chrome Trace Event JSON.
+     * Threads must not be tracing while this runs.
+     */
+    static void write_chrome(std::ostream &os) {
+        std::lock_guard<std::mutex> lock(registry().mtx);
+        os << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+        bool first = true;
+        for (auto &&log : registry().logs) {
+            for (auto &&e : log->events) {
+                os << (first ? "\n" : ",\n") << "{\"name\": \"" << e.name
+                   << "\", \"cat\": \"" << e.category
+                   << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << log->tid
+                   << ", \"ts\": " << e.begin_ns / 1000 << '.'
+                   << three_digits(e.begin_ns % 1000)
+                   << ", \"dur\": " << e.duration_ns / 1000 << '.'
+                   << three_digits(e.duration_ns % 1000)
+                   << ", \"args\": {\"depth\": " << e.depth
+                   << ", \"m\": " << e.m << ", \"k\": " << e.k
+                   << ", \"n\": " << e.n << ", \"bytes\": " << e.bytes
+                   << "}}";
+                first = false;
+            }
+        }
+        os << "\n]}\n";
+    }
+
+    /**
+     * @brief Drops all recorded events. Threads must not be tracing.
+     */
+    static void clear() {
+        std::lock_guard<std::mutex> lock(registry().mtx);
+        for (auto &&log : registry().logs) log->events.clear();
+    }
+
+    /**
+     * @brief Times its scope.
+     */
+    class Span {
+       public:
+        Span(const char *name, std::size_t bytes,
+             const char *category = "work")
+            : name(name), category(category), bytes(bytes), begin(now_ns()) {}
+        Span(const Span &) = delete;
+        Span &operator=(const Span &) = delete;
+        ~Span() {
+            ThreadLog &log = local();
+            log.events.push_back({name, category, log.depth, log.m, log.k,
+                                  log.n, bytes, begin, now_ns() - begin});
+        }
+
+       private:
+        const char *name, *category;
+        std::size_t bytes;
+        std::int64_t begin;
+    };
+
+    /**
+     * @brief One recursion level: a span over the call that also sets the
+     * depth and operand shape seen by the spans inside it.
+     */
+    class Frame {
+       public:
+        Frame(const char *name, int m, int k, int n)
+            : level(m, k, n), span(name, 0, "frame") {}
+
+       private:
+        // Declared before span so the span is recorded at this level
+        struct Level {
+            int m, k, n;  // Shape of the enclosing frame
+            Level(int m_, int k_, int n_) {
+                ThreadLog &log = local();
+                m = log.m, k = log.k, n = log.n;
+                log.depth++;
+                log.m = m_, log.k = k_, log.n = n_;
+            }
+            ~Level() {
+                ThreadLog &log = local();
+                log.depth--;
+                log.m = m, log.k = k, log.n = n;
+            }
+        };
+        Level level;
+        Span span;
+    };
+
+   private:
+    struct Registry {
+        std::mutex mtx;
+        std::vector<std::shared_ptr<ThreadLog>> logs;
+    };
+    static Registry &registry() {
+        static Registry r;
+        return r;
+    }
+    struct ThreeDigits {
+        std::int64_t v;
+    };
+    static ThreeDigits three_digits(std::int64_t v) { return {v}; }
+    friend std::ostream &operator<<(std::ostream &os, ThreeDigits d) {
+        return os << char('0' + d.v / 100) << char('0' + d.v / 10 % 10)
+                  << char('0' + d.v % 10);
+    }
+};
+}  // namespace MatMulImpl
+
+#define MTP_TRACE_CONCAT2(a, b) a##b
+#define MTP_TRACE_CONCAT(a, b) MTP_TRACE_CONCAT2(a, b)
+#ifdef MATMUL_TRACE
+#define MTP_TRACE_FRAME(name, m, k, n)                                    \
+    ::MatMulImpl::Trace::Frame MTP_TRACE_CONCAT(mtp_trace_frame_, __LINE__)( \
+        name, m, k, n)
+#define MTP_TRACE_SPAN(name, bytes) \
+    ::MatMulImpl::Trace::Span MTP_TRACE_CONCAT(mtp_trace_span_, __LINE__)( \
+        name, bytes)
+#define MTP_TRACED(name, bytes, expr) \
+    ::MatMulImpl::Trace::span(name, bytes, [&] { return expr; })
+#else
+#define MTP_TRACE_FRAME(name, m, k, n) ((void)0)
+#define MTP_TRACE_SPAN(name, bytes) ((void)0)
+#define MTP_TRACED(name, bytes, expr) (expr)
+#endif
+
+#endif  // TRACE_HPP
@@ -3,27 +3,10 @@
 #include <sstream>
 
 namespace MatMulImpl {
-BadDimensionException::BadDimensionException() : explain("Bad dimension") {}
-BadDimensionException::BadDimensionException(const char* s) : explain(s) {}
-BadDimensionException::BadDimensionException(const Dim_t& a) {
-    std::stringstream ss;
-    ss << "Invalid dimension: (" << a.first << ", " << a.second << ")";
-    explain = ss.str();
-}
-BadDimensionException::BadDimensionException(const Dim_t& a, const Dim_t& b) {
-    std::stringstream ss;
-    ss << "Bad dimension: (" << a.first << ", " << a.second << ") vs ("
-       << b.first << ", " << b.second << ")";
-    explain = ss.str();
-}
-const char* BadDimensionException::what() const noexcept {
-    return explain.c_str();
-}
-
 OutOfBoundsException::OutOfBoundsException() : explain("Out of bounds") {}
 OutOfBoundsException::OutOfBoundsException(const char* s) : explain(s) {}
-OutOfBoundsException::OutOfBoundsException(int i, int j, Dim_t& dim,
-                                           Dim_t& main_dim) {
+OutOfBoundsException::OutOfBoundsException(int i, int j, const Dim_t& dim,
+                                           const Dim_t& main_dim) {
     std::stringstream ss;
     ss << "Out of bounds: " << std::endl
        << "Index: (" << i << ", " << j << ")" << std::endl
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Algorithms.hpp"
+#include "Async.hpp"
+#include "Generator.hpp"
+#include "Matrixv2.hpp"
+
+namespace {
+using MatMulImpl::Executor;
+using MatMulImpl::Matrix2;
+using MatMulImpl::MatrixGenerator;
+using MatMulImpl::Multiplication;
+
+// Holds the only worker of ex until open(), so that requests pile up
+class Gate {
+   public:
+    explicit Gate(Executor &ex) : opened(promise.get_future().share()) {
+        auto wait = opened;
+        ex.post([wait] { wait.wait(); });
+    }
+    ~Gate() { open(); }
+    void open() {
+        if (!done) promise.set_value();
+        done = true;
+    }
+
+   private:
+    std::promise<void> promise;
+    std::shared_future<void> opened;
+    bool done = false;
+};
+
+void expect_equal(const Matrix2<double> &got, const Matrix2<double> &want) {
+    ASSERT_EQ(got.dim(), want.dim());
+    for (int i = 0; i < want.m; i++)
+        for (int j = 0; j < want.n; j++)
+            ASSERT_NEAR(got.citem(i, j), want.citem(i, j),
+                        1e-12 * (1 + std::abs(want.citem(i, j))))
+                << i << ", " << j;
+}
+}  // namespace
+
+TEST(ASYNC, SMALL_PRODUCTS_WITH_A_SHARED_B) {
+    // Three and a bit groups of Executor::max_batch, all pending at once
+    const int count = 3 * Executor::max_batch + 7;
+    Executor ex(1);
+    Gate gate(ex);
+    auto b = std::make_shared<const Matrix2<double>>(
+        MatrixGenerator<double>::random_fill_seeded(12, 9, 1));
+    std::vector<std::shared_ptr<const Matrix2<double>>> as;
+    std::vector<std::future<Matrix2<double>>> futures;
+    for (int i = 0; i < count; i++) {
+        as.push_back(std::make_shared<const Matrix2<double>>(
+            MatrixGenerator<double>::random_fill_seeded(1 + i % 5, 12,
+                                                        100 + i)));
+        futures.push_back(MatMulImpl::multiply_async(as.back(), b, 1, ex));
+    }
+    gate.open();
+    for (int i = 0; i < count; i++)
+        expect_equal(futures[i].get(), Multiplication::blocked(*as[i], *b, 1));
+}
+
+TEST(ASYNC, BATCH_LARGER_THAN_MAX_BATCH) {
+    const int count = 2 * Executor::max_batch + 3;
+    Executor ex(2);
+    std::vector<std::pair<Matrix2<double>, Matrix2<double>>> pairs;
+    std::vector<Matrix2<double>> want;
+    for (int i = 0; i < count; i++) {
+        auto a = MatrixGenerator<double>::random_fill_seeded(3, 4 + i % 3, i);
+        auto b = MatrixGenerator<double>::random_fill_seeded(4 + i % 3, 5,
+                                                             1000 + i);
+        want.push_back(Multiplication::blocked(a, b, 1));
+        pairs.emplace_back(std::move(a), std::move(b));
+    }
+    auto futures = MatMulImpl::multiply_batch(std::move(pairs), ex);
+    ASSERT_EQ(int(futures.size()), count);
+    for (int i = 0; i < count; i++) expect_equal(futures[i].get(), want[i]);
+}
+
+TEST(ASYNC, MISMATCHED_SHAPES_THROW_THROUGH_THE_FUTURE) {
+    Executor ex(1);
+    auto a = MatrixGenerator<double>::random_fill_seeded(3, 4, 1);
+    auto b = MatrixGenerator<double>::random_fill_seeded(5, 2, 2);
+    auto by_value = MatMulImpl::multiply_async(Matrix2<double>(a),
+                                               Matrix2<double>(b), 1, ex);
+    auto shared = MatMulImpl::multiply_async(
+        std::make_shared<const Matrix2<double>>(a),
+        std::make_shared<const Matrix2<double>>(b), 1, ex);
+    EXPECT_THROW(by_value.get(), MatMulImpl::BadDimensionException);
+    EXPECT_THROW(shared.get(), MatMulImpl::BadDimensionException);
+}
+
+TEST(ASYNC, VIEWS_ARE_COPIED_AT_SUBMISSION) {
+    Executor ex(1);
+    Gate gate(ex);
+    // A view into memory the request does not own, overwritten before the
+    // product runs
+    const int m = 6, k = 5, n = 4, stride = 8;
+    std::vector<double> items(m * stride);
+    for (int i = 0; i < int(items.size()); i++) items[i] = i % 7 - 3;
+    auto a = Matrix2<double>::view_of(items.data(), m, k, stride);
+    auto b = MatrixGenerator<double>::random_fill_seeded(k, n, 3);
+    Matrix2<double> want = Multiplication::blocked(a, b, 1);
+    // Moved, so that the request receives the view itself
+    auto fut = MatMulImpl::multiply_async(std::move(a), std::move(b), 1, ex);
+    std::fill(items.begin(), items.end(), 1e6);
+    gate.open();
+    expect_equal(fut.get(), want);
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+#include "ComplexMatrix.hpp"
+#include "Generator.hpp"
+#include "Matrixv2.hpp"
+
+namespace {
+using MatMulImpl::ComplexMatrix2;
+using MatMulImpl::ComplexMultiplication;
+using MatMulImpl::Matrix2;
+using MatMulImpl::MatrixGenerator;
+
+ComplexMatrix2<double> random_complex(int m, int n, std::uint64_t seed) {
+    return ComplexMatrix2<double>::of(
+        MatrixGenerator<double>::random_fill_seeded(m, n, seed),
+        MatrixGenerator<double>::random_fill_seeded(m, n, seed + 1000));
+}
+
+// Largest difference between two products, relative to the largest item
+double max_rel_diff(const ComplexMatrix2<double> &x,
+                    const ComplexMatrix2<double> &y) {
+    double d = 0, top = 0;
+    for (int i = 0; i < x.m; i++)
+        for (int j = 0; j < x.n; j++) {
+            d = std::max(d, std::abs(x.citem(i, j) - y.citem(i, j)));
+            top = std::max(top, std::abs(y.citem(i, j)));
+        }
+    return top > 0 ? d / top : d;
+}
+}  // namespace
+
+TEST(COMPLEX_MULTIPLY, THREE_M_MATCHES_FOUR_M) {
+    // Shapes off every block size, and a single row and column
+    const int shapes[][3] = {{1, 1, 1}, {37, 53, 29}, {130, 70, 97}};
+    for (const auto &s : shapes) {
+        auto a = random_complex(s[0], s[1], 1);
+        auto b = random_complex(s[1], s[2], 2);
+        auto c3 = ComplexMultiplication::multiply_3m(a, b, 2);
+        auto c4 = ComplexMultiplication::multiply_4m(a, b, 2);
+        ASSERT_EQ(c3.dim(), c4.dim());
+        EXPECT_LT(max_rel_diff(c3, c4), 1e-12)
+            << s[0] << "x" << s[1] << "x" << s[2];
+    }
+}
+
+TEST(COMPLEX_MULTIPLY, FOUR_M_MATCHES_INTERLEAVED) {
+    const int m = 19, k = 23, n = 17;
+    auto a = random_complex(m, k, 3);
+    auto b = random_complex(k, n, 4);
+    auto za = a.to_interleaved(), zb = b.to_interleaved();
+    ComplexMatrix2<double> expected(m, n);
+    for (int i = 0; i < m; i++)
+        for (int j = 0; j < n; j++) {
+            std::complex<double> sum = 0;
+            for (int p = 0; p < k; p++) sum += za.citem(i, p) * zb.citem(p, j);
+            expected.set(i, j, sum);
+        }
+    EXPECT_LT(max_rel_diff(ComplexMultiplication::multiply_4m(a, b, 1),
+                           expected),
+              1e-13);
+}
+
+TEST(COMPLEX_MULTIPLY, STRASSEN_KERNEL_AND_VIEWS) {
+    // Views with a row stride, multiplied with both kernels of 3M
+    auto big_a = random_complex(100, 100, 5);
+    auto big_b = random_complex(100, 100, 6);
+    auto a = big_a.sub(3, 7, 64, 64);
+    auto b = big_b.sub(11, 2, 64, 64);
+    auto c4 = ComplexMultiplication::multiply_4m(a, b, 2);
+    EXPECT_LT(max_rel_diff(ComplexMultiplication::multiply_3m(a, b, 2), c4),
+              1e-12);
+    const auto strassen = ComplexMultiplication::Kernel::Strassen;
+    EXPECT_LT(
+        max_rel_diff(ComplexMultiplication::multiply_3m(a, b, 2, strassen), c4),
+        1e-11);
+}
+
+TEST(COMPLEX_MULTIPLY, MISMATCHED_SHAPES_THROW) {
+    auto a = random_complex(4, 5, 7);
+    auto b = random_complex(6, 3, 8);
+    EXPECT_THROW(ComplexMultiplication::multiply_3m(a, b, 1),
+                 MatMulImpl::BadDimensionException);
+    EXPECT_THROW(ComplexMultiplication::multiply_4m(a, b, 1),
+                 MatMulImpl::BadDimensionException);
+}
@@ -0,0 +1,96 @@
+#include <signal.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+#include "Algorithms.hpp"
+#include "Distributed.hpp"
+#include "Matrixv2.hpp"
+
+namespace {
+using MatMulImpl::Distributed;
+using MatMulImpl::Matrix2;
+
+// Small items, so that every product is exact in int
+Matrix2<int> small_ints(int m, int n, int salt) {
+    Matrix2<int> x(m, n);
+    for (int i = 0; i < m; i++)
+        for (int j = 0; j < n; j++)
+            x.item(i, j) = (i * 7 + j * 3 + salt) % 11 - 5;
+    return x;
+}
+
+// An item whose product fails in every process but the one that made it:
+// the forked workers fail, rank 0 does not
+pid_t parent_pid = 0;
+bool crash_in_worker = false;
+
+struct Faulty {
+    double v;
+    Faulty() = default;
+    Faulty(int x) : v(x) {}
+    Faulty(double x) : v(x) {}
+    Faulty operator*(const Faulty &o) const {
+        if (getpid() != parent_pid) {
+            if (crash_in_worker) raise(SIGKILL);
+            throw std::runtime_error("worker failed");
+        }
+        return Faulty{v * o.v};
+    }
+    Faulty &operator+=(const Faulty &o) {
+        v += o.v;
+        return *this;
+    }
+};
+
+Matrix2<Faulty> faulty(int m, int n) {
+    Matrix2<Faulty> x(m, n);
+    for (int i = 0; i < m; i++)
+        for (int j = 0; j < n; j++) x.item(i, j) = Faulty(i + j);
+    return x;
+}
+}  // namespace
+
+TEST(DISTRIBUTED, MATCHES_BLOCKED) {
+    // Shapes that do not divide by the grid, and on a 3 x 3 grid ones that
+    // leave some ranks with empty tiles of A, B or C
+    const int shapes[][3] = {{10, 11, 13}, {1, 1, 1},  {1, 5, 7},
+                             {7, 1, 5},    {5, 2, 3},  {2, 9, 1},
+                             {64, 31, 17}};
+    for (int grid : {1, 2, 3}) {
+        for (const auto &s : shapes) {
+            Matrix2<int> a = small_ints(s[0], s[1], 1);
+            Matrix2<int> b = small_ints(s[1], s[2], 2);
+            Matrix2<int> want = MatMulImpl::Multiplication::blocked(a, b, 1);
+            Matrix2<int> got = Distributed::multiply(a, b, grid, 1);
+            ASSERT_EQ(got.dim(), want.dim());
+            for (int i = 0; i < want.m; i++)
+                for (int j = 0; j < want.n; j++)
+                    ASSERT_EQ(got.citem(i, j), want.citem(i, j))
+                        << "grid " << grid << ", " << s[0] << "x" << s[1]
+                        << "x" << s[2] << " at " << i << ", " << j;
+        }
+    }
+}
+
+TEST(DISTRIBUTED, MISMATCHED_SHAPES_THROW) {
+    EXPECT_THROW(Distributed::multiply(small_ints(3, 4, 0),
+                                       small_ints(5, 2, 0), 2),
+                 MatMulImpl::BadDimensionException);
+}
+
+TEST(DISTRIBUTED, FAILING_WORKER_THROWS) {
+    parent_pid = getpid();
+    crash_in_worker = false;
+    EXPECT_THROW(Distributed::multiply(faulty(9, 8), faulty(8, 7), 2),
+                 MatMulImpl::DistributedException);
+}
+
+TEST(DISTRIBUTED, CRASHING_WORKER_THROWS) {
+    parent_pid = getpid();
+    crash_in_worker = true;
+    EXPECT_THROW(Distributed::multiply(faulty(9, 8), faulty(8, 7), 3),
+                 MatMulImpl::DistributedException);
+}
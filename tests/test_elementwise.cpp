@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <functional>
+
+#include "Elementwise.hpp"
+#include "Generator.hpp"
+#include "Matrixv2.hpp"
+
+namespace {
+using MatMulImpl::Elementwise;
+using MatMulImpl::Matrix2;
+using MatMulImpl::MatrixGenerator;
+
+template <class T>
+bool same_bits(T x, T y) {
+    return std::memcmp(&x, &y, sizeof(T)) == 0;
+}
+}  // namespace
+
+TEST(ELEMENTWISE, SUM_IS_SAME_FOR_ANY_THREAD_COUNT) {
+    // Well above parallel_threshold, with a row length that is not a
+    // multiple of the lanes and chunks that end mid-matrix
+    auto f = MatrixGenerator<float>::random_fill_seeded(700, 333, 1);
+    auto d = MatrixGenerator<double>::random_fill_seeded(700, 333, 2);
+    const float f1 = Elementwise::sum(f, 1);
+    const double d1 = Elementwise::sum(d, 1);
+    for (int threads : {2, 3, 4, 7}) {
+        EXPECT_TRUE(same_bits(Elementwise::sum(f, threads), f1)) << threads;
+        EXPECT_TRUE(same_bits(Elementwise::sum(d, threads), d1)) << threads;
+        EXPECT_TRUE(same_bits(Elementwise::dot(f, f, threads),
+                              Elementwise::dot(f, f, 1)))
+            << threads;
+        EXPECT_TRUE(same_bits(Elementwise::norm_fro(d, threads),
+                              Elementwise::norm_fro(d, 1)))
+            << threads;
+    }
+    // A view reduces like a matrix holding the same items
+    auto v = f.sub(10, 20, 500, 300);
+    Matrix2<float> copy(500, 300);
+    for (int i = 0; i < 500; i++)
+        for (int j = 0; j < 300; j++) copy.item(i, j) = f.citem(i + 10, j + 20);
+    EXPECT_TRUE(same_bits(Elementwise::sum(v, 4), Elementwise::sum(copy, 1)));
+}
+
+TEST(ELEMENTWISE, ZIP_INTO_MAY_ALIAS_ITS_INPUTS) {
+    const int m = 300, n = 250;  // Threaded
+    auto a = MatrixGenerator<int>::random_fill_seeded(m, n, 3);
+    auto b = MatrixGenerator<int>::random_fill_seeded(m, n, 4);
+    auto diff = [](int x, int y) { return x - y; };
+    Matrix2<int> want = Elementwise::zip(a, b, diff, 1);
+
+    // out is a, then out is b
+    Matrix2<int> x(a), y(b);
+    Elementwise::zip_into(x, b, diff, x, 4);
+    Elementwise::zip_into(a, y, diff, y, 4);
+    // out is both operands
+    Matrix2<int> z(a);
+    Elementwise::zip_into(z, z, diff, z, 4);
+    for (int i = 0; i < m; i++)
+        for (int j = 0; j < n; j++) {
+            ASSERT_EQ(x.citem(i, j), want.citem(i, j)) << i << ", " << j;
+            ASSERT_EQ(y.citem(i, j), want.citem(i, j)) << i << ", " << j;
+            ASSERT_EQ(z.citem(i, j), 0) << i << ", " << j;
+        }
+}
+
+TEST(ELEMENTWISE, ZIP_INTO_A_SHARED_COPY_LEAVES_THE_INPUT) {
+    // out shares its storage with a until it is written
+    auto a = MatrixGenerator<int>::random_fill_seeded(300, 250, 5);
+    Matrix2<int> keep(a.m, a.n);
+    for (int i = 0; i < a.m; i++)
+        for (int j = 0; j < a.n; j++) keep.item(i, j) = a.citem(i, j);
+    Matrix2<int> out(a);
+    Elementwise::zip_into(a, a, std::plus<int>(), out, 4);
+    for (int i = 0; i < a.m; i++)
+        for (int j = 0; j < a.n; j++) {
+            ASSERT_EQ(a.citem(i, j), keep.citem(i, j)) << i << ", " << j;
+            ASSERT_EQ(out.citem(i, j), 2 * keep.citem(i, j))
+                << i << ", " << j;
+        }
+}
+
+TEST(ELEMENTWISE, MISMATCHED_SHAPES_THROW) {
+    Matrix2<int> a(3, 4), b(4, 3), out(3, 4);
+    EXPECT_THROW(Elementwise::zip_into(a, b, std::plus<int>(), out, 1),
+                 MatMulImpl::BadDimensionException);
+    EXPECT_THROW(Elementwise::dot(a, b, 1), MatMulImpl::BadDimensionException);
+}
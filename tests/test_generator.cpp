@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include "Generator.hpp"
+#include "Matrixv2.hpp"
+
+namespace {
+using MatMulImpl::Matrix2;
+using MatMulImpl::MatrixGenerator;
+
+// Tile (row0, col0, m x n) of the seeded matrix, filled on its own
+template <class T>
+void expect_tile_matches(const Matrix2<T> &whole, int row0, int col0, int m,
+                         int n, std::uint64_t seed) {
+    Matrix2<T> tile(m, n);
+    MatrixGenerator<T>::fill_tile(tile, seed, row0, col0);
+    for (int i = 0; i < m; i++)
+        for (int j = 0; j < n; j++)
+            ASSERT_EQ(tile.citem(i, j), whole.citem(row0 + i, col0 + j))
+                << "tile at " << row0 << ", " << col0 << ": " << i << ", "
+                << j;
+}
+}  // namespace
+
+TEST(GENERATOR, SEEDED_IS_REPRODUCIBLE) {
+    auto a = MatrixGenerator<double>::random_fill_seeded(50, 70, 42);
+    auto b = MatrixGenerator<double>::random_fill_seeded(50, 70, 42);
+    auto c = MatrixGenerator<double>::random_fill_seeded(50, 70, 43);
+    int differ = 0;
+    for (int i = 0; i < a.m; i++)
+        for (int j = 0; j < a.n; j++) {
+            EXPECT_EQ(a.citem(i, j), b.citem(i, j));
+            differ += a.citem(i, j) != c.citem(i, j);
+        }
+    EXPECT_GT(differ, a.m * a.n / 2);
+}
+
+TEST(GENERATOR, FILL_TILE_MATCHES_WHOLE) {
+    const std::uint64_t seed = 0x1234;
+    auto d = MatrixGenerator<double>::random_fill_seeded(90, 130, seed);
+    auto f = MatrixGenerator<float>::random_fill_seeded(90, 130, seed);
+    auto k = MatrixGenerator<int>::random_fill_seeded(90, 130, seed);
+    // Offsets inside and across Philox blocks, and a tile ending at the edge
+    const int tiles[][4] = {
+        {0, 0, 90, 130}, {0, 0, 16, 16}, {5, 3, 17, 29},
+        {31, 15, 40, 1}, {89, 127, 1, 3}, {40, 64, 50, 66}};
+    for (const auto &t : tiles) {
+        expect_tile_matches(d, t[0], t[1], t[2], t[3], seed);
+        expect_tile_matches(f, t[0], t[1], t[2], t[3], seed);
+        expect_tile_matches(k, t[0], t[1], t[2], t[3], seed);
+    }
+}
+
+TEST(GENERATOR, FILL_TILE_INTO_VIEW_THREADED) {
+    // Large enough for the threaded path; the view has a row stride
+    const std::uint64_t seed = 7;
+    auto whole = MatrixGenerator<double>::random_fill_seeded(600, 500, seed);
+    Matrix2<double> big(700, 700);
+    auto tile = big.sub(50, 100, 400, 300);
+    MatMulImpl::CounterFill::fill(tile, seed, 100, 150,
+                                  MatMulImpl::UniformRealMap(), 4);
+    for (int i = 0; i < 400; i++)
+        for (int j = 0; j < 300; j++)
+            ASSERT_EQ(tile.citem(i, j), whole.citem(100 + i, 150 + j));
+}
@@ -0,0 +1,225 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "BinaryFormat.hpp"
+#include "MatrixMarket.hpp"
+#include "Matrixv2.hpp"
+#include "Npy.hpp"
+
+namespace {
+using MatMulImpl::Matrix2;
+
+std::string temp_path(const char *name) {
+    return ::testing::TempDir() + "matmul_" + name;
+}
+
+// Distinct, exactly representable values
+Matrix2<double> numbered(int m, int n) {
+    Matrix2<double> mat(m, n);
+    for (int i = 0; i < m; i++)
+        for (int j = 0; j < n; j++) mat.item(i, j) = i * 1000 + j + 0.25;
+    return mat;
+}
+
+void write_text(const std::string &path, const std::string &text) {
+    std::ofstream out(path, std::ios::binary);
+    out << text;
+}
+
+template <class T>
+void expect_same(const Matrix2<T> &x, const Matrix2<T> &y) {
+    ASSERT_EQ(x.m, y.m);
+    ASSERT_EQ(x.n, y.n);
+    for (int i = 0; i < x.m; i++)
+        for (int j = 0; j < x.n; j++)
+            EXPECT_EQ(x.citem(i, j), y.citem(i, j)) << i << ", " << j;
+}
+}  // namespace
+
+TEST(BINARY_FORMAT, ROUND_TRIP) {
+    std::string path = temp_path("round_trip.bin");
+    Matrix2<double> a = numbered(37, 53);
+    MatMulImpl::BinaryFormat::save(a, path);
+    expect_same(MatMulImpl::BinaryFormat::load<double>(path), a);
+
+    auto mapped = MatMulImpl::BinaryFormat::map<double>(path, true);
+    EXPECT_EQ(mapped.rows(), 37);
+    EXPECT_EQ(mapped.cols(), 53);
+    expect_same(mapped.view(), a);
+    std::remove(path.c_str());
+}
+
+TEST(BINARY_FORMAT, ROUND_TRIP_VIEW) {
+    std::string path = temp_path("round_trip_view.bin");
+    Matrix2<double> a = numbered(20, 30);
+    const Matrix2<double> block = a.csub(3, 5, 10, 12);
+    MatMulImpl::BinaryFormat::save(block, path);
+    expect_same(MatMulImpl::BinaryFormat::load<double>(path), block);
+    std::remove(path.c_str());
+}
+
+TEST(BINARY_FORMAT, WRONG_TYPE_AND_CHECKSUM) {
+    std::string path = temp_path("checksum.bin");
+    MatMulImpl::BinaryFormat::save(numbered(8, 8), path);
+    EXPECT_THROW(MatMulImpl::BinaryFormat::load<float>(path),
+                 MatMulImpl::MatrixIOException);
+    {
+        auto mapped = MatMulImpl::BinaryFormat::map<double>(path, false,
+                                                            true);
+        mapped.row(4)[4] = -1;
+        mapped.sync(true);
+    }
+    EXPECT_THROW(MatMulImpl::BinaryFormat::load<double>(path),
+                 MatMulImpl::MatrixIOException);
+    MatMulImpl::BinaryFormat::seal(path);
+    EXPECT_EQ(MatMulImpl::BinaryFormat::load<double>(path).citem(4, 4), -1);
+    std::remove(path.c_str());
+}
+
+TEST(NPY, ROUND_TRIP_C_ORDER) {
+    std::string path = temp_path("c_order.npy");
+    Matrix2<double> a = numbered(70, 45);
+    MatMulImpl::Npy::save(a, path);
+    expect_same(MatMulImpl::Npy::load<double>(path), a);
+    EXPECT_THROW(MatMulImpl::Npy::load<float>(path),
+                 MatMulImpl::MatrixIOException);
+    std::remove(path.c_str());
+}
+
+TEST(NPY, LOAD_FORTRAN_ORDER) {
+    // Written by hand, as np.save of np.asfortranarray(a) would
+    const int m = 70, n = 45;
+    Matrix2<double> a = numbered(m, n);
+    std::string dict =
+        "{'descr': '<f8', 'fortran_order': True, 'shape': (70, 45), }";
+    // Pad so that the data starts on a 64-byte boundary
+    std::size_t total = (10 + dict.size() + 1 + 63) / 64 * 64;
+    dict.append(total - 10 - dict.size() - 1, ' ');
+    dict += '\n';
+    std::string path = temp_path("fortran_order.npy");
+    {
+        std::ofstream out(path, std::ios::binary);
+        unsigned char len[2] = {static_cast<unsigned char>(dict.size()),
+                                static_cast<unsigned char>(dict.size() >> 8)};
+        out.write("\x93NUMPY\x01\x00", 8);
+        out.write(reinterpret_cast<const char *>(len), 2);
+        out << dict;
+        for (int j = 0; j < n; j++)
+            for (int i = 0; i < m; i++)
+                out.write(reinterpret_cast<const char *>(&a.citem(i, j)),
+                          sizeof(double));
+    }
+    auto mapped = MatMulImpl::Npy::map<double>(path);
+    EXPECT_TRUE(mapped.transposed);
+    EXPECT_EQ(mapped.rows(), m);
+    EXPECT_EQ(mapped.cols(), n);
+    expect_same(MatMulImpl::Npy::load<double>(path, 2), a);
+    std::remove(path.c_str());
+}
+
+TEST(MATRIX_MARKET, ROUND_TRIP_ARRAY) {
+    std::string path = temp_path("array.mtx");
+    Matrix2<double> a = numbered(33, 21);
+    MatMulImpl::MatrixMarket::write(a, path);
+    auto banner = MatMulImpl::MatrixMarket::read_banner(path);
+    EXPECT_EQ(banner.format, MatMulImpl::MatrixMarket::Format::Array);
+    expect_same(MatMulImpl::MatrixMarket::read<double>(path, 3), a);
+    std::remove(path.c_str());
+}
+
+TEST(MATRIX_MARKET, ROUND_TRIP_COORDINATE) {
+    std::string path = temp_path("coordinate.mtx");
+    Matrix2<double> a(40, 25);
+    for (int i = 0; i < a.m; i++)
+        for (int j = 0; j < a.n; j++)
+            a.item(i, j) = (i * 7 + j) % 5 == 0 ? i - j + 0.5 : 0;
+    MatMulImpl::MatrixMarket::write(
+        a, path, MatMulImpl::MatrixMarket::Format::Coordinate, 3);
+    auto banner = MatMulImpl::MatrixMarket::read_banner(path);
+    EXPECT_EQ(banner.format, MatMulImpl::MatrixMarket::Format::Coordinate);
+    EXPECT_EQ(banner.entries, 200);
+    expect_same(MatMulImpl::MatrixMarket::read<double>(path, 3), a);
+    std::remove(path.c_str());
+}
+
+TEST(MATRIX_MARKET, READ_SYMMETRIC) {
+    std::string path = temp_path("symmetric.mtx");
+    {
+        std::ofstream out(path);
+        out << "%%MatrixMarket matrix coordinate real symmetric\n"
+            << "% lower triangle only\n"
+            << "3 3 4\n"
+            << "1 1 2.5\n"
+            << "2 1 -1\n"
+            << "3 2 4\n"
+            << "3 3 7\n";
+    }
+    Matrix2<double> a = MatMulImpl::MatrixMarket::read<double>(path);
+    const double want[3][3] = {{2.5, -1, 0}, {-1, 0, 4}, {0, 4, 7}};
+    ASSERT_EQ(a.m, 3);
+    ASSERT_EQ(a.n, 3);
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++) EXPECT_EQ(a.citem(i, j), want[i][j]);
+    std::remove(path.c_str());
+}
+
+TEST(MATRIX_MARKET, SYMMETRIC_MUST_BE_SQUARE) {
+    // Mirroring (1, 4) would write row 4 of a 2-row matrix
+    std::string path = temp_path("symmetric_wide.mtx");
+    write_text(path,
+               "%%MatrixMarket matrix coordinate real symmetric\n"
+               "2 4 1\n"
+               "1 4 7.5\n");
+    EXPECT_THROW(MatMulImpl::MatrixMarket::read<double>(path),
+                 MatMulImpl::MatrixIOException);
+    write_text(path,
+               "%%MatrixMarket matrix array real skew-symmetric\n"
+               "3 2\n"
+               "1\n2\n3\n");
+    EXPECT_THROW(MatMulImpl::MatrixMarket::read<double>(path),
+                 MatMulImpl::MatrixIOException);
+    std::remove(path.c_str());
+}
+
+TEST(MATRIX_MARKET, INTEGER_ITEMS_MUST_BE_INTEGRAL) {
+    std::string path = temp_path("integral.mtx");
+    write_text(path,
+               "%%MatrixMarket matrix array real general\n"
+               "2 1\n"
+               "3.0\n"
+               "1e2\n");
+    Matrix2<int> a = MatMulImpl::MatrixMarket::read<int>(path);
+    EXPECT_EQ(a.citem(0, 0), 3);
+    EXPECT_EQ(a.citem(1, 0), 100);
+    write_text(path,
+               "%%MatrixMarket matrix array real general\n"
+               "2 1\n"
+               "3.5\n"
+               "1\n");
+    EXPECT_THROW(MatMulImpl::MatrixMarket::read<int>(path),
+                 MatMulImpl::MatrixIOException);
+    std::remove(path.c_str());
+}
+
+TEST(MATRIX_MARKET, TEXT_AFTER_AN_ENTRY_IS_REFUSED) {
+    std::string path = temp_path("trailing.mtx");
+    write_text(path,
+               "%%MatrixMarket matrix coordinate real general\n"
+               "2 2 2\n"
+               "1 1 1.5 \r\n"
+               "2 2 4 9\n");
+    EXPECT_THROW(MatMulImpl::MatrixMarket::read<double>(path),
+                 MatMulImpl::MatrixIOException);
+    write_text(path,
+               "%%MatrixMarket matrix coordinate real general\n"
+               "2 2 2\n"
+               "1 1 1.5 \r\n"
+               "2 2 4\n");
+    Matrix2<double> a = MatMulImpl::MatrixMarket::read<double>(path);
+    EXPECT_EQ(a.citem(0, 0), 1.5);
+    EXPECT_EQ(a.citem(1, 1), 4);
+    std::remove(path.c_str());
+}
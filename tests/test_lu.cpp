@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "Algorithms.hpp"
+#include "Generator.hpp"
+#include "LU.hpp"
+#include "Matrixv2.hpp"
+
+namespace {
+using MatMulImpl::LU;
+using MatMulImpl::Matrix2;
+using MatMulImpl::MatrixGenerator;
+
+Matrix2<double> random_matrix(int m, int n, std::uint64_t seed) {
+    return MatrixGenerator<double>::random_fill_seeded(m, n, seed);
+}
+
+double max_abs_diff(const Matrix2<double> &x, const Matrix2<double> &y) {
+    double d = 0;
+    for (int i = 0; i < x.m; i++)
+        for (int j = 0; j < x.n; j++)
+            d = std::max(d, std::abs(x.citem(i, j) - y.citem(i, j)));
+    return d;
+}
+
+// P A, applying the row swaps of the factorization in order
+Matrix2<double> permuted(const LU<double> &lu, const Matrix2<double> &a) {
+    Matrix2<double> pa(a.m, a.n);
+    for (int i = 0; i < a.m; i++)
+        std::copy_n(&a.citem(i, 0), a.n, &pa.item(i, 0));
+    for (int i = 0; i < a.m; i++) {
+        const int p = lu.pivots()[i];
+        if (p != i)
+            std::swap_ranges(&pa.item(i, 0), &pa.item(i, 0) + a.n,
+                             &pa.item(p, 0));
+    }
+    return pa;
+}
+
+// L U from the packed factors, with the unit diagonal of L restored
+Matrix2<double> product_of_factors(const LU<double> &lu) {
+    const Matrix2<double> &f = lu.factors();
+    const int n = lu.n;
+    Matrix2<double> l(n, n), u(n, n);
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++) {
+            l.item(i, j) = j < i ? f.citem(i, j) : (i == j ? 1.0 : 0.0);
+            u.item(i, j) = j >= i ? f.citem(i, j) : 0.0;
+        }
+    return MatMulImpl::Multiplication::blocked(l, u, 1);
+}
+}  // namespace
+
+TEST(LU, FACTORS_REPRODUCE_PERMUTED_MATRIX) {
+    // Sides that are and are not a multiple of the block, and one block
+    for (int n : {1, 64, 150}) {
+        Matrix2<double> a = random_matrix(n, n, 11 + n);
+        LU<double> lu(a, 32, 4);
+        ASSERT_FALSE(lu.singular());
+        for (int i = 0; i < n; i++) ASSERT_GE(lu.pivots()[i], i);
+        EXPECT_LT(max_abs_diff(permuted(lu, a), product_of_factors(lu)),
+                  1e-9)
+            << "n = " << n;
+    }
+}
+
+TEST(LU, SOLVE_RECOVERS_KNOWN_SOLUTION) {
+    const int n = 130, r = 7;
+    Matrix2<double> a = random_matrix(n, n, 3);
+    Matrix2<double> x = random_matrix(n, r, 4);
+    Matrix2<double> b = MatMulImpl::Multiplication::blocked(a, x, 1);
+    LU<double> lu(a, 32, 4);
+    EXPECT_LT(max_abs_diff(lu.solve(b, 4), x), 1e-8);
+}
+
+TEST(LU, INVERSE_TIMES_MATRIX_IS_IDENTITY) {
+    const int n = 70;
+    Matrix2<double> a = random_matrix(n, n, 5);
+    Matrix2<double> ai = LU<double>(a, 16, 2).inverse(2);
+    Matrix2<double> eye(n, n);
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++) eye.item(i, j) = i == j ? 1.0 : 0.0;
+    EXPECT_LT(max_abs_diff(MatMulImpl::Multiplication::blocked(ai, a, 1), eye),
+              1e-9);
+}
+
+TEST(LU, SINGULAR_MATRIX_IS_REFUSED) {
+    const int n = 40;
+    Matrix2<double> a = random_matrix(n, n, 6);
+    // Elimination keeps a zero column exactly zero
+    for (int i = 0; i < n; i++) a.item(i, 17) = 0;
+    LU<double> lu(a, 16, 2);
+    EXPECT_TRUE(lu.singular());
+    EXPECT_THROW(lu.solve(random_matrix(n, 1, 7), 2),
+                 MatMulImpl::SingularMatrixException);
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "Algorithms.hpp"
+#include "Generator.hpp"
+#include "MaintainedProduct.hpp"
+#include "Matrixv2.hpp"
+
+namespace {
+using MatMulImpl::MaintainedProduct;
+using MatMulImpl::Matrix2;
+using MatMulImpl::MatrixGenerator;
+using MatMulImpl::Multiplication;
+
+Matrix2<double> random_matrix(int m, int n, std::uint64_t seed) {
+    return MatrixGenerator<double>::random_fill_seeded(m, n, seed);
+}
+
+// c() against a product of the current A and B formed from scratch
+void expect_current(MaintainedProduct<double> &p) {
+    const Matrix2<double> &c = p.c();
+    EXPECT_EQ(p.pending_rank(), 0);
+    Matrix2<double> want = Multiplication::blocked(p.a(), p.b(), 1);
+    double d = 0, top = 0;
+    for (int i = 0; i < c.m; i++)
+        for (int j = 0; j < c.n; j++) {
+            d = std::max(d, std::abs(c.citem(i, j) - want.citem(i, j)));
+            top = std::max(top, std::abs(want.citem(i, j)));
+        }
+    EXPECT_LT(d, 1e-12 * std::max(1.0, top));
+}
+
+// One update of each kind, touching overlapping rows and columns
+void mixed_updates(MaintainedProduct<double> &p, int r, std::uint64_t seed) {
+    const int m = p.a().m, k = p.a().n, n = p.b().n;
+    p.set_a_row(3, random_matrix(1, k, seed));
+    p.set_b_col(5, random_matrix(k, 1, seed + 1));
+    p.set_a_col(2, random_matrix(m, 1, seed + 2));
+    p.set_b_row(7, random_matrix(1, n, seed + 3));
+    p.update_a(random_matrix(m, r, seed + 4), random_matrix(k, r, seed + 5));
+    p.set_a_row(3, random_matrix(1, k, seed + 6));  // Dirty twice
+    p.update_b(random_matrix(k, r, seed + 7), random_matrix(n, r, seed + 8));
+    p.set_b_col(0, random_matrix(k, 1, seed + 9));
+}
+}  // namespace
+
+TEST(MAINTAINED_PRODUCT, FLUSH_PATH_MATCHES_FRESH_PRODUCT) {
+    // Total rank 2 + 2r and two dirty rows and columns stay well below
+    // the cost of AB, so the corrections are applied
+    const int m = 90, k = 70, n = 110, r = 3;
+    MaintainedProduct<double> p(random_matrix(m, k, 1),
+                                random_matrix(k, n, 2), 2);
+    mixed_updates(p, r, 10);
+    EXPECT_EQ(p.pending_rank(), 2 + 2 * r);
+    expect_current(p);
+    // A second round, on top of a C that was itself maintained
+    mixed_updates(p, r, 30);
+    expect_current(p);
+}
+
+TEST(MAINTAINED_PRODUCT, RECOMPUTE_PATH_MATCHES_FRESH_PRODUCT) {
+    // Corrections of rank k cost as much as AB, so C is recomputed
+    const int m = 40, k = 24, n = 50;
+    MaintainedProduct<double> p(random_matrix(m, k, 3),
+                                random_matrix(k, n, 4), 2);
+    mixed_updates(p, k, 50);
+    EXPECT_GE(p.pending_rank(), k);
+    expect_current(p);
+    mixed_updates(p, 1, 70);
+    expect_current(p);
+}
+
+TEST(MAINTAINED_PRODUCT, MISMATCHED_SHAPES_THROW) {
+    EXPECT_THROW(MaintainedProduct<double>(random_matrix(4, 5, 1),
+                                           random_matrix(6, 3, 2), 1),
+                 MatMulImpl::BadDimensionException);
+    MaintainedProduct<double> p(random_matrix(4, 5, 1),
+                                random_matrix(5, 3, 2), 1);
+    EXPECT_THROW(p.set_a_row(0, random_matrix(1, 4, 3)),
+                 MatMulImpl::BadDimensionException);
+    EXPECT_THROW(p.update_b(random_matrix(5, 2, 4), random_matrix(3, 1, 5)),
+                 MatMulImpl::BadDimensionException);
+}
@@ -1,7 +1,13 @@
+#include <memory>
+#include <thread>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include "Matrix.hpp"
 #include "MatrixExceptions.hpp"
+#include "Matrixv2.hpp"
+#include "Parallel.hpp"
 
 TEST(MATRIX_BASE, DIM) {
     MatMulImpl::Matrix<int> m(3, 3);
@@ -150,8 +156,8 @@ TEST(MATRIX, CONSTRUCTOR_1D_LIST) {
 
     for (int i = 0; i < 3; i++) {
         for (int j = 0; j < 4; j++) {
-            if (i * 3 + j < 9) {
-                EXPECT_EQ(m2.at(i, j), i * 3 + j + 1);
+            if (i * 4 + j < 9) {
+                EXPECT_EQ(m2.at(i, j), i * 4 + j + 1);
             } else {
                 EXPECT_EQ(m2.at(i, j), 0);
             }
@@ -178,4 +184,171 @@ TEST(MATRIX, CONSTRUCTOR_1D_LIST) {
 
     EXPECT_THROW(MatMulImpl::Matrix<int>({1, 2, 3, 4, 5, 6, 7, 8, 9}, 2, 2),
                  MatMulImpl::TooManyInitializersException);
-}
\ No newline at end of file
+}
+
+TEST(MATRIX_VIEW, SUB) {
+    MatMulImpl::Matrix<int> m({{1, 2, 3}, {4, 5, 6}, {7, 8, 9}}, 3);
+    auto v = m.sub(2, 2, 1, 1);
+    EXPECT_EQ(v.dim(), std::make_pair(2, 2));
+    EXPECT_EQ(v.at(0, 0), 5);
+    EXPECT_EQ(v.at(1, 1), 9);
+
+    v.at(0, 1) = 60;
+    EXPECT_EQ(m.at(1, 2), 60);
+
+    EXPECT_THROW(v.at(2, 0), MatMulImpl::OutOfBoundsException);
+    EXPECT_THROW(m.sub(2, 2, 2, 2), MatMulImpl::OutOfBoundsException);
+}
+
+TEST(MATRIX_VIEW, OUTLIVES_MATRIX) {
+    auto m = std::make_unique<MatMulImpl::Matrix<int>>(
+        std::initializer_list<int>{1, 2, 3, 4}, 2);
+    auto v = m->csub(1, 2, 1, 0);
+    m.reset();
+    EXPECT_EQ(v.at(0, 0), 3);
+    EXPECT_EQ(v.at(0, 1), 4);
+}
+
+TEST(MATRIX_BASE, MATRIX_MUL_LARGE) {
+    const int n = 96;
+    MatMulImpl::Matrix<long> a(n, n), b(n, n), c(n, n);
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            a.at(i, j) = i - j;
+            b.at(i, j) = (i * j) % 7;
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            for (int k = 0; k < n; k++) c.at(i, j) += a.at(i, k) * b.at(k, j);
+        }
+    }
+    EXPECT_EQ(a * b, c);
+    EXPECT_EQ(a.sub(n / 2, n, 0, 0) * b, c.sub(n / 2, n, 0, 0));
+}
+
+namespace {
+using MatMulImpl::Matrix2;
+
+// Item (i, j) is i * 1000 + j, plus delta
+Matrix2<int> numbered(int m, int n, int delta = 0) {
+    Matrix2<int> x(m, n);
+    for (int i = 0; i < m; i++)
+        for (int j = 0; j < n; j++) x.item(i, j) = i * 1000 + j + delta;
+    return x;
+}
+
+void expect_numbered(const Matrix2<int> &x, int delta = 0) {
+    for (int i = 0; i < x.m; i++)
+        for (int j = 0; j < x.n; j++)
+            ASSERT_EQ(x.citem(i, j), i * 1000 + j + delta) << i << ", " << j;
+}
+}  // namespace
+
+TEST(MATRIX2_COW, COPY_THEN_WRITE_EACH_SIDE) {
+    Matrix2<int> a = numbered(20, 30);
+    Matrix2<int> b(a);
+    // Shared until written
+    EXPECT_EQ(&a.citem(0, 0), &b.citem(0, 0));
+    b.item(3, 4) = -1;
+    EXPECT_NE(&a.citem(0, 0), &b.citem(0, 0));
+    EXPECT_EQ(a.citem(3, 4), 3004);
+    a.item(5, 6) = -2;
+    EXPECT_EQ(b.citem(5, 6), 5006);
+    EXPECT_EQ(a.citem(5, 6), -2);
+    EXPECT_EQ(b.citem(3, 4), -1);
+
+    // The other side writes first
+    Matrix2<int> c = numbered(8, 8);
+    Matrix2<int> d(c);
+    c.item(0, 0) = -3;
+    EXPECT_EQ(d.citem(0, 0), 0);
+    d.item(7, 7) = -4;
+    EXPECT_EQ(c.citem(7, 7), 7007);
+    EXPECT_EQ(c.citem(0, 0), -3);
+}
+
+TEST(MATRIX2_COW, COPY_WITH_LIVE_VIEWS_IS_DEEP) {
+    Matrix2<int> a = numbered(10, 12);
+    Matrix2<int> v = a.sub(2, 3, 4, 5);
+    Matrix2<int> b(a);
+    EXPECT_NE(&a.citem(0, 0), &b.citem(0, 0));
+    // A write through the view reaches a only
+    v.item(0, 0) = -1;
+    EXPECT_EQ(a.citem(2, 3), -1);
+    EXPECT_EQ(b.citem(2, 3), 2003);
+    // Copying the view copies its items too
+    Matrix2<int> w(v);
+    EXPECT_TRUE(w.owns_storage());
+    v.item(1, 1) = -2;
+    EXPECT_EQ(w.citem(1, 1), 3004);
+    EXPECT_EQ(a.citem(3, 4), -2);
+}
+
+TEST(MATRIX2_COW, VIEW_OUTLIVES_OWNER) {
+    auto owner = std::make_unique<Matrix2<int>>(numbered(16, 16));
+    Matrix2<int> v = owner->sub(4, 5, 6, 7);
+    const Matrix2<int> cv = owner->csub(10, 0, 6, 16);
+    owner.reset();
+    for (int i = 0; i < 6; i++)
+        for (int j = 0; j < 7; j++)
+            ASSERT_EQ(v.citem(i, j), (i + 4) * 1000 + j + 5);
+    v.item(5, 6) = -1;
+    EXPECT_EQ(v.citem(5, 6), -1);
+    EXPECT_EQ(cv.citem(0, 11), 10011);
+}
+
+TEST(MATRIX2_COW, UNSHARE_BEFORE_THREADED_WRITE) {
+    const int m = 400, n = 64;
+    Matrix2<int> a = numbered(m, n);
+    Matrix2<int> b(a);
+    b.unshare();
+    EXPECT_NE(&a.citem(0, 0), &b.citem(0, 0));
+    MatMulImpl::parallel_for_rows(m, 4, [&](int i0, int i1, int) {
+        for (int i = i0; i < i1; i++)
+            for (int j = 0; j < n; j++) b.item(i, j) += 1;
+    });
+    expect_numbered(a);
+    expect_numbered(b, 1);
+}
+
+TEST(MATRIX2_COW, CONCURRENT_COPIES) {
+    Matrix2<int> x = numbered(50, 40);
+    const Matrix2<int> &a = x;
+    std::vector<std::thread> threads;
+    std::vector<int> bad(8, 0);
+    for (int t = 0; t < 8; t++)
+        threads.emplace_back([&, t] {
+            for (int r = 0; r < 200; r++) {
+                Matrix2<int> copy(a);
+                if (copy.citem(49, 39) != 49039) bad[t]++;
+                if (r % 10 == 0) {
+                    copy.item(0, 0) = -t;
+                    if (copy.citem(0, 0) != -t) bad[t]++;
+                }
+            }
+        });
+    for (auto &&th : threads) th.join();
+    for (int t = 0; t < 8; t++) EXPECT_EQ(bad[t], 0) << "thread " << t;
+    expect_numbered(a);
+    // Every copy is gone, so a write keeps the storage
+    const int *before = &x.citem(0, 0);
+    x.item(0, 0) = 7;
+    EXPECT_EQ(&x.citem(0, 0), before);
+}
+
+TEST(MATRIX2, MULTIPLY_NON_SQUARE) {
+    auto a = Matrix2<int>::from({{1, 2, 3}, {4, 5, 6}});
+    auto b = Matrix2<int>::from({{9, 8, 7, 11}, {6, 5, 4, 12}, {3, 2, 1, 13}});
+    auto c = a * b;
+    EXPECT_EQ(c.dim(), std::make_pair(2, 4));
+    EXPECT_TRUE(c == Matrix2<int>::from({{30, 24, 18, 74}, {84, 69, 54, 182}}));
+    EXPECT_THROW(b * a, MatMulImpl::BadDimensionException);
+
+    // An empty inner dimension gives zeros
+    Matrix2<int> e(3, 0), f(0, 2);
+    auto z = e * f;
+    EXPECT_EQ(z.dim(), std::make_pair(3, 2));
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 2; j++) EXPECT_EQ(z.citem(i, j), 0);
+}
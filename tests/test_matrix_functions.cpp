@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "Algorithms.hpp"
+#include "Generator.hpp"
+#include "MatrixFunctions.hpp"
+#include "Matrixv2.hpp"
+
+namespace {
+using MatMulImpl::Matrix2;
+using MatMulImpl::MatrixFunctions;
+using MatMulImpl::MatrixGenerator;
+using MatMulImpl::Multiplication;
+
+template <class T>
+Matrix2<T> diagonal(const std::vector<T> &d) {
+    const int n = static_cast<int>(d.size());
+    Matrix2<T> x(n, n);
+    for (int i = 0; i < n; i++) {
+        std::fill_n(&x.item(i, 0), n, T(0));
+        x.item(i, i) = d[i];
+    }
+    return x;
+}
+
+template <class T>
+void expect_identity(const Matrix2<T> &x) {
+    for (int i = 0; i < x.m; i++)
+        for (int j = 0; j < x.n; j++)
+            ASSERT_EQ(x.citem(i, j), T(i == j)) << i << ", " << j;
+}
+}  // namespace
+
+TEST(MATRIX_FUNCTIONS, POWER_ZERO_IS_IDENTITY) {
+    expect_identity(MatrixFunctions::power(
+        MatrixGenerator<int>::random_fill_seeded(9, 9, 1), 0, 2));
+    expect_identity(MatrixFunctions::power(
+        MatrixGenerator<double>::random_fill_seeded(33, 33, 2), 0, 2));
+}
+
+TEST(MATRIX_FUNCTIONS, POWER_MATCHES_REPEATED_PRODUCT) {
+    // Small entries keep every product of A^5 exact in int
+    const int n = 23;
+    Matrix2<int> a(n, n);
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++) a.item(i, j) = (i * 7 + j * 3) % 5 - 2;
+    Matrix2<int> a2 = Multiplication::blocked(a, a, 1);
+    Matrix2<int> a3 = Multiplication::blocked(a2, a, 1);
+    Matrix2<int> a4 = Multiplication::blocked(a3, a, 1);
+    Matrix2<int> expected = Multiplication::blocked(a4, a, 1);
+    Matrix2<int> got = MatrixFunctions::power(a, 5, 2);
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+            ASSERT_EQ(got.citem(i, j), expected.citem(i, j))
+                << i << ", " << j;
+}
+
+TEST(MATRIX_FUNCTIONS, EXPM_OF_ZERO_IS_IDENTITY) {
+    Matrix2<double> z = diagonal(std::vector<double>(17, 0.0));
+    expect_identity(MatrixFunctions::expm(z, 2));
+}
+
+TEST(MATRIX_FUNCTIONS, EXPM_OF_DIAGONAL) {
+    // The norms pick every Pade degree, and 8 needs scaling and squaring
+    for (double top : {0.01, 0.2, 0.9, 2.0, 5.0, 8.0}) {
+        std::vector<double> d;
+        for (int i = 0; i < 12; i++) d.push_back(top * (i - 4) / 7);
+        Matrix2<double> e = MatrixFunctions::expm(diagonal(d), 2);
+        for (int i = 0; i < 12; i++)
+            for (int j = 0; j < 12; j++) {
+                const double want = i == j ? std::exp(d[i]) : 0.0;
+                EXPECT_NEAR(e.citem(i, j), want, 1e-12 * std::exp(top))
+                    << "norm " << top << " at " << i << ", " << j;
+            }
+    }
+}
+
+TEST(MATRIX_FUNCTIONS, EXPM_REFUSES_NON_FINITE) {
+    Matrix2<double> a = diagonal(std::vector<double>(5, 1.0));
+    a.item(2, 3) = std::numeric_limits<double>::infinity();
+    EXPECT_THROW(MatrixFunctions::expm(a, 1),
+                 MatMulImpl::NonFiniteMatrixException);
+    a.item(2, 3) = std::numeric_limits<double>::quiet_NaN();
+    EXPECT_THROW(MatrixFunctions::expm(a, 1),
+                 MatMulImpl::NonFiniteMatrixException);
+}
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "Algorithms.hpp"
+#include "Generator.hpp"
+#include "MappedMatrix.hpp"
+#include "Matrixv2.hpp"
+#include "OutOfCore.hpp"
+
+namespace {
+using MatMulImpl::MappedMatrix;
+using MatMulImpl::Matrix2;
+using MatMulImpl::OutOfCore;
+
+std::string temp_path(const char *name) {
+    return ::testing::TempDir() + "matmul_ooc_" + name;
+}
+void remove_files() {
+    for (const char *name : {"a", "b", "c"})
+        std::remove(temp_path(name).c_str());
+}
+
+// A file holding the items of x
+MappedMatrix<double> mapped_copy(const Matrix2<double> &x, const char *name) {
+    auto f = MappedMatrix<double>::create(temp_path(name), x.m, x.n);
+    Matrix2<double> v = f.view();
+    for (int i = 0; i < x.m; i++)
+        for (int j = 0; j < x.n; j++) v.item(i, j) = x.citem(i, j);
+    return f;
+}
+}  // namespace
+
+TEST(OUT_OF_CORE, MATCHES_BLOCKED) {
+    // Shapes that no tile side divides, a single row, and k = 1
+    const int shapes[][3] = {
+        {37, 53, 29}, {1, 100, 3}, {70, 1, 45}, {150, 131, 170}};
+    // 4 KiB gives 10 x 10 tiles; 1 MiB holds every operand in one tile
+    const std::size_t budgets[] = {4 << 10, 64 << 10, 1 << 20};
+    for (const auto &s : shapes) {
+        auto a = MatMulImpl::MatrixGenerator<double>::random_fill_seeded(
+            s[0], s[1], 1);
+        auto b = MatMulImpl::MatrixGenerator<double>::random_fill_seeded(
+            s[1], s[2], 2);
+        Matrix2<double> want = MatMulImpl::Multiplication::blocked(a, b, 1);
+        auto fa = mapped_copy(a, "a"), fb = mapped_copy(b, "b");
+        for (std::size_t budget : budgets) {
+            auto fc = MappedMatrix<double>::create(temp_path("c"), s[0], s[2]);
+            OutOfCore::multiply(fa, fb, fc, budget, 2);
+            Matrix2<double> got = fc.view();
+            for (int i = 0; i < s[0]; i++)
+                for (int j = 0; j < s[2]; j++)
+                    ASSERT_NEAR(got.citem(i, j), want.citem(i, j),
+                                1e-12 * (1 + std::abs(want.citem(i, j))))
+                        << s[0] << "x" << s[1] << "x" << s[2] << ", budget "
+                        << budget << " at " << i << ", " << j;
+        }
+    }
+    remove_files();
+}
+
+TEST(OUT_OF_CORE, MISMATCHED_SHAPES_THROW) {
+    auto a = MappedMatrix<double>::create(temp_path("a"), 3, 4);
+    auto b = MappedMatrix<double>::create(temp_path("b"), 5, 2);
+    auto c = MappedMatrix<double>::create(temp_path("c"), 3, 2);
+    EXPECT_THROW(OutOfCore::multiply(a, b, c, 4 << 10, 1),
+                 MatMulImpl::BadDimensionException);
+    remove_files();
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "Algorithms.hpp"
+#include "Generator.hpp"
+#include "Matrixv2.hpp"
+#include "PackedMatrix.hpp"
+
+namespace {
+using MatMulImpl::Matrix2;
+using MatMulImpl::MatrixGenerator;
+using MatMulImpl::Multiplication;
+using MatMulImpl::PackedMatrix;
+
+template <class T>
+void fill_with(Matrix2<T> &c, T value) {
+    for (int i = 0; i < c.m; i++) std::fill_n(&c.item(i, 0), c.n, value);
+}
+
+// C + AB, through the unpacked and the packed kernel
+template <class T>
+void expect_packed_matches(int m, int k, int n, int threads) {
+    auto a = MatrixGenerator<T>::random_fill_seeded(m, k, 1);
+    auto b = MatrixGenerator<T>::random_fill_seeded(k, n, 2);
+    Matrix2<T> want(m, n), got(m, n);
+    fill_with(want, T(3));
+    fill_with(got, T(3));
+    Multiplication::multiply_add(a, b, want, threads);
+    Multiplication::multiply_add(a, Multiplication::prepack(b), got, threads);
+    for (int i = 0; i < m; i++)
+        for (int j = 0; j < n; j++)
+            ASSERT_EQ(got.citem(i, j), want.citem(i, j))
+                << m << "x" << k << "x" << n << " at " << i << ", " << j;
+}
+}  // namespace
+
+TEST(PACKED_MULTIPLY, MATCHES_UNPACKED_OFF_PANEL_SHAPES) {
+    // k and n straddle the kc x nc panels, m is not a multiple of the four
+    // rows per pass, and n = 13 pads each panel row to a cache line
+    const int shapes[][3] = {{7, 300, 530}, {5, 257, 13}, {1, 1, 1},
+                             {9, 512, 1025}};
+    for (const auto &s : shapes) {
+        expect_packed_matches<int>(s[0], s[1], s[2], 1);
+        expect_packed_matches<int>(s[0], s[1], s[2], 4);
+    }
+}
+
+TEST(PACKED_MULTIPLY, FLOATING_POINT_MATCHES_UNPACKED) {
+    // The kernels add the products of each panel in the same order
+    expect_packed_matches<double>(33, 300, 530, 3);
+    expect_packed_matches<float>(33, 300, 530, 3);
+}
+
+TEST(PACKED_MULTIPLY, VIEWS_AND_EMPTY_DIMENSIONS) {
+    auto big_a = MatrixGenerator<int>::random_fill_seeded(60, 400, 3);
+    auto b = MatrixGenerator<int>::random_fill_seeded(270, 45, 4);
+    auto a = big_a.sub(5, 17, 21, 270);
+    Matrix2<int> big_c(40, 80), want(21, 45);
+    fill_with(big_c, 0);
+    fill_with(want, 0);
+    auto c = big_c.sub(9, 30, 21, 45);
+    Multiplication::multiply_add(a, b, want, 1);
+    Multiplication::multiply_add(a, Multiplication::prepack(b), c, 2);
+    for (int i = 0; i < 21; i++)
+        for (int j = 0; j < 45; j++)
+            ASSERT_EQ(c.citem(i, j), want.citem(i, j)) << i << ", " << j;
+
+    Matrix2<int> empty_b(0, 5);
+    auto product = Multiplication::blocked(
+        Matrix2<int>(4, 0), Multiplication::prepack(empty_b), 1);
+    EXPECT_EQ(product.dim(), std::make_pair(4, 5));
+    for (int i = 0; i < 4; i++)
+        for (int j = 0; j < 5; j++) EXPECT_EQ(product.citem(i, j), 0);
+}
+
+TEST(PACKED_MULTIPLY, MISMATCHED_SHAPES_THROW) {
+    auto packed = Multiplication::prepack(
+        MatrixGenerator<int>::random_fill_seeded(6, 4, 5));
+    Matrix2<int> a(3, 5), c(3, 4);
+    EXPECT_THROW(Multiplication::multiply_add(a, packed, c, 1),
+                 MatMulImpl::BadDimensionException);
+}
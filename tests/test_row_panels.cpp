@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "Algorithms.hpp"
+#include "Generator.hpp"
+#include "Matrixv2.hpp"
+#include "RowPanels.hpp"
+
+namespace {
+using MatMulImpl::Matrix2;
+using MatMulImpl::MatrixGenerator;
+using MatMulImpl::Multiplication;
+}  // namespace
+
+TEST(ROW_PANELS, JOINED_PANELS_MATCH_BLOCKED) {
+    const int m = 103, k = 45, n = 37;
+    auto a = MatrixGenerator<double>::random_fill_seeded(m, k, 1);
+    auto b = MatrixGenerator<double>::random_fill_seeded(k, n, 2);
+    Matrix2<double> want = Multiplication::blocked(a, b, 1);
+    // None of these divide m; 200 is a single short panel
+    for (int panel_rows : {1, 10, 64, 200}) {
+        for (bool lookahead : {false, true}) {
+            auto panels = MatMulImpl::row_panels(a, b, panel_rows, 2,
+                                                 lookahead);
+            Matrix2<double> c(m, n);
+            int next = 0, count = 0;
+            for (auto &&panel : panels) {
+                ASSERT_EQ(panel.row0, next);
+                ASSERT_EQ(panel.rows.n, n);
+                ASSERT_LE(panel.rows.m, panel_rows);
+                for (int i = 0; i < panel.rows.m; i++)
+                    for (int j = 0; j < n; j++)
+                        c.item(panel.row0 + i, j) = panel.rows.citem(i, j);
+                next += panel.rows.m;
+                count++;
+            }
+            EXPECT_EQ(next, m);
+            EXPECT_EQ(count, panels.panel_count());
+            for (int i = 0; i < m; i++)
+                for (int j = 0; j < n; j++)
+                    ASSERT_NEAR(c.citem(i, j), want.citem(i, j),
+                                1e-12 * (1 + std::abs(want.citem(i, j))))
+                        << "panel_rows " << panel_rows << ", lookahead "
+                        << lookahead << " at " << i << ", " << j;
+        }
+    }
+}
+
+TEST(ROW_PANELS, BREAK_AFTER_THE_FIRST_PANEL) {
+    // The range goes away while the lookahead computes the second panel
+    auto a = MatrixGenerator<double>::random_fill_seeded(300, 80, 3);
+    auto b = MatrixGenerator<double>::random_fill_seeded(80, 90, 4);
+    Matrix2<double> want =
+        Multiplication::blocked(a.csub(0, 0, 32, 80), b, 1);
+    for (bool lookahead : {false, true}) {
+        int seen = 0;
+        for (auto &&panel : MatMulImpl::row_panels(a, b, 32, 1, lookahead)) {
+            ASSERT_EQ(panel.row0, 0);
+            for (int i = 0; i < 32; i++)
+                for (int j = 0; j < 90; j++)
+                    ASSERT_NEAR(panel.rows.citem(i, j), want.citem(i, j),
+                                1e-12 * (1 + std::abs(want.citem(i, j))));
+            seen++;
+            break;
+        }
+        EXPECT_EQ(seen, 1);
+    }
+}
+
+TEST(ROW_PANELS, MISMATCHED_SHAPES_THROW) {
+    Matrix2<double> a(4, 5), b(6, 3);
+    EXPECT_THROW(MatMulImpl::row_panels(a, b),
+                 MatMulImpl::BadDimensionException);
+}
@@ -0,0 +1,146 @@
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "Algorithms.hpp"
+#include "Generator.hpp"
+#include "MultiplyService.hpp"
+
+namespace {
+using MatMulImpl::Matrix2;
+using MatMulImpl::MultiplyClient;
+using MatMulImpl::SharedMatrix;
+namespace Svc = MatMulImpl::MultiplyService;
+
+// An MtpDaemon of its own on a private socket, stopped on destruction
+class Daemon {
+   public:
+    Daemon()
+        : socket(::testing::TempDir() + "matmul_daemon_" +
+                 std::to_string(getpid()) + ".sock") {
+        pid = fork();
+        if (pid == 0) {
+            int null = open("/dev/null", O_WRONLY);
+            dup2(null, 1);
+            dup2(null, 2);
+            execl(MTP_DAEMON_PATH, "MtpDaemon", "-s", socket.c_str(), "-j",
+                  "2", static_cast<char *>(nullptr));
+            _exit(127);
+        }
+    }
+    ~Daemon() {
+        if (pid <= 0) return;
+        kill(pid, SIGTERM);
+        waitpid(pid, nullptr, 0);
+    }
+
+    // A client, once the daemon listens
+    std::unique_ptr<MultiplyClient> connect() {
+        for (int attempt = 0; attempt < 200; attempt++) {
+            try {
+                return std::make_unique<MultiplyClient>(socket);
+            } catch (MatMulImpl::ServiceException &) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(25));
+            }
+        }
+        return nullptr;
+    }
+    bool running() const { return waitpid(pid, nullptr, WNOHANG) == 0; }
+
+    const std::string socket;
+
+   private:
+    pid_t pid = -1;
+};
+
+template <class T>
+void fill(SharedMatrix<T> &x, std::uint64_t seed) {
+    Matrix2<T> v = x.view();
+    MatMulImpl::CounterFill::fill(v, seed, 0, 0,
+                                  MatMulImpl::UniformRealMap(), 1);
+}
+
+// C from the daemon against the blocked kernel on the same operands
+template <class T>
+void expect_product(MultiplyClient &client, int m, int k, int n) {
+    SharedMatrix<T> a(m, k), b(k, n), c(m, n);
+    fill(a, 1);
+    fill(b, 2);
+    client.multiply(a, b, c);
+    Matrix2<T> want =
+        MatMulImpl::Multiplication::blocked(a.view(), b.view(), 1);
+    Matrix2<T> got = c.view();
+    for (int i = 0; i < m; i++)
+        for (int j = 0; j < n; j++)
+            ASSERT_NEAR(got.citem(i, j), want.citem(i, j),
+                        1e-4 * (1 + std::abs(want.citem(i, j))))
+                << m << "x" << k << "x" << n << " at " << i << ", " << j;
+}
+}  // namespace
+
+TEST(MULTIPLY_SERVICE, ROUND_TRIP) {
+    Daemon daemon;
+    auto client = daemon.connect();
+    ASSERT_TRUE(client) << "MtpDaemon did not start";
+    // Batched small products and a large one
+    expect_product<double>(*client, 7, 5, 9);
+    expect_product<float>(*client, 33, 17, 21);
+    expect_product<double>(*client, 130, 170, 150);
+    EXPECT_NE(client->stats().find("\"requests\": 3"), std::string::npos)
+        << client->stats();
+}
+
+TEST(MULTIPLY_SERVICE, OPERANDS_CANNOT_SHRINK) {
+    SharedMatrix<double> a(64, 64);
+    EXPECT_NE(ftruncate(a.fd(), 0), 0);
+    EXPECT_EQ(errno, EPERM);
+}
+
+TEST(MULTIPLY_SERVICE, UNSEALED_OPERANDS_ARE_REFUSED) {
+    Daemon daemon;
+    auto client = daemon.connect();
+    ASSERT_TRUE(client) << "MtpDaemon did not start";
+    // Files a client could truncate under the daemon's mapping
+    const int m = 40;
+    int fds[3];
+    for (int &fd : fds) {
+        fd = memfd_create("unsealed", MFD_CLOEXEC);
+        ASSERT_GE(fd, 0);
+        ASSERT_EQ(ftruncate(fd, m * m * sizeof(double)), 0);
+    }
+    // A connection of its own, as MultiplyClient always sends sealed files
+    int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, daemon.socket.c_str());
+    ASSERT_EQ(connect(sock, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)),
+              0);
+    Svc::Request req{Svc::magic, Svc::Op::Multiply,
+                     MatMulImpl::ElementType::Float64, 0, m, m, m, 1};
+    ASSERT_TRUE(Svc::send_all(sock, &req, sizeof(req), fds, 3));
+    Svc::Reply reply{};
+    ASSERT_TRUE(Svc::recv_all(sock, &reply, sizeof(reply)));
+    std::string text(reply.text_len, '\0');
+    ASSERT_TRUE(Svc::recv_all(sock, &text[0], text.size()));
+    EXPECT_NE(reply.status, 0);
+    EXPECT_NE(text.find("F_SEAL_SHRINK"), std::string::npos) << text;
+    close(sock);
+    for (int fd : fds) close(fd);
+    // The daemon carries on serving
+    EXPECT_TRUE(daemon.running());
+    expect_product<double>(*client, 20, 30, 10);
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "Algorithms.hpp"
+#include "Generator.hpp"
+#include "Matrixv2.hpp"
+#include "TaskGraph.hpp"
+
+namespace {
+using MatMulImpl::Matrix2;
+using MatMulImpl::MatrixGenerator;
+using MatMulImpl::Multiplication;
+using MatMulImpl::TaskGraph;
+
+// When each task started and finished, on one clock shared by all tasks
+struct Span {
+    int start = -1, finish = -1;
+};
+}  // namespace
+
+TEST(TASK_GRAPH, READS_AND_WRITES_ARE_ORDERED) {
+    for (int round = 0; round < 50; round++) {
+        TaskGraph graph;
+        std::atomic<int> clock{0};
+        std::vector<Span> spans(7);
+        int x = 0, y = 0;
+        int seen[4] = {};
+        auto task = [&](int id, std::function<void()> body) {
+            return [&, id, body] {
+                spans[id].start = clock++;
+                body();
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+                spans[id].finish = clock++;
+            };
+        };
+        // w1 writes x; r1..r3 read it; w2 overwrites it; r4 reads x and y
+        graph.add("w1", {}, {&x}, task(0, [&] { x = 1; }));
+        for (int r = 0; r < 3; r++)
+            graph.add("r", {&x}, {}, task(1 + r, [&, r] { seen[r] = x; }));
+        graph.add("w2", {}, {&x}, task(4, [&] { x = 2; }));
+        graph.add("y", {}, {&y}, task(5, [&] { y = 3; }));
+        graph.add("r4", {&x, &y}, {}, task(6, [&] { seen[3] = x + y; }));
+        EXPECT_EQ(graph.size(), 7u);
+        graph.run(4);
+        EXPECT_EQ(graph.size(), 0u);
+
+        for (int r = 1; r <= 3; r++) {
+            EXPECT_LT(spans[0].finish, spans[r].start) << r;
+            EXPECT_LT(spans[r].finish, spans[4].start) << r;
+            EXPECT_EQ(seen[r - 1], 1) << r;
+        }
+        EXPECT_LT(spans[4].finish, spans[6].start);
+        EXPECT_LT(spans[5].finish, spans[6].start);
+        EXPECT_EQ(seen[3], 5);
+    }
+}
+
+TEST(TASK_GRAPH, A_THROWING_TASK_SKIPS_ITS_SUCCESSORS) {
+    TaskGraph graph;
+    int x = 0;
+    std::atomic<int> after{0};
+    graph.add("fail", {}, {&x}, [] { throw std::runtime_error("task"); });
+    for (int i = 0; i < 8; i++)
+        graph.add("after", {&x}, {}, [&after] { after++; });
+    EXPECT_THROW(graph.run(4), std::runtime_error);
+    EXPECT_EQ(after.load(), 0);
+    // The graph is empty and usable again
+    EXPECT_EQ(graph.size(), 0u);
+    graph.add("again", {}, {&x}, [&x] { x = 1; });
+    graph.run(2);
+    EXPECT_EQ(x, 1);
+}
+
+TEST(STRASSEN_DAG, MATCHES_BLOCKED) {
+    for (int n : {1, 2, 64, 256, 512}) {
+        auto a = MatrixGenerator<double>::random_fill_seeded(n, n, n);
+        auto b = MatrixGenerator<double>::random_fill_seeded(n, n, n + 1);
+        Matrix2<double> want = Multiplication::blocked(a, b, 1);
+        double top = 0;
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < n; j++)
+                top = std::max(top, std::abs(want.citem(i, j)));
+        for (int threads : {1, 4, 16}) {
+            for (int cutoff : {1, 16}) {
+                Matrix2<double> got =
+                    Multiplication::strassen_dag(a, b, threads, cutoff);
+                double d = 0;
+                for (int i = 0; i < n; i++)
+                    for (int j = 0; j < n; j++)
+                        d = std::max(
+                            d, std::abs(got.citem(i, j) - want.citem(i, j)));
+                EXPECT_LE(d, 1e-12 * n * std::max(1.0, top))
+                    << "n " << n << ", threads " << threads << ", cutoff "
+                    << cutoff;
+            }
+        }
+    }
+}
+
+TEST(STRASSEN_DAG, NOT_A_POWER_OF_TWO_THROWS) {
+    auto a = MatrixGenerator<double>::random_fill_seeded(6, 6, 1);
+    EXPECT_THROW(Multiplication::strassen_dag(a, a, 2),
+                 MatMulImpl::BadDimensionException);
+}